@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+// Headless benchmark of the Layout::display pipeline. Each test case builds a
+// synthetic cortex hierarchy (columns of 10 minicolumns of 100 neurons), shows
+// all its neurons in an offscreen canvas and prints one CSV line per run with
+// the wall time of every display stage. Sizes can be selected with
+// --run_test, e.g. --run_test=display_100k
+
+#define BOOST_TEST_MODULE displayPipeline
+#include <boost/test/unit_test.hpp>
+
+#include <nslib/Canvas.h>
+#include <nslib/Config.h>
+#include <nslib/DataManager.h>
+#include <nslib/DomainManager.h>
+#include <nslib/Loggers.h>
+#include <nslib/RepresentationCreatorManager.h>
+#include <nslib/layouts/GridLayout.h>
+#include <nslib/reps/SelectableItem.h>
+#include <cortex/Domain.h>
+#include <cortex/Neuron.h>
+#include <cortex/RepresentationCreator.h>
+#include <shift_ConnectsWith.h>
+
+#include <QApplication>
+#include <iostream>
+#include <random>
+
+namespace
+{
+  const unsigned int MINICOLUMNS_PER_COLUMN = 10;
+  const unsigned int NEURONS_PER_MINICOLUMN = 100;
+  const unsigned int CONNECTIONS_PER_NEURON = 10;
+  const unsigned int ENTITIES_PER_COLUMN =
+    1 + MINICOLUMNS_PER_COLUMN * ( 1 + NEURONS_PER_MINICOLUMN );
+
+  // Grid layout giving access to its sort and filter configuration
+  class BenchmarkGridLayout : public nslib::GridLayout
+  {
+  public:
+    fires::SortConfig& sortConfig( void )
+    {
+      return _sortWidget->sortConfig( );
+    }
+
+    fires::FilterSetConfig& filterSetConfig( void )
+    {
+      return _filterWidget->filterSetConfig( );
+    }
+  };
+
+  struct GlobalFixture
+  {
+    GlobalFixture( void )
+    {
+      qputenv( "QT_QPA_PLATFORM", "offscreen" );
+      _application = new QApplication( _argc, _argv );
+
+      nslib::Loggers::add(
+        new nslib::Logger( "nslib", std::cerr, nslib::LOG_LEVEL_ERROR, false ));
+      nslib::SelectableItem::init( );
+      nslib::DomainManager::setActiveDomain( new nslib::cortex::Domain );
+
+      std::cout << "benchmark,entities,displayed,items,relations,"
+                << "sortFilter_ms,create_ms,generateRelations_ms,"
+                << "addRepresentations_ms,arrangeItems_ms,preRender_ms,"
+                << "total_ms" << std::endl;
+    }
+
+    ~GlobalFixture( void )
+    {
+      delete _application;
+    }
+
+    int _argc = 1;
+    char _argv0[ 16 ] = "displayPipeline";
+    char* _argv[ 1 ] = { _argv0 };
+    QApplication* _application;
+  };
+
+  BOOST_GLOBAL_FIXTURE( GlobalFixture );
+
+  // Fills DataManager with numColumns columns and returns their neurons
+  shift::Entities createCortex( unsigned int numColumns )
+  {
+    using namespace nslib::cortex;
+    using ConnectsWith = shiftgen::ConnectsWith;
+
+    nslib::DataManager::reset( );
+    auto& entities = nslib::DataManager::entities( );
+    auto& relParentOf =
+      *( entities.relationships( )[ "isParentOf" ]->asOneToN( ));
+    auto& relChildOf =
+      *( entities.relationships( )[ "isChildOf" ]->asOneToOne( ));
+    auto& relConnectsTo =
+      *( entities.relationships( )[ "connectsTo" ]->asOneToN( ));
+    auto& relConnectedBy =
+      *( entities.relationships( )[ "connectedBy" ]->asOneToN( ));
+
+    std::mt19937 generator( 1 );
+    std::uniform_real_distribution< float > volume( 0.0f, 100.0f );
+    std::uniform_int_distribution< unsigned int > layer( 1, 6 );
+
+    shift::Entities neurons;
+    unsigned int neuronGid = 0;
+    for ( unsigned int col = 0; col < numColumns; ++col )
+    {
+      const Eigen::Vector4f colCenter( col * 1000.0f, 0.0f, 0.0f, 1.0f );
+      shift::Entity* colEntity = new Column(
+        "c" + std::to_string( col ), col,
+        MINICOLUMNS_PER_COLUMN,
+        MINICOLUMNS_PER_COLUMN * NEURONS_PER_MINICOLUMN,
+        0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0,
+        50.0f, 50.0f, 50.0f, 50.0f,
+        colCenter );
+      entities.add( colEntity );
+      relParentOf[ 0 ].insert( std::make_pair( colEntity->entityGid( ),
+                                               nullptr ));
+      relChildOf[ colEntity->entityGid( ) ].entity = 0;
+      nslib::DataManager::rootEntities( ).add( colEntity );
+
+      std::vector< shift::Entity* > columnNeurons;
+      for ( unsigned int mc = 0; mc < MINICOLUMNS_PER_COLUMN; ++mc )
+      {
+        const unsigned int mcId = col * MINICOLUMNS_PER_COLUMN + mc;
+        shift::Entity* mcEntity = new MiniColumn(
+          "mc" + std::to_string( mcId ), mcId,
+          NEURONS_PER_MINICOLUMN, 0, 0,
+          0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0,
+          50.0f, 50.0f, 50.0f, 50.0f,
+          colCenter );
+        entities.add( mcEntity );
+        shift::Relationship::Establish( relParentOf, relChildOf,
+                                        colEntity, mcEntity );
+
+        for ( unsigned int n = 0; n < NEURONS_PER_MINICOLUMN; ++n )
+        {
+          shift::Entity* neuronEntity = new Neuron(
+            "n" + std::to_string( neuronGid ), neuronGid,
+            n % 5 == 0 ? Neuron::INTERNEURON : Neuron::PYRAMIDAL,
+            n % 5 == 0 ? Neuron::INHIBITORY : Neuron::EXCITATORY,
+            volume( generator ), volume( generator ),
+            volume( generator ), volume( generator ),
+            colCenter + Eigen::Vector4f( mc * 10.0f, n * 10.0f, 0.0f, 0.0f ));
+          fires::PropertyManager::registerProperty(
+            neuronEntity, "Layer", layer( generator ));
+          entities.add( neuronEntity );
+          shift::Relationship::Establish( relParentOf, relChildOf,
+                                          mcEntity, neuronEntity );
+          neurons.add( neuronEntity );
+          columnNeurons.push_back( neuronEntity );
+          ++neuronGid;
+        }
+      }
+
+      // Each neuron connects with distinct neurons of its own column
+      const unsigned int numNeurons = columnNeurons.size( );
+      for ( unsigned int pre = 0; pre < numNeurons; ++pre )
+      {
+        for ( unsigned int k = 1; k <= CONNECTIONS_PER_NEURON; ++k )
+        {
+          const unsigned int post = ( pre + k * 97 ) % numNeurons;
+          const auto preGid = columnNeurons[ pre ]->entityGid( );
+          const auto postGid = columnNeurons[ post ]->entityGid( );
+          relConnectsTo[ preGid ].insert( std::make_pair( postGid,
+            new ConnectsWith( std::to_string( preGid ) + "-" +
+                              std::to_string( postGid ), k )));
+          relConnectedBy[ postGid ].insert( std::make_pair( preGid, nullptr ));
+        }
+      }
+    }
+
+    auto repCreator = dynamic_cast< RepresentationCreator* >(
+      nslib::RepresentationCreatorManager::getCreator( ));
+    BOOST_REQUIRE( repCreator );
+    repCreator->setMaximums( 100.0f, 100.0f, 100.0f, 100.0f,
+                             MINICOLUMNS_PER_COLUMN * NEURONS_PER_MINICOLUMN,
+                             NEURONS_PER_MINICOLUMN, NEURONS_PER_MINICOLUMN,
+                             CONNECTIONS_PER_NEURON );
+    return neurons;
+  }
+
+  void printTimings( const std::string& benchmark, unsigned int numEntities,
+                     const nslib::Canvas& canvas,
+                     const nslib::Layout::TDisplayTimings& timings )
+  {
+    const double total = timings.sortFilter + timings.create +
+      timings.generateRelations + timings.addRepresentations +
+      timings.arrangeItems + timings.preRender;
+    std::cout << benchmark << ","
+              << numEntities << ","
+              << canvas.reps( ).size( ) << ","
+              << canvas.scene( ).items( ).size( ) << ","
+              << nslib::RepresentationCreatorManager::relatedEntities( ).size( )
+              << "," << timings.sortFilter
+              << "," << timings.create
+              << "," << timings.generateRelations
+              << "," << timings.addRepresentations
+              << "," << timings.arrangeItems
+              << "," << timings.preRender
+              << "," << total << std::endl;
+  }
+
+  typedef enum
+  {
+    PLAIN = 0,
+    SORTED,
+    SORTED_AND_FILTERED
+  } TDisplayConfig;
+
+  // Displays neurons twice in a fresh canvas, first with empty
+  // representation caches and then reusing them
+  void runDisplay( const std::string& benchmark, unsigned int numEntities,
+                   shift::Entities& neurons, TDisplayConfig config )
+  {
+    auto canvas = new nslib::Canvas( );
+    auto layout = new BenchmarkGridLayout( );
+    canvas->setLayout( nslib::Layout::TLayoutIndexes::GRID, layout );
+    canvas->resize( 1920, 1080 );
+    canvas->show( );
+    QApplication::processEvents( );
+
+    if ( config != PLAIN )
+      layout->sortConfig( ).addProperty(
+        "Soma Volume", fires::PropertyManager::getSorter( "Soma Volume" ),
+        fires::SortConfig::ASCENDING );
+    if ( config == SORTED_AND_FILTERED )
+    {
+      auto filter = fires::PropertyManager::getFilter( "Dendritic Volume" );
+      fires::PropertyManager::setFilterRange( filter, 0, 50 );
+      layout->filterSetConfig( ).filters( ).push_back(
+        std::make_pair( "Dendritic Volume", filter ));
+    }
+
+    canvas->displayEntities( neurons, false, false );
+    printTimings( benchmark + "_cold", numEntities, *canvas,
+                  layout->displayTimings( ));
+    canvas->displayEntities( neurons, false, false );
+    printTimings( benchmark + "_warm", numEntities, *canvas,
+                  layout->displayTimings( ));
+
+    delete canvas;
+    nslib::RepresentationCreatorManager::clearCaches( );
+  }
+
+  void runBenchmark( const std::string& name, unsigned int numEntities,
+                     bool connectivity )
+  {
+    const unsigned int numColumns = std::max( 1u, ( unsigned int )
+      (( numEntities + ENTITIES_PER_COLUMN / 2 ) / ENTITIES_PER_COLUMN ));
+    auto neurons = createCortex( numColumns );
+    const unsigned int numCreated = nslib::DataManager::entities( ).size( );
+
+    nslib::Config::showConnectivity( connectivity );
+    runDisplay( name, numCreated, neurons, PLAIN );
+    runDisplay( name + "_sort", numCreated, neurons, SORTED );
+    runDisplay( name + "_sortFilter", numCreated, neurons,
+                SORTED_AND_FILTERED );
+    nslib::Config::showConnectivity( false );
+
+    nslib::DataManager::reset( );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( display_1k )
+{
+  runBenchmark( "display_1k", 1000, false );
+}
+
+BOOST_AUTO_TEST_CASE( display_10k )
+{
+  runBenchmark( "display_10k", 10000, false );
+}
+
+BOOST_AUTO_TEST_CASE( display_100k )
+{
+  runBenchmark( "display_100k", 100000, false );
+}
+
+BOOST_AUTO_TEST_CASE( display_1M )
+{
+  runBenchmark( "display_1M", 1000000, false );
+}
+
+BOOST_AUTO_TEST_CASE( connectivity_1k )
+{
+  runBenchmark( "connectivity_1k", 1000, true );
+}
+
+BOOST_AUTO_TEST_CASE( connectivity_10k )
+{
+  runBenchmark( "connectivity_10k", 10000, true );
+}
+
+BOOST_AUTO_TEST_CASE( connectivity_100k )
+{
+  runBenchmark( "connectivity_100k", 100000, true );
+}
+
+BOOST_AUTO_TEST_CASE( connectivity_1M )
+{
+  runBenchmark( "connectivity_1M", 1000000, true );
+}
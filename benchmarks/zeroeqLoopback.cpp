@@ -0,0 +1,471 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+// Loopback benchmark of the linked-view path. An in-process zeroeq publisher
+// plays the role of the 3D viewer and ZeroEQManager subscribes to the same
+// session. Each test case prints one CSV line with the time from publishing
+// an event until SelectionManager (or the camera) is updated and until the
+// pane has been repainted, plus the time publishSelection takes to serialize
+// large selections. Options go after "--":
+//   --rate <Hz>       events published per second (default 30)
+//   --events <n>      events per test case (default 100)
+//   --neurons <n>     neurons loaded in the scene (default 100000)
+// Sessions are discovered through zeroconf, which has to be available.
+
+#define BOOST_TEST_MODULE zeroeqLoopback
+#include <boost/test/unit_test.hpp>
+
+#include <nslib/Canvas.h>
+#include <nslib/DataManager.h>
+#include <nslib/DomainManager.h>
+#include <nslib/Loggers.h>
+#include <nslib/PaneManager.h>
+#include <nslib/RepresentationCreatorManager.h>
+#include <nslib/SelectionManager.h>
+#include <nslib/ZeroEQManager.h>
+#include <nslib/reps/SelectableItem.h>
+#include <cortex/Domain.h>
+#include <cortex/Neuron.h>
+
+#include <zeroeq/zeroeq.h>
+#include <lexis/lexis.h>
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QSplitter>
+#include <QThread>
+#include <algorithm>
+#include <iostream>
+#include <unistd.h>
+
+namespace
+{
+  const unsigned int NEURONS_PER_MINICOLUMN = 100;
+  const unsigned int MINICOLUMNS_PER_COLUMN = 10;
+  const qint64 RECEIVE_TIMEOUT_MS = 10000;
+
+  struct TOptions
+  {
+    double rate = 30.0;
+    unsigned int events = 100;
+    unsigned int neurons = 100000;
+  };
+
+  TOptions parseOptions( void )
+  {
+    TOptions options;
+    const auto& suite = boost::unit_test::framework::master_test_suite( );
+    for ( int i = 1; i + 1 < suite.argc; ++i )
+    {
+      const std::string arg( suite.argv[ i ]);
+      if ( arg == "--rate" )
+        options.rate = std::max( 0.1, std::stod( suite.argv[ ++i ]));
+      else if ( arg == "--events" )
+        options.events = std::max( 1, std::stoi( suite.argv[ ++i ]));
+      else if ( arg == "--neurons" )
+        options.neurons = std::max( 1, std::stoi( suite.argv[ ++i ]));
+    }
+    return options;
+  }
+
+  // Fills DataManager with columns of minicolumns of neurons, whose
+  // selectable ids go from 0 to numNeurons - 1. probe is the neuron of id 0.
+  shift::Entities createCortex( unsigned int numNeurons,
+                                shift::Entity*& probe )
+  {
+    using namespace nslib::cortex;
+
+    nslib::DataManager::reset( );
+    auto& entities = nslib::DataManager::entities( );
+    auto& relParentOf =
+      *( entities.relationships( )[ "isParentOf" ]->asOneToN( ));
+    auto& relChildOf =
+      *( entities.relationships( )[ "isChildOf" ]->asOneToOne( ));
+
+    shift::Entities neurons;
+    unsigned int neuronGid = 0;
+    for ( unsigned int col = 0; neuronGid < numNeurons; ++col )
+    {
+      const Eigen::Vector4f colCenter( col * 1000.0f, 0.0f, 0.0f, 1.0f );
+      shift::Entity* colEntity = new Column(
+        "c" + std::to_string( col ), col,
+        MINICOLUMNS_PER_COLUMN,
+        MINICOLUMNS_PER_COLUMN * NEURONS_PER_MINICOLUMN,
+        0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0,
+        50.0f, 50.0f, 50.0f, 50.0f,
+        colCenter );
+      entities.add( colEntity );
+      relParentOf[ 0 ].insert( std::make_pair( colEntity->entityGid( ),
+                                               nullptr ));
+      relChildOf[ colEntity->entityGid( ) ].entity = 0;
+      nslib::DataManager::rootEntities( ).add( colEntity );
+
+      for ( unsigned int mc = 0; mc < MINICOLUMNS_PER_COLUMN &&
+              neuronGid < numNeurons; ++mc )
+      {
+        const unsigned int mcId = col * MINICOLUMNS_PER_COLUMN + mc;
+        shift::Entity* mcEntity = new MiniColumn(
+          "mc" + std::to_string( mcId ), mcId,
+          NEURONS_PER_MINICOLUMN, 0, 0,
+          0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0,
+          50.0f, 50.0f, 50.0f, 50.0f,
+          colCenter );
+        entities.add( mcEntity );
+        shift::Relationship::Establish( relParentOf, relChildOf,
+                                        colEntity, mcEntity );
+
+        for ( unsigned int n = 0; n < NEURONS_PER_MINICOLUMN &&
+                neuronGid < numNeurons; ++n )
+        {
+          shift::Entity* neuronEntity = new Neuron(
+            "n" + std::to_string( neuronGid ), neuronGid,
+            Neuron::PYRAMIDAL, Neuron::EXCITATORY,
+            50.0f, 50.0f, 50.0f, 50.0f,
+            colCenter + Eigen::Vector4f( mc * 10.0f, n * 10.0f, 0.0f, 0.0f ));
+          entities.add( neuronEntity );
+          shift::Relationship::Establish( relParentOf, relChildOf,
+                                          mcEntity, neuronEntity );
+          neurons.add( neuronEntity );
+          if ( neuronGid == 0 )
+            probe = neuronEntity;
+          ++neuronGid;
+        }
+      }
+    }
+
+    nslib::SelectionManager::buildSelectableEntitiesIndex( );
+    return neurons;
+  }
+
+  // Processes GUI events until condition holds, false on timeout
+  template < typename TCondition >
+  bool waitFor( TCondition condition )
+  {
+    QElapsedTimer timer;
+    timer.start( );
+    while ( !condition( ))
+    {
+      if ( timer.elapsed( ) > RECEIVE_TIMEOUT_MS )
+        return false;
+      QApplication::processEvents( QEventLoop::AllEvents, 1 );
+    }
+    return true;
+  }
+
+  struct TLatencies
+  {
+    double sumApplied = 0.0;
+    double maxApplied = 0.0;
+    double sumRepainted = 0.0;
+    double maxRepainted = 0.0;
+    unsigned int count = 0;
+
+    void add( double applied, double repainted )
+    {
+      sumApplied += applied;
+      maxApplied = std::max( maxApplied, applied );
+      sumRepainted += repainted;
+      maxRepainted = std::max( maxRepainted, repainted );
+      ++count;
+    }
+  };
+
+  struct GlobalFixture;
+  GlobalFixture* _fixture = nullptr;
+
+  struct GlobalFixture
+  {
+    GlobalFixture( void )
+    {
+      qputenv( "QT_QPA_PLATFORM", "offscreen" );
+      _application = new QApplication( _argc, _argv );
+      _options = parseOptions( );
+
+      nslib::Loggers::add(
+        new nslib::Logger( "nslib", std::cerr, nslib::LOG_LEVEL_ERROR, false ));
+      nslib::SelectableItem::init( );
+      nslib::DomainManager::setActiveDomain( new nslib::cortex::Domain );
+      _neurons = createCortex( _options.neurons, _probe );
+
+      _splitter = new QSplitter( );
+      nslib::PaneManager::splitter( _splitter );
+      _canvas = nslib::PaneManager::newPane( );
+      _splitter->resize( 1920, 1080 );
+      _splitter->show( );
+      _canvas->displayEntities( _neurons, false, true );
+      QApplication::processEvents( );
+
+      const std::string session =
+        "nsZeroEQLoopback" + std::to_string( ::getpid( ));
+      _fixture = this;
+      _publisher = new zeroeq::Publisher( session );
+      nslib::ZeroEQManager::connect( session );
+      connectPublisher( );
+
+      std::cout << "benchmark,gids,events,rate_hz,"
+                << "mean_applied_ms,max_applied_ms,"
+                << "mean_repainted_ms,max_repainted_ms" << std::endl;
+    }
+
+    ~GlobalFixture( void )
+    {
+      nslib::ZeroEQManager::disconnect( );
+      delete _publisher;
+      delete _splitter;
+      nslib::DataManager::reset( );
+      delete _application;
+    }
+
+    // Publishes until the subscriber has joined the session
+    void connectPublisher( void )
+    {
+      const std::vector< unsigned int > probeIds( 1, 0 );
+      QElapsedTimer timer;
+      timer.start( );
+      while ( nslib::SelectionManager::getSelectedState( _probe ) !=
+              nslib::SelectedState::SELECTED )
+      {
+        BOOST_REQUIRE( timer.elapsed( ) < RECEIVE_TIMEOUT_MS );
+        _publisher->publish( lexis::data::SelectedIDs( probeIds ));
+        QApplication::processEvents( QEventLoop::AllEvents, 100 );
+        QThread::msleep( 10 );
+      }
+      nslib::SelectionManager::clearActiveSelection( );
+    }
+
+    // Waits for the next publication slot of the configured rate
+    void pace( QElapsedTimer& clock, unsigned int event ) const
+    {
+      const qint64 slot = ( qint64 )( 1000.0 * event / _options.rate );
+      waitFor( [ & ]( ){ return clock.elapsed( ) >= slot; });
+    }
+
+    void repaint( void )
+    {
+      nslib::PaneManager::flushRefreshes( );
+      _canvas->repaint( );
+    }
+
+    int _argc = 1;
+    char _argv0[ 16 ] = "zeroeqLoopback";
+    char* _argv[ 1 ] = { _argv0 };
+    QApplication* _application;
+    TOptions _options;
+    shift::Entities _neurons;
+    shift::Entity* _probe;
+    QSplitter* _splitter;
+    nslib::Canvas* _canvas;
+    zeroeq::Publisher* _publisher;
+  };
+
+  BOOST_GLOBAL_FIXTURE( GlobalFixture );
+
+  GlobalFixture* fixture( void )
+  {
+    return _fixture;
+  }
+
+  void printLatencies( const std::string& benchmark, unsigned int numGids,
+                       const TLatencies& latencies )
+  {
+    const auto count = std::max( 1u, latencies.count );
+    std::cout << benchmark << ","
+              << numGids << ","
+              << latencies.count << ","
+              << fixture( )->_options.rate << ","
+              << latencies.sumApplied / count << ","
+              << latencies.maxApplied << ","
+              << latencies.sumRepainted / count << ","
+              << latencies.maxRepainted << std::endl;
+  }
+
+  // Alternates two selections of numGids ids, one holding the probe id 0
+  // and the other shifted by one, so each event is observable on the probe
+  void runSelection( const std::string& benchmark, unsigned int numGids )
+  {
+    auto f = fixture( );
+    std::vector< unsigned int > withProbe( numGids );
+    for ( unsigned int i = 0; i < numGids; ++i )
+      withProbe[ i ] = i;
+    std::vector< unsigned int > withoutProbe( withProbe );
+    for ( auto& id : withoutProbe )
+      ++id;
+
+    TLatencies latencies;
+    QElapsedTimer clock;
+    clock.start( );
+    for ( unsigned int event = 0; event < f->_options.events; ++event )
+    {
+      f->pace( clock, event );
+      const bool selectProbe = ( event % 2 ) == 0;
+      const auto expected = selectProbe ? nslib::SelectedState::SELECTED :
+        nslib::SelectedState::UNSELECTED;
+
+      QElapsedTimer latency;
+      latency.start( );
+      f->_publisher->publish( lexis::data::SelectedIDs(
+        selectProbe ? withProbe : withoutProbe ));
+      BOOST_REQUIRE( waitFor( [ & ]( ){
+        return nslib::SelectionManager::getSelectedState( f->_probe ) ==
+          expected; }));
+      const double applied = latency.nsecsElapsed( ) * 1e-6;
+      f->repaint( );
+      latencies.add( applied, latency.nsecsElapsed( ) * 1e-6 );
+    }
+    printLatencies( benchmark, numGids, latencies );
+    nslib::SelectionManager::clearActiveSelection( );
+    f->repaint( );
+  }
+
+  // Publishes a burst of selections back to back and measures until the
+  // last one has been applied
+  void runSelectionBurst( const std::string& benchmark, unsigned int numGids )
+  {
+    auto f = fixture( );
+    std::vector< unsigned int > ids( numGids );
+    for ( unsigned int i = 0; i < numGids; ++i )
+      ids[ i ] = i + 1;
+
+    TLatencies latencies;
+    QElapsedTimer latency;
+    latency.start( );
+    for ( unsigned int event = 0; event < f->_options.events; ++event )
+      f->_publisher->publish( lexis::data::SelectedIDs( ids ));
+    f->_publisher->publish( lexis::data::SelectedIDs(
+      std::vector< unsigned int >( 1, 0 )));
+    BOOST_REQUIRE( waitFor( [ & ]( ){
+      return nslib::SelectionManager::getSelectedState( f->_probe ) ==
+        nslib::SelectedState::SELECTED; }));
+    const double applied = latency.nsecsElapsed( ) * 1e-6;
+    f->repaint( );
+    latencies.add( applied, latency.nsecsElapsed( ) * 1e-6 );
+    printLatencies( benchmark, numGids, latencies );
+    nslib::SelectionManager::clearActiveSelection( );
+    f->repaint( );
+  }
+
+  // Publishes camera matrices whose x translation is the event number
+  void runCamera( const std::string& benchmark )
+  {
+    auto f = fixture( );
+    std::vector< double > matrix( 16, 0.0 );
+    matrix[ 0 ] = matrix[ 5 ] = matrix[ 10 ] = matrix[ 15 ] = 1.0;
+
+    TLatencies latencies;
+    QElapsedTimer clock;
+    clock.start( );
+    for ( unsigned int event = 0; event < f->_options.events; ++event )
+    {
+      f->pace( clock, event );
+      matrix[ 12 ] = event + 1;
+      lexis::render::LookOut lookOut;
+      lookOut.setMatrix( matrix );
+
+      QElapsedTimer latency;
+      latency.start( );
+      f->_publisher->publish( lookOut );
+      BOOST_REQUIRE( waitFor( [ & ]( ){
+        return nslib::PaneManager::viewMatrix( )( 0, 3 ) == matrix[ 12 ]; }));
+      const double applied = latency.nsecsElapsed( ) * 1e-6;
+      f->repaint( );
+      latencies.add( applied, latency.nsecsElapsed( ) * 1e-6 );
+    }
+    printLatencies( benchmark, 16, latencies );
+  }
+
+  // Time spent by publishSelection, alternating two selections so none of
+  // them is skipped as a repeated one
+  void runPublish( const std::string& benchmark, unsigned int numGids )
+  {
+    auto f = fixture( );
+    std::vector< unsigned int > ids[ 2 ];
+    ids[ 0 ].resize( numGids );
+    for ( unsigned int i = 0; i < numGids; ++i )
+      ids[ 0 ][ i ] = i;
+    ids[ 1 ] = ids[ 0 ];
+    ids[ 1 ].back( ) = numGids;
+
+    TLatencies latencies;
+    for ( unsigned int event = 0; event < f->_options.events; ++event )
+    {
+      QElapsedTimer latency;
+      latency.start( );
+      nslib::ZeroEQManager::publishSelection( ids[ event % 2 ]);
+      const double published = latency.nsecsElapsed( ) * 1e-6;
+      latencies.add( published, published );
+    }
+    printLatencies( benchmark, numGids, latencies );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( selection_1 )
+{
+  runSelection( "selection_1", 1 );
+}
+
+BOOST_AUTO_TEST_CASE( selection_1k )
+{
+  runSelection( "selection_1k", 1000 );
+}
+
+BOOST_AUTO_TEST_CASE( selection_100k )
+{
+  runSelection( "selection_100k", 100000 );
+}
+
+BOOST_AUTO_TEST_CASE( selection_1M )
+{
+  runSelection( "selection_1M", 1000000 );
+}
+
+BOOST_AUTO_TEST_CASE( selectionBurst_100k )
+{
+  runSelectionBurst( "selectionBurst_100k", 100000 );
+}
+
+BOOST_AUTO_TEST_CASE( camera )
+{
+  runCamera( "camera" );
+}
+
+BOOST_AUTO_TEST_CASE( publish_1 )
+{
+  runPublish( "publish_1", 1 );
+}
+
+BOOST_AUTO_TEST_CASE( publish_1k )
+{
+  runPublish( "publish_1k", 1000 );
+}
+
+BOOST_AUTO_TEST_CASE( publish_100k )
+{
+  runPublish( "publish_100k", 100000 );
+}
+
+BOOST_AUTO_TEST_CASE( publish_1M )
+{
+  runPublish( "publish_1M", 1000000 );
+}
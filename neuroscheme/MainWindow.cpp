@@ -50,6 +50,21 @@
 #include <QHeaderView>
 #include <QMessageBox>
 
+namespace
+{
+  //! Patterns of the compressed JSON scenes this build can read and write
+  QString compressedJSONPatterns( void )
+  {
+#if defined( NEUROSCHEME_WITH_ZSTD )
+    return QString( "*.json.gz *.json.zst" );
+#elif defined( NEUROSCHEME_WITH_IOSTREAMS )
+    return QString( "*.json.gz" );
+#else
+    return QString( );
+#endif
+  }
+}
+
 MainWindow::MainWindow( QWidget* parent_, bool zeroEQ )
   : QMainWindow( parent_ )
   , minDockSizeX(305u)
@@ -177,9 +192,10 @@ MainWindow::MainWindow( QWidget* parent_, bool zeroEQ )
   if ( !fileJSON.empty( ))
   {
     auto filePath = nslib::Config::inputArgs( )[ fileJSON ][0] ;
-    std::ifstream inputfile( filePath );
-    nslib::DomainManager::getActiveDomain( )->importJSON( inputfile );
+    _importScene( filePath );
   }
+  else
+    nslib::SelectionManager::buildSelectableEntitiesIndex( );
 
   auto createDock = [=](QDockWidget * &d, const QString title)
   {
@@ -461,6 +477,13 @@ void MainWindow::storeSelection( void )
   }
 }
 
+void MainWindow::_clearStoredSelectionsTable( void )
+{
+  _storedSelections.table->setRowCount( 0 );
+  _storedSelections.tableWidgets.clear( );
+  _storedSelections.counter = 0;
+}
+
 void MainWindow::restoreSelection( void )
 {
   if ( _storedSelections.table->selectedItems( ).size( ) > 0 )
@@ -635,7 +658,8 @@ void MainWindow::actionPublishSelection( void )
 {
   std::vector< unsigned int > ids;
   nslib::SelectionManager::selectableEntitiesIds( ids );
-  nslib::ZeroEQManager::publishSelection( ids );
+  // Explicit requests are sent even if the selection has not changed
+  nslib::ZeroEQManager::publishSelection( ids, true );
 }
 
 void MainWindow::actionPublishFocusOnSelection( void )
@@ -719,9 +743,14 @@ void MainWindow::toggleZeroEQ( void )
 
 void MainWindow::exportToJSON( void )
 {
-  const auto filter = tr("JSON File ( *.JSON *.json );; All files (*)");
+  const auto binaryFilter = tr("NeuroScheme binary scene ( *.nsb )");
+  const auto compressedPatterns = compressedJSONPatterns( );
+  auto filter = tr("JSON File ( *.JSON *.json );; ");
+  if ( !compressedPatterns.isEmpty( ))
+    filter += tr( "Compressed JSON File ( %1 );; " ).arg( compressedPatterns );
+  filter += binaryFilter + tr(";; All files (*)");
   auto selectedFilter = tr("JSON File ( *.JSON *.json )");
-  const auto title = tr( "Save JSON File" );
+  const auto title = tr( "Save Scene File" );
   const auto directory = _lastOpenedFileName.isEmpty() ? QDir::currentPath() : QFileInfo{_lastOpenedFileName}.path();
   const auto options = QFileDialog::Option::DontUseNativeDialog;
 
@@ -731,22 +760,54 @@ void MainWindow::exportToJSON( void )
   {
     _lastOpenedFileName = QFileInfo{path}.path( );
 
-    if (!path.endsWith(".json"))
+    if ( selectedFilter == binaryFilter || path.endsWith( ".nsb" ))
+    {
+      if ( !path.endsWith( ".nsb" ))
+      {
+        path += ".nsb";
+      }
+      if ( !nslib::DomainManager::getActiveDomain( )->exportBinary(
+        path.toStdString( )))
+      {
+        QMessageBox::critical( this, title,
+          tr( "Unable to save the scene to %1." ).arg( path ));
+      }
+      return;
+    }
+
+    // Compressed by the extension, gzip unless zstd is chosen
+    if ( selectedFilter.startsWith( tr( "Compressed" )) &&
+         !path.endsWith( ".gz" ) && !path.endsWith( ".zst" ))
+    {
+      path += path.endsWith( ".json" ) ? ".gz" : ".json.gz";
+    }
+    else if ( !path.endsWith( ".json" ) && !path.endsWith( ".gz" ) &&
+              !path.endsWith( ".zst" ))
     {
       path += ".json";
     }
-    auto fileName = path.toStdString( );
 
-    std::ofstream outfile( fileName );
-    nslib::DomainManager::getActiveDomain( )->exportJSON( outfile );
+    if ( !nslib::DomainManager::getActiveDomain( )->exportJSONFile(
+      path.toStdString( )))
+    {
+      QMessageBox::critical( this, title,
+        tr( "Unable to save the scene to %1." ).arg( path ));
+    }
   }
 }
 
 void MainWindow::importFromJSON()
 {
-  const auto filter = tr("JSON File ( *.JSON *.json );; All files (*)");
-  auto selectedFilter = tr("JSON File ( *.JSON *.json )");
-  const auto title = tr( "Open JSON File" );
+  const auto compressedPatterns = compressedJSONPatterns( );
+  auto jsonPatterns = QString( "*.JSON *.json" );
+  if ( !compressedPatterns.isEmpty( ))
+    jsonPatterns += " " + compressedPatterns;
+  auto selectedFilter = tr( "Scene File ( %1 *.nsb )" ).arg( jsonPatterns );
+  auto filter = selectedFilter + tr( ";; JSON File ( *.JSON *.json );; " );
+  if ( !compressedPatterns.isEmpty( ))
+    filter += tr( "Compressed JSON File ( %1 );; " ).arg( compressedPatterns );
+  filter += tr( "NeuroScheme binary scene ( *.nsb );; All files (*)" );
+  const auto title = tr( "Open Scene File" );
   const auto directory = _lastOpenedFileName.isEmpty() ? QDir::currentPath() : _lastOpenedFileName;
   const auto options = QFileDialog::Option::DontUseNativeDialog;
   const auto path = QFileDialog::getOpenFileName( this, title, directory, filter, &selectedFilter, options );
@@ -756,12 +817,40 @@ void MainWindow::importFromJSON()
     _lastOpenedFileName = QFileInfo{path}.path( );
     auto fileName = path.toStdString( );
 
-    std::ifstream inputfile( fileName );
     nslib::DataManager::reset( );
     nslib::RepresentationCreatorManager::clearCaches( );
     nslib::RepresentationCreatorManager::clearMaximums( );
-    nslib::DomainManager::getActiveDomain( )->importJSON( inputfile );
+    _clearStoredSelectionsTable( );
+    _importScene( fileName );
+  }
+}
+
+void MainWindow::_importScene( const std::string& fileName )
+{
+  const auto progressCallback = [ this ]( float progress )
+    {
+      statusBar( )->showMessage(
+        tr( "Loading scene: %1%" ).arg( int( progress * 100 )));
+      statusBar( )->repaint( );
+    };
+  auto domain = nslib::DomainManager::getActiveDomain( );
+  if ( QString::fromStdString( fileName ).endsWith( ".nsb" ))
+  {
+    if ( !domain->importBinary( fileName, false, progressCallback ))
+    {
+      QMessageBox::critical( this, tr( "Open Scene File" ),
+        tr( "Unable to load the scene %1." ).arg(
+          QString::fromStdString( fileName )));
+    }
+  }
+  else if ( !domain->importJSONFile( fileName, false, progressCallback ))
+  {
+    QMessageBox::critical( this, tr( "Open Scene File" ),
+      tr( "Unable to load the scene %1." ).arg(
+        QString::fromStdString( fileName )));
   }
+  statusBar( )->clearMessage( );
+  nslib::SelectionManager::buildSelectableEntitiesIndex( );
 }
 
 void MainWindow::cleanScene( void )
@@ -769,6 +858,7 @@ void MainWindow::cleanScene( void )
   nslib::DataManager::reset( );
   nslib::RepresentationCreatorManager::clearCaches( );
   nslib::RepresentationCreatorManager::clearMaximums( );
+  _clearStoredSelectionsTable( );
 
   auto displayRoot = [](nslib::Canvas *c){ c->displayEntities( nslib::DataManager::rootEntities( ), false, true ); };
   auto &panes = nslib::PaneManager::panes();
@@ -95,6 +95,12 @@ protected:
   };
 
   QString _tableColumnToString( const TTableColumns column );
+  //! Imports a JSON, compressed JSON or, by its .nsb extension, binary
+  //! scene showing the progress in the status bar
+  void _importScene( const std::string& fileName );
+  //! Empties the stored selections table, once the data they referred to
+  //! has been reset
+  void _clearStoredSelectionsTable( void );
   StoredSelections _storedSelections;
   QDockWidget* _layoutsDock = nullptr;
   QDockWidget* _entityEditDock = nullptr;
@@ -0,0 +1,506 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#include "BinaryScene.h"
+#include "Loggers.h"
+#include "ParallelFor.h"
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+#define BINARY_SCENE_MAGIC "NSSCENE"
+// All sections start at offsets multiple of this so the mapped tables are
+// properly aligned
+#define BINARY_SCENE_ALIGNMENT 8
+// Sections are hashed in blocks of this size, in parallel
+#define CHECKSUM_BLOCK_SIZE ( 1 << 20 )
+
+namespace nslib
+{
+  namespace
+  {
+    typedef struct
+    {
+      char magic[ 8 ];
+      uint32_t version;
+      uint32_t reserved;
+      uint64_t fileSize;
+      //! Checksum of the header, with this field as zero, and all sections
+      uint64_t checksum;
+      uint64_t numStrings;
+      uint64_t stringDataSize;
+      uint64_t numEntities;
+      uint64_t numEntityColumns;
+      uint64_t numRelationTypes;
+      uint64_t numRelations;
+      uint64_t numRelationColumns;
+      uint64_t numValues;
+      uint64_t numLayoutGIDs;
+      uint64_t numLayoutPositions;
+    } TBinarySceneHeader;
+
+    typedef enum
+    {
+      SECTION_INFO = 0,
+      SECTION_STRING_OFFSETS,
+      SECTION_STRING_DATA,
+      SECTION_ENTITIES,
+      SECTION_ENTITY_COLUMNS,
+      SECTION_RELATION_TYPES,
+      SECTION_RELATIONS,
+      SECTION_RELATION_COLUMNS,
+      SECTION_VALUES,
+      SECTION_LAYOUT_GIDS,
+      SECTION_LAYOUT_POSITIONS,
+      NUM_SECTIONS
+    } TSection;
+
+    typedef struct
+    {
+      uint64_t offsets[ NUM_SECTIONS ];
+      uint64_t sizes[ NUM_SECTIONS ];
+      uint64_t end;
+    } TBinarySceneLayout;
+
+    uint64_t aligned( uint64_t offset )
+    {
+      return ( offset + BINARY_SCENE_ALIGNMENT - 1 ) &
+        ~uint64_t( BINARY_SCENE_ALIGNMENT - 1 );
+    }
+
+    TBinarySceneLayout layout( const TBinarySceneHeader& header )
+    {
+      TBinarySceneLayout layout_;
+      layout_.sizes[ SECTION_INFO ] = sizeof( TBinarySceneInfo );
+      layout_.sizes[ SECTION_STRING_OFFSETS ] =
+        ( header.numStrings + 1 ) * sizeof( uint64_t );
+      layout_.sizes[ SECTION_STRING_DATA ] = header.stringDataSize;
+      layout_.sizes[ SECTION_ENTITIES ] =
+        header.numEntities * sizeof( TBinarySceneEntity );
+      layout_.sizes[ SECTION_ENTITY_COLUMNS ] =
+        header.numEntityColumns * sizeof( TBinarySceneColumn );
+      layout_.sizes[ SECTION_RELATION_TYPES ] =
+        header.numRelationTypes * sizeof( TBinarySceneRelationType );
+      layout_.sizes[ SECTION_RELATIONS ] =
+        header.numRelations * sizeof( TBinarySceneRelation );
+      layout_.sizes[ SECTION_RELATION_COLUMNS ] =
+        header.numRelationColumns * sizeof( TBinarySceneColumn );
+      layout_.sizes[ SECTION_VALUES ] = header.numValues * sizeof( uint32_t );
+      layout_.sizes[ SECTION_LAYOUT_GIDS ] =
+        header.numLayoutGIDs * sizeof( uint32_t );
+      layout_.sizes[ SECTION_LAYOUT_POSITIONS ] =
+        header.numLayoutPositions * sizeof( float );
+
+      uint64_t offset = sizeof( TBinarySceneHeader );
+      for ( unsigned int section = 0; section < NUM_SECTIONS; ++section )
+      {
+        layout_.offsets[ section ] = aligned( offset );
+        offset = layout_.offsets[ section ] + layout_.sizes[ section ];
+      }
+      layout_.end = offset;
+      return layout_;
+    }
+
+    uint64_t hashBlock( const unsigned char* data, uint64_t size )
+    {
+      uint64_t hash = 0xcbf29ce484222325ull;
+      uint64_t i = 0;
+      for ( ; i + sizeof( uint64_t ) <= size; i += sizeof( uint64_t ))
+      {
+        uint64_t word;
+        memcpy( &word, data + i, sizeof( uint64_t ));
+        hash = ( hash ^ word ) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+      }
+      for ( ; i < size; ++i )
+        hash = ( hash ^ data[ i ] ) * 0x100000001b3ull;
+      return hash;
+    }
+
+    //! Combines the hashes of CHECKSUM_BLOCK_SIZE blocks of the header and
+    //! sections, so it does not depend on the alignment gaps between them
+    uint64_t checksum( const TBinarySceneHeader& header,
+                       const void* const sections[ NUM_SECTIONS ],
+                       const TBinarySceneLayout& layout_ )
+    {
+      TBinarySceneHeader header_ = header;
+      header_.checksum = 0;
+
+      typedef struct
+      {
+        const unsigned char* data;
+        uint64_t size;
+      } TBlock;
+      std::vector< TBlock > blocks;
+      blocks.push_back( TBlock{ reinterpret_cast< const unsigned char* >(
+        &header_ ), sizeof( TBinarySceneHeader ) });
+      for ( unsigned int section = 0; section < NUM_SECTIONS; ++section )
+      {
+        const auto data = static_cast< const unsigned char* >(
+          sections[ section ]);
+        const auto size = layout_.sizes[ section ];
+        for ( uint64_t offset = 0; offset < size;
+              offset += CHECKSUM_BLOCK_SIZE )
+          blocks.push_back( TBlock{ data + offset, std::min< uint64_t >(
+            CHECKSUM_BLOCK_SIZE, size - offset ) });
+      }
+
+      std::vector< uint64_t > hashes( blocks.size( ));
+      parallelFor( blocks.size( ), parallelChunks( blocks.size( ), 1 ),
+        [ & ]( size_t begin, size_t end, unsigned int )
+        {
+          for ( size_t i = begin; i < end; ++i )
+            hashes[ i ] = hashBlock( blocks[ i ].data, blocks[ i ].size );
+        });
+      return hashBlock( reinterpret_cast< const unsigned char* >(
+        hashes.data( )), hashes.size( ) * sizeof( uint64_t ));
+    }
+
+    bool writeAt( QSaveFile& file, uint64_t offset, const void* data,
+                  uint64_t size )
+    {
+      // Fill alignment gaps with zeros
+      static const char zeros[ BINARY_SCENE_ALIGNMENT ] = { 0 };
+      const auto gap = offset - uint64_t( file.pos( ));
+      if ( gap > 0 && file.write( zeros, qint64( gap )) != qint64( gap ))
+        return false;
+      return size == 0 ||
+        file.write( reinterpret_cast< const char* >( data ),
+                    qint64( size )) == qint64( size );
+    }
+  }
+
+  const uint32_t BinaryScene::VERSION;
+  const uint32_t BinaryScene::NO_VALUE;
+
+  BinaryScene::BinaryScene( void )
+  {
+    _reset( );
+  }
+
+  void BinaryScene::_reset( void )
+  {
+    memset( &_info, 0, sizeof( TBinarySceneInfo ));
+    _entities = Array< TBinarySceneEntity >( );
+    _entityColumns = Array< TBinarySceneColumn >( );
+    _relationTypes = Array< TBinarySceneRelationType >( );
+    _relations = Array< TBinarySceneRelation >( );
+    _relationColumns = Array< TBinarySceneColumn >( );
+    _values = Array< uint32_t >( );
+    _layoutGIDs = Array< uint32_t >( );
+    _layoutPositions = Array< float >( );
+    _stringDataStorage.clear( );
+    _stringIndices.clear( );
+    _entitiesStorage.clear( );
+    _entityColumnsStorage.clear( );
+    _relationTypesStorage.clear( );
+    _relationsStorage.clear( );
+    _relationColumnsStorage.clear( );
+    _valuesStorage.clear( );
+    _layoutGIDsStorage.clear( );
+    _layoutPositionsStorage.clear( );
+    _file.reset( );
+
+    _stringOffsetsStorage.assign( 1, 0 );
+    _stringOffsets = Array< uint64_t >( _stringOffsetsStorage.data( ), 1 );
+    _stringData = Array< char >( );
+  }
+
+  uint32_t BinaryScene::addString( const std::string& str )
+  {
+    const auto stringIt = _stringIndices.find( str );
+    if ( stringIt != _stringIndices.end( ))
+      return stringIt->second;
+
+    const auto index = uint32_t( _stringOffsetsStorage.size( ) - 1 );
+    _stringDataStorage.append( str );
+    _stringOffsetsStorage.push_back( _stringDataStorage.size( ));
+    _stringIndices.emplace( str, index );
+    _stringOffsets = Array< uint64_t >(
+      _stringOffsetsStorage.data( ), _stringOffsetsStorage.size( ));
+    _stringData = Array< char >(
+      _stringDataStorage.data( ), _stringDataStorage.size( ));
+    return index;
+  }
+
+  void BinaryScene::set( const TBinarySceneInfo& info_,
+    std::vector< TBinarySceneEntity >&& entities_,
+    std::vector< TBinarySceneColumn >&& entityColumns_,
+    std::vector< TBinarySceneRelationType >&& relationTypes_,
+    std::vector< TBinarySceneRelation >&& relations_,
+    std::vector< TBinarySceneColumn >&& relationColumns_,
+    std::vector< uint32_t >&& values_,
+    std::vector< uint32_t >&& layoutGIDs_,
+    std::vector< float >&& layoutPositions_ )
+  {
+    _info = info_;
+    _entitiesStorage = std::move( entities_ );
+    _entityColumnsStorage = std::move( entityColumns_ );
+    _relationTypesStorage = std::move( relationTypes_ );
+    _relationsStorage = std::move( relations_ );
+    _relationColumnsStorage = std::move( relationColumns_ );
+    _valuesStorage = std::move( values_ );
+    _layoutGIDsStorage = std::move( layoutGIDs_ );
+    _layoutPositionsStorage = std::move( layoutPositions_ );
+    _entities = Array< TBinarySceneEntity >(
+      _entitiesStorage.data( ), _entitiesStorage.size( ));
+    _entityColumns = Array< TBinarySceneColumn >(
+      _entityColumnsStorage.data( ), _entityColumnsStorage.size( ));
+    _relationTypes = Array< TBinarySceneRelationType >(
+      _relationTypesStorage.data( ), _relationTypesStorage.size( ));
+    _relations = Array< TBinarySceneRelation >(
+      _relationsStorage.data( ), _relationsStorage.size( ));
+    _relationColumns = Array< TBinarySceneColumn >(
+      _relationColumnsStorage.data( ), _relationColumnsStorage.size( ));
+    _values = Array< uint32_t >( _valuesStorage.data( ),
+                                 _valuesStorage.size( ));
+    _layoutGIDs = Array< uint32_t >( _layoutGIDsStorage.data( ),
+                                     _layoutGIDsStorage.size( ));
+    _layoutPositions = Array< float >( _layoutPositionsStorage.data( ),
+                                       _layoutPositionsStorage.size( ));
+  }
+
+  std::string BinaryScene::string( uint32_t index ) const
+  {
+    const auto begin = _stringOffsets[ index ];
+    return std::string( _stringData.begin( ) + begin,
+                        size_t( _stringOffsets[ index + 1 ] - begin ));
+  }
+
+  bool BinaryScene::load( const std::string& fileName_ )
+  {
+    _reset( );
+
+    std::unique_ptr< QFile > file(
+      new QFile( QString::fromStdString( fileName_ )));
+    if ( !file->open( QIODevice::ReadOnly ))
+    {
+      Loggers::get( )->log( "Scene " + fileName_ + " could not be opened",
+                            LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+      return false;
+    }
+
+    const uint64_t fileSize = uint64_t( file->size( ));
+    if ( fileSize < sizeof( TBinarySceneHeader ))
+    {
+      Loggers::get( )->log( "Invalid binary scene " + fileName_,
+                            LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+      return false;
+    }
+
+    const uchar* data = file->map( 0, file->size( ));
+    if ( !data )
+    {
+      Loggers::get( )->log( "Scene " + fileName_ + " could not be mapped",
+                            LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+      return false;
+    }
+
+    TBinarySceneHeader header;
+    memcpy( &header, data, sizeof( TBinarySceneHeader ));
+    if ( strncmp( header.magic, BINARY_SCENE_MAGIC,
+                  sizeof( header.magic )) != 0 ||
+         header.version != VERSION )
+    {
+      Loggers::get( )->log( "Scene " + fileName_ +
+                            " has an unknown format or version",
+                            LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+      return false;
+    }
+
+    // Counts larger than the file would overflow the layout
+    const uint64_t counts[ ] = { header.numStrings, header.stringDataSize,
+      header.numEntities, header.numEntityColumns, header.numRelationTypes,
+      header.numRelations, header.numRelationColumns, header.numValues,
+      header.numLayoutGIDs, header.numLayoutPositions };
+    bool validCounts = true;
+    for ( const auto count : counts )
+      validCounts = validCounts && count < fileSize;
+
+    const auto layout_ = layout( header );
+    if ( !validCounts || header.fileSize != fileSize ||
+         layout_.end != fileSize )
+    {
+      Loggers::get( )->log( "Scene " + fileName_ + " is truncated",
+                            LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+      return false;
+    }
+
+    const void* sections[ NUM_SECTIONS ];
+    for ( unsigned int section = 0; section < NUM_SECTIONS; ++section )
+      sections[ section ] = data + layout_.offsets[ section ];
+    if ( checksum( header, sections, layout_ ) != header.checksum )
+    {
+      Loggers::get( )->log( "Scene " + fileName_ + " is corrupted",
+                            LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+      return false;
+    }
+
+    memcpy( &_info, sections[ SECTION_INFO ], sizeof( TBinarySceneInfo ));
+    _stringOffsets = Array< uint64_t >( static_cast< const uint64_t* >(
+      sections[ SECTION_STRING_OFFSETS ]), header.numStrings + 1 );
+    _stringData = Array< char >( static_cast< const char* >(
+      sections[ SECTION_STRING_DATA ]), header.stringDataSize );
+    _entities = Array< TBinarySceneEntity >(
+      static_cast< const TBinarySceneEntity* >(
+        sections[ SECTION_ENTITIES ]), header.numEntities );
+    _entityColumns = Array< TBinarySceneColumn >(
+      static_cast< const TBinarySceneColumn* >(
+        sections[ SECTION_ENTITY_COLUMNS ]), header.numEntityColumns );
+    _relationTypes = Array< TBinarySceneRelationType >(
+      static_cast< const TBinarySceneRelationType* >(
+        sections[ SECTION_RELATION_TYPES ]), header.numRelationTypes );
+    _relations = Array< TBinarySceneRelation >(
+      static_cast< const TBinarySceneRelation* >(
+        sections[ SECTION_RELATIONS ]), header.numRelations );
+    _relationColumns = Array< TBinarySceneColumn >(
+      static_cast< const TBinarySceneColumn* >(
+        sections[ SECTION_RELATION_COLUMNS ]), header.numRelationColumns );
+    _values = Array< uint32_t >( static_cast< const uint32_t* >(
+      sections[ SECTION_VALUES ]), header.numValues );
+    _layoutGIDs = Array< uint32_t >( static_cast< const uint32_t* >(
+      sections[ SECTION_LAYOUT_GIDS ]), header.numLayoutGIDs );
+    _layoutPositions = Array< float >( static_cast< const float* >(
+      sections[ SECTION_LAYOUT_POSITIONS ]), header.numLayoutPositions );
+
+    // Indices are trusted from here on, check them once
+    if ( !_validate( ))
+    {
+      Loggers::get( )->log( "Scene " + fileName_ + " has invalid tables",
+                            LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+      _reset( );
+      return false;
+    }
+
+    // Keeps the mapping alive while the scene is used
+    _file = std::move( file );
+    return true;
+  }
+
+  bool BinaryScene::_validate( void ) const
+  {
+    const auto numStrings_ = numStrings( );
+    if ( _stringOffsets[ 0 ] != 0 ||
+         _stringOffsets[ numStrings_ ] != _stringData.size( ))
+      return false;
+    for ( size_t i = 0; i < numStrings_; ++i )
+      if ( _stringOffsets[ i ] > _stringOffsets[ i + 1 ] )
+        return false;
+
+    if ( _info.domainName >= numStrings_ || _info.maximums >= numStrings_ )
+      return false;
+
+    for ( const auto& entity : _entities )
+      if ( entity.type >= numStrings_ )
+        return false;
+
+    const auto validColumn = [ & ]( const TBinarySceneColumn& column,
+                                    uint64_t numRows )
+    {
+      return column.label < numStrings_ &&
+        column.firstValue <= _values.size( ) &&
+        numRows <= _values.size( ) - column.firstValue;
+    };
+    for ( const auto& column : _entityColumns )
+      if ( !validColumn( column, _entities.size( )))
+        return false;
+
+    for ( const auto& relationType : _relationTypes )
+    {
+      if ( relationType.name >= numStrings_ ||
+           relationType.firstRelation > _relations.size( ) ||
+           relationType.numRelations >
+             _relations.size( ) - relationType.firstRelation ||
+           uint64_t( relationType.firstColumn ) + relationType.numColumns >
+             _relationColumns.size( ))
+        return false;
+      for ( uint32_t c = 0; c < relationType.numColumns; ++c )
+        if ( !validColumn( _relationColumns[ relationType.firstColumn + c ],
+                           relationType.numRelations ))
+          return false;
+    }
+
+    for ( const auto value : _values )
+      if ( value >= numStrings_ && value != NO_VALUE )
+        return false;
+
+    return _layoutPositions.empty( ) ||
+      _layoutPositions.size( ) == 2 * _layoutGIDs.size( );
+  }
+
+  bool BinaryScene::write( const std::string& fileName_ ) const
+  {
+    // Written to a temporary file and renamed when done, so a failed write
+    // never leaves a partial scene behind
+    QSaveFile file( QString::fromStdString( fileName_ ));
+    if ( !file.open( QIODevice::WriteOnly ))
+    {
+      Loggers::get( )->log( "Scene " + fileName_ + " could not be created",
+                            LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+      return false;
+    }
+
+    TBinarySceneHeader header;
+    memset( &header, 0, sizeof( TBinarySceneHeader ));
+    strncpy( header.magic, BINARY_SCENE_MAGIC, sizeof( header.magic ));
+    header.version = VERSION;
+    header.numStrings = numStrings( );
+    header.stringDataSize = _stringData.size( );
+    header.numEntities = _entities.size( );
+    header.numEntityColumns = _entityColumns.size( );
+    header.numRelationTypes = _relationTypes.size( );
+    header.numRelations = _relations.size( );
+    header.numRelationColumns = _relationColumns.size( );
+    header.numValues = _values.size( );
+    header.numLayoutGIDs = _layoutGIDs.size( );
+    header.numLayoutPositions = _layoutPositions.size( );
+    const auto layout_ = layout( header );
+    header.fileSize = layout_.end;
+
+    const void* sections[ NUM_SECTIONS ];
+    sections[ SECTION_INFO ] = &_info;
+    sections[ SECTION_STRING_OFFSETS ] = _stringOffsets.begin( );
+    sections[ SECTION_STRING_DATA ] = _stringData.begin( );
+    sections[ SECTION_ENTITIES ] = _entities.begin( );
+    sections[ SECTION_ENTITY_COLUMNS ] = _entityColumns.begin( );
+    sections[ SECTION_RELATION_TYPES ] = _relationTypes.begin( );
+    sections[ SECTION_RELATIONS ] = _relations.begin( );
+    sections[ SECTION_RELATION_COLUMNS ] = _relationColumns.begin( );
+    sections[ SECTION_VALUES ] = _values.begin( );
+    sections[ SECTION_LAYOUT_GIDS ] = _layoutGIDs.begin( );
+    sections[ SECTION_LAYOUT_POSITIONS ] = _layoutPositions.begin( );
+    header.checksum = checksum( header, sections, layout_ );
+
+    bool written =
+      writeAt( file, 0, &header, sizeof( TBinarySceneHeader ));
+    for ( unsigned int section = 0; written && section < NUM_SECTIONS;
+          ++section )
+      written = writeAt( file, layout_.offsets[ section ], sections[ section ],
+                         layout_.sizes[ section ]);
+    if ( !written || !file.commit( ))
+    {
+      Loggers::get( )->log( "Error writing scene " + fileName_,
+                            LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+      return false;
+    }
+    return true;
+  }
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef __NSLIB_BINARY_SCENE__
+#define __NSLIB_BINARY_SCENE__
+
+#include <nslib/api.h>
+#include <QFile>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nslib
+{
+  //! Entity row, type is a string index
+  typedef struct
+  {
+    uint32_t gid;
+    uint32_t type;
+    uint32_t isRoot;
+    uint32_t reserved;
+  } TBinarySceneEntity;
+
+  //! Property column of entities or of the relations of a type. Its values,
+  //! one per row, start at firstValue in the values array
+  typedef struct
+  {
+    uint32_t label;
+    uint32_t reserved;
+    uint64_t firstValue;
+  } TBinarySceneColumn;
+
+  //! Relations of a type are the range [ firstRelation, firstRelation +
+  //! numRelations ) and their properties the columns [ firstColumn,
+  //! firstColumn + numColumns )
+  typedef struct
+  {
+    uint32_t name;
+    uint32_t aggregated;
+    uint64_t firstRelation;
+    uint64_t numRelations;
+    uint32_t firstColumn;
+    uint32_t numColumns;
+  } TBinarySceneRelationType;
+
+  typedef struct
+  {
+    uint32_t source;
+    uint32_t dest;
+    //! Whether the relation has properties, even if none of them was stored
+    uint32_t hasData;
+    uint32_t reserved;
+  } TBinarySceneRelation;
+
+  //! Scene wide values. Domain name and maximums are string indices, the
+  //! latter holding the maximums as a JSON object
+  typedef struct
+  {
+    uint32_t domainName;
+    uint32_t maximums;
+    int32_t layoutType;
+    uint32_t reserved;
+  } TBinarySceneInfo;
+
+  //! Scene saved in a binary file (.nsb) with the same content as its JSON
+  //! export: fixed width entity, relation and layout tables and property
+  //! values stored in columns as indices into a table of unique strings.
+  //! Files are validated with the checksum of their header and used directly
+  //! from memory once mapped.
+  class NSLIB_API BinaryScene
+  {
+  public:
+
+    template < typename T >
+    class Array
+    {
+    public:
+      Array( void ) : _data( nullptr ), _size( 0 ) {}
+      Array( const T* data_, size_t size_ ) : _data( data_ ), _size( size_ ) {}
+      const T* begin( void ) const { return _data; }
+      const T* end( void ) const { return _data + _size; }
+      const T& operator[] ( size_t i ) const { return _data[ i ]; }
+      size_t size( void ) const { return _size; }
+      bool empty( void ) const { return _size == 0; }
+    protected:
+      const T* _data;
+      size_t _size;
+    };
+
+    static const uint32_t VERSION = 1;
+    //! Value of the rows without a property
+    static const uint32_t NO_VALUE = 0xFFFFFFFF;
+
+    BinaryScene( void );
+
+    //! Index of str in the string table, added if it is not there yet
+    uint32_t addString( const std::string& str );
+
+    //! Takes ownership of the tables filled while exporting a scene
+    void set( const TBinarySceneInfo& info,
+              std::vector< TBinarySceneEntity >&& entities,
+              std::vector< TBinarySceneColumn >&& entityColumns,
+              std::vector< TBinarySceneRelationType >&& relationTypes,
+              std::vector< TBinarySceneRelation >&& relations,
+              std::vector< TBinarySceneColumn >&& relationColumns,
+              std::vector< uint32_t >&& values,
+              std::vector< uint32_t >&& layoutGIDs,
+              std::vector< float >&& layoutPositions );
+
+    //! Maps fileName and checks its header, checksum and tables. Returns
+    //! false, logging why, if it is not a valid scene
+    bool load( const std::string& fileName );
+    bool write( const std::string& fileName ) const;
+
+    std::string string( uint32_t index ) const;
+
+    const TBinarySceneInfo& info( void ) const { return _info; }
+    size_t numStrings( void ) const { return _stringOffsets.size( ) - 1; }
+    const Array< TBinarySceneEntity >& entities( void ) const
+    {
+      return _entities;
+    }
+    const Array< TBinarySceneColumn >& entityColumns( void ) const
+    {
+      return _entityColumns;
+    }
+    const Array< TBinarySceneRelationType >& relationTypes( void ) const
+    {
+      return _relationTypes;
+    }
+    const Array< TBinarySceneRelation >& relations( void ) const
+    {
+      return _relations;
+    }
+    const Array< TBinarySceneColumn >& relationColumns( void ) const
+    {
+      return _relationColumns;
+    }
+    const Array< uint32_t >& values( void ) const { return _values; }
+    const Array< uint32_t >& layoutGIDs( void ) const { return _layoutGIDs; }
+    //! Pairs of x, y for each layout entity, only for the free layout
+    const Array< float >& layoutPositions( void ) const
+    {
+      return _layoutPositions;
+    }
+
+  protected:
+    void _reset( void );
+    bool _validate( void ) const;
+
+    TBinarySceneInfo _info;
+    Array< uint64_t > _stringOffsets;
+    Array< char > _stringData;
+    Array< TBinarySceneEntity > _entities;
+    Array< TBinarySceneColumn > _entityColumns;
+    Array< TBinarySceneRelationType > _relationTypes;
+    Array< TBinarySceneRelation > _relations;
+    Array< TBinarySceneColumn > _relationColumns;
+    Array< uint32_t > _values;
+    Array< uint32_t > _layoutGIDs;
+    Array< float > _layoutPositions;
+
+    std::vector< uint64_t > _stringOffsetsStorage;
+    std::string _stringDataStorage;
+    std::unordered_map< std::string, uint32_t > _stringIndices;
+    std::vector< TBinarySceneEntity > _entitiesStorage;
+    std::vector< TBinarySceneColumn > _entityColumnsStorage;
+    std::vector< TBinarySceneRelationType > _relationTypesStorage;
+    std::vector< TBinarySceneRelation > _relationsStorage;
+    std::vector< TBinarySceneColumn > _relationColumnsStorage;
+    std::vector< uint32_t > _valuesStorage;
+    std::vector< uint32_t > _layoutGIDsStorage;
+    std::vector< float > _layoutPositionsStorage;
+    std::unique_ptr< QFile > _file;
+  };
+}
+
+#endif
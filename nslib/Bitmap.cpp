@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#include "Bitmap.h"
+#include <algorithm>
+#include <bitset>
+
+namespace nslib
+{
+  static inline unsigned int popcount( Bitmap::TWord word )
+  {
+    return static_cast< unsigned int >(
+      std::bitset< Bitmap::WORD_BITS >( word ).count( ));
+  }
+
+  void Bitmap::set( unsigned int id, bool value )
+  {
+    const unsigned int word = id / WORD_BITS;
+    const TWord mask = TWord( 1 ) << ( id % WORD_BITS );
+    if ( word >= _words.size( ))
+    {
+      if ( !value )
+        return;
+      _words.resize( word + 1, 0 );
+    }
+    if ( value )
+      _words[ word ] |= mask;
+    else
+      _words[ word ] &= ~mask;
+  }
+
+  bool Bitmap::empty( void ) const
+  {
+    for ( const auto word : _words )
+      if ( word )
+        return false;
+    return true;
+  }
+
+  unsigned int Bitmap::count( void ) const
+  {
+    unsigned int count_ = 0;
+    for ( const auto word : _words )
+      count_ += popcount( word );
+    return count_;
+  }
+
+  unsigned int Bitmap::countAnd( const Bitmap& mask ) const
+  {
+    unsigned int count_ = 0;
+    const size_t numWords = std::min( _words.size( ), mask._words.size( ));
+    for ( size_t word = 0; word < numWords; ++word )
+      count_ += popcount( _words[ word ] & mask._words[ word ]);
+    return count_;
+  }
+
+  // Marker words keep the run bit in the highest bit, the number of words of
+  // the run in the next 31 bits and the number of literal words following
+  // the marker in the lowest 32 bits
+  static const uint64_t MAX_RUN_WORDS = ( uint64_t( 1 ) << 31 ) - 1;
+  static const uint64_t MAX_LITERAL_WORDS = ( uint64_t( 1 ) << 32 ) - 1;
+
+  static inline uint64_t markerRunWords( Bitmap::TWord marker )
+  {
+    return ( marker >> 32 ) & MAX_RUN_WORDS;
+  }
+
+  static inline bool markerRunBit( Bitmap::TWord marker )
+  {
+    return ( marker >> 63 ) != 0;
+  }
+
+  static inline uint64_t markerLiteralWords( Bitmap::TWord marker )
+  {
+    return marker & MAX_LITERAL_WORDS;
+  }
+
+  static inline Bitmap::TWord marker( bool runBit, uint64_t runWords,
+    uint64_t literalWords )
+  {
+    return ( Bitmap::TWord( runBit ) << 63 ) | ( runWords << 32 ) |
+      literalWords;
+  }
+
+  CompressedBitmap::CompressedBitmap( void )
+    : _marker( 0 )
+    , _numWords( 0 )
+    , _count( 0 )
+  {
+  }
+
+  CompressedBitmap::CompressedBitmap( const Bitmap& bitmap )
+    : CompressedBitmap( )
+  {
+    for ( const auto word : bitmap.words( ))
+      _append( word );
+  }
+
+  void CompressedBitmap::decompress( Bitmap& bitmap ) const
+  {
+    auto& words = bitmap.words( );
+    words.clear( );
+    words.reserve( _numWords );
+    Iterator iterator( *this );
+    TWord word;
+    while ( iterator.next( word ))
+      words.push_back( word );
+  }
+
+  unsigned int CompressedBitmap::countAnd( const Bitmap& mask ) const
+  {
+    unsigned int count_ = 0;
+    const auto& maskWords = mask.words( );
+    Iterator iterator( *this );
+    TWord word;
+    for ( size_t position = 0;
+          position < maskWords.size( ) && iterator.next( word ); ++position )
+      count_ += popcount( word & maskWords[ position ]);
+    return count_;
+  }
+
+  CompressedBitmap CompressedBitmap::unite( const CompressedBitmap& a,
+                                            const CompressedBitmap& b )
+  {
+    return _combine( a, b, []( TWord wordA, TWord wordB )
+      { return wordA | wordB; });
+  }
+
+  CompressedBitmap CompressedBitmap::intersect( const CompressedBitmap& a,
+                                                const CompressedBitmap& b )
+  {
+    return _combine( a, b, []( TWord wordA, TWord wordB )
+      { return wordA & wordB; });
+  }
+
+  CompressedBitmap CompressedBitmap::subtract( const CompressedBitmap& a,
+                                               const CompressedBitmap& b )
+  {
+    return _combine( a, b, []( TWord wordA, TWord wordB )
+      { return wordA & ~wordB; });
+  }
+
+  template < typename TOperation >
+  CompressedBitmap CompressedBitmap::_combine( const CompressedBitmap& a,
+    const CompressedBitmap& b, TOperation operation )
+  {
+    CompressedBitmap result;
+    Iterator iteratorA( a );
+    Iterator iteratorB( b );
+    const unsigned int numWords = std::max( a._numWords, b._numWords );
+    for ( unsigned int position = 0; position < numWords; ++position )
+    {
+      // The shortest bitmap is padded with empty words
+      TWord wordA = 0, wordB = 0;
+      if ( !iteratorA.next( wordA ))
+        wordA = 0;
+      if ( !iteratorB.next( wordB ))
+        wordB = 0;
+      result._append( operation( wordA, wordB ));
+    }
+    return result;
+  }
+
+  void CompressedBitmap::_append( TWord word )
+  {
+    ++_numWords;
+    _count += popcount( word );
+
+    if ( _data.empty( ))
+    {
+      _data.push_back( marker( false, 0, 0 ));
+      _marker = 0;
+    }
+
+    const TWord current = _data[ _marker ];
+    const uint64_t runWords = markerRunWords( current );
+    const uint64_t literalWords = markerLiteralWords( current );
+    const bool runBit = markerRunBit( current );
+
+    if ( word == 0 || word == ~TWord( 0 ))
+    {
+      const bool bit = ( word != 0 );
+      if ( literalWords == 0 && ( runWords == 0 || runBit == bit ) &&
+           runWords < MAX_RUN_WORDS )
+      {
+        _data[ _marker ] = marker( bit, runWords + 1, 0 );
+      }
+      else
+      {
+        _marker = _data.size( );
+        _data.push_back( marker( bit, 1, 0 ));
+      }
+    }
+    else
+    {
+      if ( literalWords < MAX_LITERAL_WORDS )
+      {
+        _data[ _marker ] = marker( runBit, runWords, literalWords + 1 );
+      }
+      else
+      {
+        _marker = _data.size( );
+        _data.push_back( marker( false, 0, 1 ));
+      }
+      _data.push_back( word );
+    }
+  }
+
+  CompressedBitmap::Iterator::Iterator( const CompressedBitmap& bitmap )
+    : _data( bitmap._data )
+    , _position( 0 )
+    , _runWords( 0 )
+    , _runBit( false )
+    , _literalWords( 0 )
+  {
+  }
+
+  bool CompressedBitmap::Iterator::next( TWord& word )
+  {
+    while ( true )
+    {
+      if ( _runWords > 0 )
+      {
+        --_runWords;
+        word = _runBit ? ~TWord( 0 ) : TWord( 0 );
+        return true;
+      }
+      if ( _literalWords > 0 )
+      {
+        --_literalWords;
+        word = _data[ _position++ ];
+        return true;
+      }
+      if ( _position >= _data.size( ))
+        return false;
+
+      const TWord current = _data[ _position++ ];
+      _runWords = markerRunWords( current );
+      _runBit = markerRunBit( current );
+      _literalWords = markerLiteralWords( current );
+    }
+  }
+}
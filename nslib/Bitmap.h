@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef __NSLIB_BITMAP__
+#define __NSLIB_BITMAP__
+
+#include <nslib/api.h>
+#include <cstdint>
+#include <vector>
+
+namespace nslib
+{
+  //! Dense bitmap of unsigned ids, growing as bits are set
+  class NSLIB_API Bitmap
+  {
+  public:
+    typedef uint64_t TWord;
+    static const unsigned int WORD_BITS = 64;
+
+    Bitmap( void ) {}
+
+    bool test( unsigned int id ) const
+    {
+      const unsigned int word = id / WORD_BITS;
+      return word < _words.size( ) &&
+        (( _words[ word ] >> ( id % WORD_BITS )) & 1u );
+    }
+
+    void set( unsigned int id, bool value = true );
+    void clear( void ) { _words.clear( ); }
+    bool empty( void ) const;
+
+    //! Number of bits set
+    unsigned int count( void ) const;
+    //! Number of bits set in both this and mask
+    unsigned int countAnd( const Bitmap& mask ) const;
+
+    //! Calls function( id ) for every bit set, in increasing order
+    template < typename TFunction >
+    void forEach( TFunction function ) const
+    {
+      for ( unsigned int word = 0; word < _words.size( ); ++word )
+      {
+        TWord bits = _words[ word ];
+        while ( bits )
+        {
+          unsigned int bit = 0;
+          while ((( bits >> bit ) & 1u ) == 0 )
+            ++bit;
+          function( word * WORD_BITS + bit );
+          bits &= bits - 1;
+        }
+      }
+    }
+
+    const std::vector< TWord >& words( void ) const { return _words; }
+    std::vector< TWord >& words( void ) { return _words; }
+
+  protected:
+    std::vector< TWord > _words;
+  };
+
+  //! Word-aligned run-length compressed bitmap, used to keep stored
+  //! selections. Runs of empty or full words are kept as a marker word
+  //! followed by the literal words that come after the run, so contiguous
+  //! id ranges take a couple of words whatever their length. Operations
+  //! walk both bitmaps word by word, linear in the number of words.
+  class NSLIB_API CompressedBitmap
+  {
+  public:
+    typedef Bitmap::TWord TWord;
+
+    CompressedBitmap( void );
+    CompressedBitmap( const Bitmap& bitmap );
+
+    void decompress( Bitmap& bitmap ) const;
+
+    //! Number of bits set
+    unsigned int count( void ) const { return _count; }
+    //! Number of bits set in both this and a dense mask
+    unsigned int countAnd( const Bitmap& mask ) const;
+
+    static CompressedBitmap unite( const CompressedBitmap& a,
+                                   const CompressedBitmap& b );
+    static CompressedBitmap intersect( const CompressedBitmap& a,
+                                       const CompressedBitmap& b );
+    //! Bits set in a but not in b
+    static CompressedBitmap subtract( const CompressedBitmap& a,
+                                      const CompressedBitmap& b );
+
+    //! Memory used by the encoded words, in bytes
+    size_t byteSize( void ) const { return _data.size( ) * sizeof( TWord ); }
+
+    //! Iterates the uncompressed words of a compressed bitmap
+    class NSLIB_API Iterator
+    {
+    public:
+      Iterator( const CompressedBitmap& bitmap );
+      //! Returns false once all the words have been visited
+      bool next( TWord& word );
+    protected:
+      const std::vector< TWord >& _data;
+      size_t _position;
+      uint64_t _runWords;
+      bool _runBit;
+      uint64_t _literalWords;
+    };
+
+  protected:
+    //! Appends a word at the end of the bitmap
+    void _append( TWord word );
+    template < typename TOperation >
+    static CompressedBitmap _combine( const CompressedBitmap& a,
+      const CompressedBitmap& b, TOperation operation );
+
+    std::vector< TWord > _data;
+    //! Position in _data of the last marker word
+    size_t _marker;
+    unsigned int _numWords;
+    unsigned int _count;
+  };
+}
+
+#endif
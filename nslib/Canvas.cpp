@@ -28,6 +28,7 @@
 #include "RepresentationCreatorManager.h"
 #include "reps/Item.h"
 #include <QHBoxLayout>
+#include <QScrollBar>
 #include <nslib/layouts/GridLayout.h>
 #include <nslib/layouts/CircularLayout.h>
 #include <nslib/layouts/CameraBasedLayout.h>
@@ -102,6 +103,7 @@ namespace nslib
 
     auto sceneRect = this->scene( )->itemsBoundingRect( );
     this->setSceneRect( sceneRect );
+    emit zoomed( );
 
     // Don't call superclass handler here
     // as wheel is normally used for moving scrollbars
@@ -123,7 +125,9 @@ namespace nslib
     : _graphicsView( new GraphicsView( parent_ ))
     , _graphicsScene( new GraphicsScene )
     , _activeLayoutIndex( -1 )
+    , _entitiesVersion( 0 )
     , _repsScale( 1.0f )
+    , _animator( new Animator( this ))
   {
     _graphicsScene->setParent( this );
     _graphicsView->setScene( _graphicsScene );
@@ -155,6 +159,13 @@ namespace nslib
     this->setLayout( Layout::TLayoutIndexes::CIRCULAR, new CircularLayout( ));
     this->setLayout( Layout::TLayoutIndexes::FREE,
       new FreeLayout( InteractionManager::statusBar( )));
+
+    connect( _graphicsView->horizontalScrollBar( ), SIGNAL( valueChanged( int )),
+             this, SLOT( updateVirtualItems( )));
+    connect( _graphicsView->verticalScrollBar( ), SIGNAL( valueChanged( int )),
+             this, SLOT( updateVirtualItems( )));
+    connect( _graphicsView, SIGNAL( zoomed( )),
+             this, SLOT( updateVirtualItems( )));
   }
 
   Canvas::~Canvas( void )
@@ -255,10 +266,7 @@ namespace nslib
     this->view( ).setSceneRect( rectf );
     this->view( ).setTransform( transf );
 
-    auto activeLayoutIndex_ =
-      this->layouts( ).getLayout( this->activeLayoutIndex( ));
-    if ( activeLayoutIndex_ )
-      activeLayoutIndex_->refresh( false );
+    PaneManager::requestRefresh( this, PaneManager::REFRESH_RESIZE );
   }
 
   void Canvas::showEvent( QShowEvent* /* event_ */ )
@@ -285,6 +293,19 @@ namespace nslib
     _activeLayoutIndex = activeLayoutIndex_;
   }
 
+  void Canvas::updateVirtualItems( void )
+  {
+    auto activeLayout = _layouts.getLayout( _activeLayoutIndex );
+    if ( !activeLayout || !activeLayout->virtualized( ))
+      return;
+
+    activeLayout->updateVirtualItems( );
+    // Items not created yet do not count in the scene bounds, keep all the
+    // virtual placements reachable when panning
+    _graphicsView->setSceneRect( _graphicsView->sceneRect( ) |
+      activeLayout->virtualBoundingRect( ));
+  }
+
   void Canvas::layoutChanged( int index )
   {
     if ( index <= Layout::TLayoutIndexes::UNDEFINED )
@@ -371,6 +392,7 @@ namespace nslib
   void Canvas::setEntities( shift::Entities& entities_)
   {
     _sceneEntities = _entities = entities_;
+    ++_entitiesVersion;
     if ( Config::showNoHierarchyEntities( ))
     {
       _entities.addEntities( DataManager::noHierarchyEntities( ));
@@ -475,83 +497,32 @@ namespace nslib
 
   void Canvas::refreshProperties( void )
   {
-    fires::Objects objs;
-    fires::Objects filteredObjs;
-
-    _properties.clear( );
-
-    for ( const auto& entity : _entities.vector( ))
-    {
-      if ( DataManager::entities( ).
-           relationships( ).count( "isSubEntityOf" ) != 0 )
-      {
-        const auto& relSubEntityOf =
-          *( DataManager::entities( ).
-             relationships( )[ "isSubEntityOf" ]->asOneToOne( ));
-        if ( relSubEntityOf.count( entity->entityGid( )) == 0 )
-        {
-          // If not subentity add it
-          objs.add( entity );
-        }
-        else
-        {
-          continue;
-        }
-      }
-      else // if the realtionship does not exist
-      {
-        objs.push_back( entity );
-      }
+    _properties = propertyColumns( ).ranges( );
+  }
 
-      for ( const auto& propertyGid_ : entity->properties( ))
-      {
-        const auto& prop = fires::PropertyGIDsManager::getPropertyLabel(
-          propertyGid_.first );
-        if ( fires::PropertyManager::getAggregator( propertyGid_.first ))
-        {
-          if ( _properties.find( prop ) == _properties.end( ))
-            _properties[ prop  ] = TPropertyData{ 0, 0 };
-        }
-      }
-    }
+  const PropertyColumns& Canvas::propertyColumns( void )
+  {
+    if ( _propertyColumns.valid( _entitiesVersion ))
+      return _propertyColumns;
 
-    fires::AggregateConfig aggregateConfigMax;
-    fires::AggregateConfig aggregateConfigMin;
+    shift::RelationshipOneToOne* relSubEntityOf = nullptr;
+    if ( DataManager::entities( ).
+         relationships( ).count( "isSubEntityOf" ) != 0 )
+      relSubEntityOf = DataManager::entities( ).
+        relationships( )[ "isSubEntityOf" ]->asOneToOne( );
 
-    for ( const auto& p : _properties )
+    std::vector< shift::Entity* > entities;
+    entities.reserve( _entities.size( ));
+    for ( const auto& entity : _entities.vector( ))
     {
-      aggregateConfigMax.addProperty(
-        p.first,
-        fires::PropertyManager::getAggregator( p.first ),
-        fires::PropertyAggregator::MAX );
-      aggregateConfigMin.addProperty(
-        p.first,
-        fires::PropertyManager::getAggregator( p.first ),
-        fires::PropertyAggregator::MIN );
+      // Sub-entities are not taken into account
+      if ( !relSubEntityOf ||
+           relSubEntityOf->count( entity->entityGid( )) == 0 )
+        entities.push_back( entity );
     }
 
-    fires::Aggregate aggregate;
-    fires::Objects aggregatedMinObjects = objs;
-    aggregate.eval( aggregatedMinObjects, aggregateConfigMin );
-    fires::Object* aggregatedMinObj = aggregatedMinObjects[ 0 ];
-
-    fires::Objects aggregatedMaxObjects = objs;
-    aggregate.eval( aggregatedMaxObjects, aggregateConfigMax );
-    fires::Object* aggregatedMaxObj = aggregatedMaxObjects[ 0 ];
-
-    for ( auto& p : _properties )
-    {
-      const std::string& label = p.first;
-      p.second = TPropertyData
-        {
-          fires::PropertyManager::getPropertyCaster( label )->toInt(
-            aggregatedMinObj->getProperty( label ),
-            fires::PropertyCaster::FLOOR ),
-          fires::PropertyManager::getPropertyCaster( label )->toInt(
-            aggregatedMaxObj->getProperty( label ),
-            fires::PropertyCaster::CEIL )
-        };
-    }
+    _propertyColumns.build( entities, _entitiesVersion );
+    return _propertyColumns;
   }
 
   void Canvas::addEntity( shift::Entity* entity_, const bool isInput_  )
@@ -561,6 +532,7 @@ namespace nslib
       _sceneEntities.add( entity_ );
     }
     _entities.add( entity_ );
+    ++_entitiesVersion;
   }
 
   void Canvas::removeEntity( const shift::Entity* entity_, const bool isInput_  )
@@ -570,6 +542,7 @@ namespace nslib
       _sceneEntities.removeIfContains( entity_ );
     }
     _entities.removeIfContains( entity_ );
+    ++_entitiesVersion;
   }
 
   qreal Canvas::repsScale( ) const
@@ -25,6 +25,8 @@
 #include <nslib/api.h>
 #include "layouts/Layouts.h"
 #include "Properties.h"
+#include "PropertyColumns.h"
+#include "layouts/Animator.h"
 #include <QWidget>
 #include <QGraphicsView>
 #include <QGraphicsSceneEvent>
@@ -43,6 +45,10 @@ namespace nslib
     void mouseReleaseEvent( QMouseEvent* event ) override;
     void mouseMoveEvent( QMouseEvent* event ) override;
 
+  signals:
+    //! Emitted after the view transform changes through the mouse wheel
+    void zoomed( void );
+
   protected:
     virtual void wheelEvent( QWheelEvent* event_ ) override;
 
@@ -102,6 +108,25 @@ namespace nslib
     shift::Entities& sceneEntities( void ) { return _sceneEntities; }
     const TProperties& properties( void ) { return _properties; }
     void refreshProperties( void );
+    const PropertyColumns& propertyColumns( void );
+    //! To be called when properties of the entities are edited, so caches
+    //! keyed on the entities version are rebuilt
+    void entitiesUpdated( void )
+    {
+      ++_entitiesVersion;
+    }
+    //! Increased every time the entities of the canvas or their properties
+    //! change
+    unsigned int entitiesVersion( void ) const
+    {
+      return _entitiesVersion;
+    }
+
+    //! Drives the layout animations of the items of this canvas
+    Animator& animator( void )
+    {
+      return *_animator;
+    }
 
     void repsScale( const qreal repsScale_ );
     qreal repsScale ( void ) const;
@@ -118,11 +143,16 @@ protected:
     shift::Entities _entities;
     shift::Entities _sceneEntities;
     TProperties _properties;
+    PropertyColumns _propertyColumns;
+    unsigned int _entitiesVersion;
 
     qreal _repsScale;
+    Animator* _animator;
 
   public slots:
     void layoutChanged( int );
+    //! Lets a virtualized active layout update its items to the new view
+    void updateVirtualItems( void );
   }; // class Canvas
 } // namespace nslib
 
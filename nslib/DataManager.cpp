@@ -23,6 +23,7 @@
 #include "DataManager.h"
 #include "PaneManager.h"
 #include "RepresentationCreatorManager.h"
+#include "SelectionManager.h"
 //#include "domains/domains.h"
 #include "error.h"
 #include <QMessageBox>
@@ -245,6 +246,8 @@ namespace nslib
     }
     entities.clear( );
     _rootEntities.clear( );
+    // Gids start over, so selections refer to the new entities otherwise
+    SelectionManager::reset( );
     shift::Entity::shiftEntityGid( 0 );
   }
 
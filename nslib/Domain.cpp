@@ -23,13 +23,447 @@
 
 #include <nslib/reps/QGraphicsItemRepresentation.h>
 #include "Domain.h"
+#include "BinaryScene.h"
 #include "DataManager.h"
 #include "PaneManager.h"
+#include "JSONReader.h"
 #include "Loggers.h"
+#include "ParallelFor.h"
 #include "RepresentationCreatorManager.h"
+#ifdef NEUROSCHEME_WITH_IOSTREAMS
+#include "SceneFile.h"
+#endif
+#include <fires/fires.h>
+#include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// Relations handed to the domain at once while streaming a scene
+#define RELATIONS_BATCH_SIZE 4096
+// Rows of a binary scene converted at once, in parallel
+#define BINARY_BATCH_SIZE 65536
+// Entities or relations imported between progress reports
+#define PROGRESS_REPORT_INTERVAL 1024
 
 namespace nslib
 {
+  namespace
+  {
+#ifndef NEUROSCHEME_WITH_IOSTREAMS
+    //! Compressed scenes cannot be read or written without Boost.Iostreams
+    bool isCompressedScene( const std::string& fileName )
+    {
+      for ( const std::string suffix : { ".gz", ".zst" })
+        if ( fileName.size( ) >= suffix.size( ) &&
+             fileName.compare( fileName.size( ) - suffix.size( ),
+                               suffix.size( ), suffix ) == 0 )
+          return true;
+      return false;
+    }
+#endif
+
+    //! Reads a string, number or boolean value, skipping any other value
+    bool readScalarJSON( JSONReader& reader, std::string& value )
+    {
+      const auto token = reader.next( );
+      switch ( token )
+      {
+        case JSONReader::JSON_STRING:
+        case JSONReader::JSON_NUMBER:
+          value = reader.value( );
+          return true;
+        case JSONReader::JSON_TRUE:
+          value = "true";
+          return true;
+        case JSONReader::JSON_FALSE:
+          value = "false";
+          return true;
+        default:
+          reader.skipValue( token );
+          return false;
+      }
+    }
+
+    bool readUIntJSON( JSONReader& reader, unsigned int& value )
+    {
+      std::string text;
+      if ( !readScalarJSON( reader, text ))
+        return false;
+      try
+      {
+        value = unsigned( std::stoul( text ));
+        return true;
+      }
+      catch ( const std::exception& )
+      {
+        return false;
+      }
+    }
+
+    bool readFloatJSON( JSONReader& reader, float& value )
+    {
+      std::string text;
+      if ( !readScalarJSON( reader, text ))
+        return false;
+      try
+      {
+        value = std::stof( text );
+        return true;
+      }
+      catch ( const std::exception& )
+      {
+        return false;
+      }
+    }
+
+    bool readEntityJSON( JSONReader& reader, TEntityJSON& entityJSON )
+    {
+      entityJSON.isRootEntity = false;
+      entityJSON.hasGID = false;
+      entityJSON.hasData = false;
+
+      JSONReader::TToken token;
+      while (( token = reader.next( )) == JSONReader::JSON_KEY )
+      {
+        const std::string key = reader.value( );
+        if ( key == "EntityType" )
+        {
+          readScalarJSON( reader, entityJSON.entityType );
+        }
+        else if ( key == "RootEntity" )
+        {
+          std::string isRoot;
+          if ( readScalarJSON( reader, isRoot ))
+            entityJSON.isRootEntity = !isRoot.empty( ) && isRoot[ 0 ] == 't';
+          else
+            Loggers::get( )->log( "ERROR: getting RootEntity from JSON",
+              LOG_LEVEL_WARNING );
+        }
+        else if ( key == "EntityGID" )
+        {
+          entityJSON.hasGID = readUIntJSON( reader, entityJSON.entityGID );
+        }
+        else if ( key == "EntityData" )
+        {
+          entityJSON.hasData = reader.readValue( entityJSON.entityData );
+        }
+        else
+        {
+          reader.skipValue( );
+        }
+      }
+      return token == JSONReader::JSON_END_OBJECT;
+    }
+
+    bool readLayoutJSON( JSONReader& reader, TLayoutJSON& layout )
+    {
+      layout.layoutType = Layout::TLayoutIndexes::GRID;
+
+      auto token = reader.next( );
+      if ( token != JSONReader::JSON_BEGIN_OBJECT )
+      {
+        reader.skipValue( token );
+        return false;
+      }
+
+      while (( token = reader.next( )) == JSONReader::JSON_KEY )
+      {
+        const std::string key = reader.value( );
+        if ( key == "LayoutType" )
+        {
+          unsigned int layoutType;
+          if ( readUIntJSON( reader, layoutType ))
+            layout.layoutType = int( layoutType );
+          else
+            Loggers::get( )->log( "ERROR: getting LayoutType from JSON",
+              LOG_LEVEL_WARNING );
+        }
+        else if ( key == "SceneEntities" )
+        {
+          token = reader.next( );
+          if ( token != JSONReader::JSON_BEGIN_ARRAY )
+          {
+            Loggers::get( )->log(
+              "ERROR: getting Scene entities Array from JSON",
+              LOG_LEVEL_WARNING );
+            reader.skipValue( token );
+            continue;
+          }
+          while (( token = reader.next( )) != JSONReader::JSON_END_ARRAY )
+          {
+            if ( token == JSONReader::JSON_ERROR )
+              return false;
+
+            unsigned int entityGID = 0;
+            bool hasGID = false;
+            float posx = 0.0f;
+            float posy = 0.0f;
+            if ( token == JSONReader::JSON_BEGIN_OBJECT )
+            {
+              while (( token = reader.next( )) == JSONReader::JSON_KEY )
+              {
+                const std::string field = reader.value( );
+                if ( field == "EntityGID" )
+                  hasGID = readUIntJSON( reader, entityGID );
+                else if ( field == "PosX" )
+                {
+                  if ( !readFloatJSON( reader, posx ))
+                    Loggers::get( )->log(
+                      "ERROR: getting entity pos x from JSON",
+                      LOG_LEVEL_WARNING );
+                }
+                else if ( field == "PosY" )
+                {
+                  if ( !readFloatJSON( reader, posy ))
+                    Loggers::get( )->log(
+                      "ERROR: getting entity pos y from JSON",
+                      LOG_LEVEL_WARNING );
+                }
+                else
+                  reader.skipValue( );
+              }
+              if ( token != JSONReader::JSON_END_OBJECT )
+                return false;
+            }
+            else if ( token == JSONReader::JSON_STRING ||
+                      token == JSONReader::JSON_NUMBER )
+            {
+              try
+              {
+                entityGID = unsigned( std::stoul( reader.value( )));
+                hasGID = true;
+              }
+              catch ( const std::exception& )
+              {
+              }
+            }
+            else
+            {
+              reader.skipValue( token );
+            }
+
+            if ( !hasGID )
+            {
+              Loggers::get( )->log( "ERROR: getting scene EntityGID from JSON",
+                LOG_LEVEL_ERROR );
+              continue;
+            }
+            layout.entityGIDs.push_back( entityGID );
+            layout.positions.push_back( std::make_pair( posx, posy ));
+          }
+        }
+        else
+        {
+          reader.skipValue( );
+        }
+      }
+      return token == JSONReader::JSON_END_OBJECT;
+    }
+  }
+
+  namespace
+  {
+    //! Labels of the scene sections, indexed by minimizeStream
+    const struct
+    {
+      const char* domain;
+      const char* maximums;
+      const char* layout;
+      const char* entities;
+      const char* continueBracket;
+      const char* relationsAfterEntities;
+      const char* relationsNoEntities;
+      const char* closeRelationTypes;
+      const char* close;
+    } sceneLabels[ 2 ] =
+    {
+      { "{\n  \"domain\": \"", "\",\n  \"maximums\": {\n",
+        "  },\n  \"layout\": {\n", "  },\n  \"entities\": [\n",
+        "\n    },\n", "    }\n  ],\n  \"relationships\": [\n",
+        "  ],\n  \"relationships\": [\n", "    }\n", "  ]\n}\n" },
+      { "{\"domain\":\"", "\",\"maximums\":{", "},\"layout\":{",
+        "},\"entities\":[", "},", "}],\"relationships\":[",
+        "],\"relationships\":[", "}", "]}" }
+    };
+
+    const struct
+    {
+      const char* continueBracket;
+      const char* entityType;
+      const char* rootEntity;
+      const char* entityGID;
+      const char* entityData;
+    } entityLabels[ 2 ] =
+    {
+      { "\n    },\n", "    {\n      \"EntityType\": \"",
+        "\",\n      \"RootEntity\": \"", "\",\n      \"EntityGID\": \"",
+        "\",\n      \"EntityData\":\n" },
+      { "},", "{\"EntityType\":\"", "\",\"RootEntity\":\"",
+        "\",\"EntityGID\":\"", "\",\"EntityData\":" }
+    };
+
+    const struct
+    {
+      const char* relationType;
+      const char* relations;
+      const char* source;
+      const char* dest;
+      const char* relationData;
+      const char* continueBracket;
+      const char* closeQuotations;
+      const char* closeRelations;
+      const char* closeEmptyRelations;
+    } relationLabels[ 2 ] =
+    {
+      { "      {\n      \"relationType\": \"", "\",\n      \"relations\": [\n",
+        "          {\n            \"Source\": \"", "\",\n            \"Dest\": \"",
+        "\",\n            \"RelationData\":\n", "\n          },\n", "\"\n",
+        "            }\n          ]\n", "          ]\n" },
+      { "{\"relationType\":\"", "\",\"relations\":[", "{\"Source\":\"",
+        "\",\"Dest\":\"", "\",\"RelationData\":", "},", "\"", "}]", "]" }
+    };
+
+    //! Elements serialized by each parallel chunk at least
+    const size_t SERIALIZE_CHUNK_SIZE = 512;
+
+    //! Runs serialize( stream, i ) for [ 0, size ) on the thread pool, each
+    //! chunk into its own buffer, and appends the non empty buffers in order
+    void serializeInParallel( size_t size, TJSONBuffers& buffers,
+      const std::function< void( std::ostream&, size_t ) >& serialize )
+    {
+      const auto numChunks = parallelChunks( size, SERIALIZE_CHUNK_SIZE );
+      std::vector< std::string > chunks( numChunks );
+      parallelFor( size, numChunks,
+        [ & ]( size_t begin, size_t end, unsigned int chunk )
+        {
+          std::ostringstream stream;
+          for ( auto i = begin; i < end; ++i )
+            serialize( stream, i );
+          chunks[ chunk ] = stream.str( );
+        });
+      for ( auto& chunk : chunks )
+        if ( !chunk.empty( ))
+          buffers.push_back( std::move( chunk ));
+    }
+
+    typedef struct
+    {
+      size_t row;
+      fires::PropertyGID property;
+      std::string value;
+    } TPropertyValue;
+
+    //! Appends a column for each property of objects, one row per object,
+    //! with its values appended to values. Null objects have no values.
+    //! Returns the number of columns added
+    uint32_t addPropertyColumns( const std::vector< fires::Object* >& objects,
+      BinaryScene& scene, std::vector< TBinarySceneColumn >& columns,
+      std::vector< uint32_t >& values )
+    {
+      const auto firstColumn = columns.size( );
+      std::unordered_map< fires::PropertyGID, size_t > columnIndices;
+
+      // Values are cast to strings in parallel a batch at a time and then
+      // added to the string table in order
+      for ( size_t first = 0; first < objects.size( );
+            first += BINARY_BATCH_SIZE )
+      {
+        const auto size = std::min< size_t >( BINARY_BATCH_SIZE,
+                                              objects.size( ) - first );
+        const auto numChunks = parallelChunks( size, SERIALIZE_CHUNK_SIZE );
+        std::vector< std::vector< TPropertyValue >> chunkValues( numChunks );
+        parallelFor( size, numChunks,
+          [ & ]( size_t begin, size_t end, unsigned int chunk )
+          {
+            for ( auto row = first + begin; row < first + end; ++row )
+            {
+              if ( !objects[ row ] )
+                continue;
+              for ( const auto& propPair : objects[ row ]->properties( ))
+              {
+                const auto caster =
+                  fires::PropertyManager::getPropertyCaster( propPair.first );
+                if ( caster )
+                  chunkValues[ chunk ].push_back( TPropertyValue{ row,
+                    propPair.first, caster->toString( propPair.second ) });
+              }
+            }
+          });
+
+        for ( const auto& chunkValues_ : chunkValues )
+          for ( const auto& value : chunkValues_ )
+          {
+            auto columnIt = columnIndices.find( value.property );
+            if ( columnIt == columnIndices.end( ))
+            {
+              columnIt = columnIndices.emplace(
+                value.property, columns.size( )).first;
+              columns.push_back( TBinarySceneColumn{ scene.addString(
+                fires::PropertyGIDsManager::getPropertyLabel(
+                  value.property )), 0, values.size( ) });
+              values.resize( values.size( ) + objects.size( ),
+                             BinaryScene::NO_VALUE );
+            }
+            values[ columns[ columnIt->second ].firstValue + value.row ] =
+              scene.addString( value.value );
+          }
+      }
+      return uint32_t( columns.size( ) - firstColumn );
+    }
+
+    //! Fills data as fires serializes an object with the values of row
+    void readPropertyColumns( const BinaryScene& scene,
+      const TBinarySceneColumn* columns, uint32_t numColumns, uint64_t row,
+      boost::property_tree::ptree& data )
+    {
+      data.clear( );
+      data.put( "objectLabel", "" );
+      boost::property_tree::ptree properties;
+      for ( uint32_t c = 0; c < numColumns; ++c )
+      {
+        const auto value = scene.values( )[ columns[ c ].firstValue + row ];
+        if ( value == BinaryScene::NO_VALUE )
+          continue;
+        auto& property = properties.push_back( std::make_pair(
+          std::string( ), boost::property_tree::ptree( )))->second;
+        property.put( "label", scene.string( columns[ c ].label ));
+        property.put( "value", scene.string( value ));
+      }
+      data.add_child( "properties", properties );
+    }
+  }
+
+  void GIDToEntity::insert( unsigned int gid, shift::Entity* entity )
+  {
+    if ( !find( gid ))
+      ++_size;
+
+    // Grow the vector as long as it stays reasonably dense
+    if ( gid < _dense.size( ) || gid < 2 * _size + 1024 )
+    {
+      if ( gid >= _dense.size( ))
+        _dense.resize( std::max( size_t( gid ) + 1, 2 * _dense.size( )),
+                       nullptr );
+      _dense[ gid ] = entity;
+    }
+    else
+    {
+      _sparse[ gid ] = entity;
+    }
+  }
+
+  shift::Entity* GIDToEntity::find( unsigned int gid ) const
+  {
+    if ( gid < _dense.size( ) && _dense[ gid ] )
+      return _dense[ gid ];
+    if ( _sparse.empty( ))
+      return nullptr;
+    const auto it = _sparse.find( gid );
+    return it == _sparse.end( ) ? nullptr : it->second;
+  }
+
   Domain::Domain( void )
     : _dataLoader( nullptr )
     , _entitiesTypes( nullptr )
@@ -73,7 +507,7 @@ namespace nslib
   void Domain::exportJSON( std::ostream& outputStream,
     bool minimizeStream )  const
   {
-    auto entities = DataManager::entities( ).vector( );
+    const auto& entities = DataManager::entities( ).vector( );
     if ( entities.empty( ))
     {
       Loggers::get( )->log( "ERROR: Exporting scene without entities.",
@@ -86,46 +520,23 @@ namespace nslib
         LOG_LEVEL_WARNING );
     }
 
-    std::string domainLabel;
-    std::string entitiesLabel;
-    std::string maximumsLabel;
-    std::string layoutLabel;
-    std::string continueBracket;
-    std::string relationsLabel;
-
-    if ( minimizeStream )
-    {
-      domainLabel = "{\"domain\":\"";
-      maximumsLabel = "\",\"maximums\":{";
-      layoutLabel = "},\"layout\":{";
-      entitiesLabel = "},\"entities\":[";
-      continueBracket = "},";
-      relationsLabel = entities.empty( ) ? "],\"relationships\":["
-        : "}],\"relationships\":[";
-    }
-    else
-    {
-      domainLabel = "{\n  \"domain\": \"";
-      maximumsLabel = "\",\n  \"maximums\": {\n";
-      layoutLabel = "  },\n  \"layout\": {\n";
-      entitiesLabel = "  },\n  \"entities\": [\n";
-      continueBracket = "\n    },\n";
-      relationsLabel = entities.empty( ) ? "  ],\n  \"relationships\": [\n"
-        : "    }\n  ],\n  \"relationships\": [\n";
+    const auto& labels = sceneLabels[ minimizeStream ? 1 : 0 ];
+    TJSONBuffers buffers;
 
-    }
+    // Maximums and layout are small and the layout needs the scene items,
+    // so they are written from this thread
+    std::ostringstream header;
+    header << labels.domain << _domainName << labels.maximums;
+    exportRepresentationMaxMin( header, minimizeStream );
+    header << labels.layout;
+    exportLayoutJSON( header, minimizeStream );
+    header << labels.entities;
+    buffers.push_back( header.str( ));
 
-    outputStream << domainLabel << _domainName
-       << maximumsLabel;
-    exportRepresentationMaxMin( outputStream, minimizeStream );
+    exportEntitiesJSON( buffers, minimizeStream );
 
-    outputStream << layoutLabel;
-    exportLayoutJSON( outputStream, minimizeStream );
-
-    outputStream << entitiesLabel;
-    exportEntitiesJSON( outputStream, minimizeStream );
-
-    outputStream << relationsLabel;
+    buffers.push_back( entities.empty( ) ? labels.relationsNoEntities
+                                         : labels.relationsAfterEntities );
 
     if ( !_exportRelations.empty( ) )
     {
@@ -139,358 +550,738 @@ namespace nslib
         }
         else
         {
-          outputStream << continueBracket;
+          buffers.push_back( labels.continueBracket );
         }
-        exportRelationTypeToJSON( relationName, outputStream, minimizeStream,
+        exportRelationTypeToJSON( relationName, buffers, minimizeStream,
           *isAggregated++ );
       }
-      if ( minimizeStream )
+      buffers.push_back( labels.closeRelationTypes );
+    }
+    buffers.push_back( labels.close );
+
+    // Buffers are written in order and released as they go, so the output
+    // is never held twice in memory
+    for ( auto& buffer : buffers )
+    {
+      outputStream.write( buffer.data( ), std::streamsize( buffer.size( )));
+      std::string( ).swap( buffer );
+    }
+    outputStream.flush( );
+  }
+
+  bool Domain::importJSON( std::istream& inputStream, const bool replaceGIDs,
+    const TProgressCallback& progressCallback )
+  {
+    // Size of the input, if known, to report progress
+    size_t totalBytes = 0;
+    if ( progressCallback )
+    {
+      const auto start = inputStream.tellg( );
+      if ( start != std::istream::pos_type( -1 ))
       {
-        outputStream << "}";
+        if ( inputStream.seekg( 0, std::ios::end ))
+          totalBytes = size_t( inputStream.tellg( ) - start );
+        inputStream.clear( );
+        inputStream.seekg( start );
+      }
+    }
+
+    return importJSONStream( inputStream, replaceGIDs, progressCallback,
+      [ totalBytes ]( size_t bytesRead )
+      {
+        return totalBytes == 0 ? -1.0f : float( bytesRead ) / totalBytes;
+      });
+  }
+
+  bool Domain::exportJSONFile( const std::string& fileName,
+    bool minimizeStream ) const
+  {
+#ifdef NEUROSCHEME_WITH_IOSTREAMS
+    SceneFileOutput outputStream( fileName );
+    if ( !outputStream.isOpen( ))
+    {
+      Loggers::get( )->log( "ERROR: unable to create scene " + fileName,
+        LOG_LEVEL_ERROR );
+      return false;
+    }
+    exportJSON( outputStream, minimizeStream );
+    if ( !outputStream.close( ))
+    {
+      Loggers::get( )->log( "ERROR: writing scene " + fileName,
+        LOG_LEVEL_ERROR );
+      return false;
+    }
+    return true;
+#else
+    if ( isCompressedScene( fileName ))
+    {
+      Loggers::get( )->log( "ERROR: compressed scenes are not supported, "
+        "unable to create scene " + fileName, LOG_LEVEL_ERROR );
+      return false;
+    }
+    std::ofstream outputStream( fileName, std::ios::binary );
+    if ( !outputStream.is_open( ))
+    {
+      Loggers::get( )->log( "ERROR: unable to create scene " + fileName,
+        LOG_LEVEL_ERROR );
+      return false;
+    }
+    exportJSON( outputStream, minimizeStream );
+    outputStream.close( );
+    if ( outputStream.fail( ))
+    {
+      Loggers::get( )->log( "ERROR: writing scene " + fileName,
+        LOG_LEVEL_ERROR );
+      return false;
+    }
+    return true;
+#endif
+  }
 
+  bool Domain::importJSONFile( const std::string& fileName,
+    const bool replaceGIDs, const TProgressCallback& progressCallback )
+  {
+#ifdef NEUROSCHEME_WITH_IOSTREAMS
+    SceneFileInput inputStream( fileName );
+    if ( !inputStream.isOpen( ))
+    {
+      Loggers::get( )->log( "ERROR: unable to open scene " + fileName,
+        LOG_LEVEL_ERROR );
+      return false;
+    }
+    // Compressed scenes report the progress of the compressed file read
+    const auto fileSize = inputStream.fileSize( );
+    const bool imported = importJSONStream( inputStream, replaceGIDs,
+      progressCallback, [ &inputStream, fileSize ]( size_t )
+      {
+        return fileSize == 0 ? -1.0f :
+          float( inputStream.fileBytesRead( )) / fileSize;
+      });
+    return imported && !inputStream.bad( );
+#else
+    if ( isCompressedScene( fileName ))
+    {
+      Loggers::get( )->log( "ERROR: compressed scenes are not supported, "
+        "unable to open scene " + fileName, LOG_LEVEL_ERROR );
+      return false;
+    }
+    std::ifstream inputStream( fileName, std::ios::binary );
+    if ( !inputStream.is_open( ))
+    {
+      Loggers::get( )->log( "ERROR: unable to open scene " + fileName,
+        LOG_LEVEL_ERROR );
+      return false;
+    }
+    const bool imported =
+      importJSON( inputStream, replaceGIDs, progressCallback );
+    return imported && !inputStream.bad( );
+#endif
+  }
+
+  bool Domain::importJSONStream( std::istream& inputStream,
+    const bool replaceGIDs, const TProgressCallback& progressCallback,
+    const TInputProgress& inputProgress )
+  {
+    JSONReader reader( inputStream );
+    int lastProgress = -1;
+    const auto reportProgress = [ & ]( void )
+    {
+      if ( !progressCallback )
+        return;
+      const float fraction = inputProgress( reader.bytesRead( ));
+      if ( fraction < 0.0f )
+        return;
+      const int progress = int( std::min( 1.0f, fraction ) * 100 );
+      if ( progress != lastProgress )
+      {
+        lastProgress = progress;
+        progressCallback( progress * 0.01f );
+      }
+    };
+
+    if ( reader.next( ) != JSONReader::JSON_BEGIN_OBJECT )
+    {
+      Loggers::get( )->log( "ERROR: reading JSON: " + ( reader.error( ).empty( )
+        ? std::string( "expected an object" ) : reader.error( )),
+        LOG_LEVEL_ERROR );
+      return false;
+    }
+
+    GIDToEntity oldGIDToEntity;
+    TLayoutJSON layout;
+    bool emptyJSON = true;
+    bool hasDomain = false;
+    bool hasMaximums = false;
+    bool hasEntities = false;
+    bool hasRelationships = false;
+    bool hasLayout = false;
+    unsigned int imported = 0;
+
+    JSONReader::TToken token;
+    while (( token = reader.next( )) == JSONReader::JSON_KEY )
+    {
+      emptyJSON = false;
+      const std::string section = reader.value( );
+
+      if ( section == "domain" )
+      {
+        std::string domainValue;
+        hasDomain = readScalarJSON( reader, domainValue );
+        if ( hasDomain && domainValue != _domainName )
+        {
+          Loggers::get( )->log( "ERROR parsing object: the domain must specify a "
+            + _domainName + " domain.", LOG_LEVEL_ERROR );
+        }
+      }
+      else if ( section == "maximums" )
+      {
+        boost::property_tree::ptree maximums;
+        hasMaximums = reader.readValue( maximums );
+        if ( hasMaximums )
+          importMaximumsJSON( maximums );
+      }
+      else if ( section == "layout" )
+      {
+        // Applied at the end, once the entities it refers to exist
+        hasLayout = readLayoutJSON( reader, layout );
+      }
+      else if ( section == "entities" )
+      {
+        token = reader.next( );
+        hasEntities = ( token == JSONReader::JSON_BEGIN_ARRAY );
+        if ( !hasEntities )
+        {
+          reader.skipValue( token );
+          continue;
+        }
+        while (( token = reader.next( )) == JSONReader::JSON_BEGIN_OBJECT )
+        {
+          TEntityJSON entityJSON;
+          if ( !readEntityJSON( reader, entityJSON ))
+            break;
+          importEntityJSON( entityJSON, &oldGIDToEntity, replaceGIDs );
+          if ( ++imported % PROGRESS_REPORT_INTERVAL == 0 )
+            reportProgress( );
+        }
+        if ( token != JSONReader::JSON_END_ARRAY )
+          break;
+      }
+      else if ( section == "relationships" )
+      {
+        token = reader.next( );
+        hasRelationships = ( token == JSONReader::JSON_BEGIN_ARRAY );
+        if ( !hasRelationships )
+        {
+          reader.skipValue( token );
+          continue;
+        }
+        while (( token = reader.next( )) == JSONReader::JSON_BEGIN_OBJECT )
+        {
+          std::string relationType;
+          // Relations are imported in batches once their type is known
+          boost::property_tree::ptree relations;
+          size_t batchSize = 0;
+          while (( token = reader.next( )) == JSONReader::JSON_KEY )
+          {
+            const std::string key = reader.value( );
+            if ( key == "relationType" )
+            {
+              if ( !readScalarJSON( reader, relationType ))
+                Loggers::get( )->log( "ERROR: getting relationType from JSON",
+                  LOG_LEVEL_WARNING );
+            }
+            else if ( key == "relations" )
+            {
+              token = reader.next( );
+              if ( token != JSONReader::JSON_BEGIN_ARRAY )
+              {
+                Loggers::get( )->log(
+                  "ERROR: getting relations array from JSON",
+                  LOG_LEVEL_WARNING );
+                reader.skipValue( token );
+                continue;
+              }
+              while (( token = reader.next( )) != JSONReader::JSON_END_ARRAY )
+              {
+                auto& relation = relations.push_back( std::make_pair(
+                  std::string( ), boost::property_tree::ptree( )))->second;
+                if ( !reader.readValue( token, relation ))
+                  break;
+                if ( !relationType.empty( ) &&
+                     ++batchSize == RELATIONS_BATCH_SIZE )
+                {
+                  importRelationsJSON( relationType, relations,
+                                       &oldGIDToEntity );
+                  relations.clear( );
+                  batchSize = 0;
+                }
+                if ( ++imported % PROGRESS_REPORT_INTERVAL == 0 )
+                  reportProgress( );
+              }
+            }
+            else
+            {
+              reader.skipValue( );
+            }
+          }
+          if ( !relations.empty( ) && !relationType.empty( ))
+            importRelationsJSON( relationType, relations, &oldGIDToEntity );
+          if ( token != JSONReader::JSON_END_OBJECT )
+            break;
+        }
+        if ( token != JSONReader::JSON_END_ARRAY )
+          break;
       }
       else
       {
-        outputStream << "    }" << std::endl;
+        reader.skipValue( );
       }
+
+      if ( !reader.error( ).empty( ))
+        break;
     }
-    if ( minimizeStream )
+
+    // The entities already imported stay, but the scene is not laid out
+    if ( token != JSONReader::JSON_END_OBJECT )
     {
-      outputStream << "]}";
+      Loggers::get( )->log( "ERROR: reading JSON: " + ( reader.error( ).empty( )
+        ? std::string( "unexpected value" ) : reader.error( )),
+        LOG_LEVEL_ERROR );
+      return false;
+    }
+    if ( emptyJSON )
+    {
+      Loggers::get( )->log( "ERROR: empty JSON file",
+        LOG_LEVEL_WARNING );
+      return false;
+    }
+
+    if ( !hasDomain )
+      Loggers::get( )->log( "ERROR: getting Domain from JSON",
+        LOG_LEVEL_WARNING );
+    if ( !hasMaximums )
+      Loggers::get( )->log( "ERROR: getting maximums object from JSON",
+        LOG_LEVEL_WARNING );
+    if ( !hasEntities )
+      Loggers::get( )->log( "ERROR: getting entities Array from JSON",
+        LOG_LEVEL_WARNING );
+    if ( !hasRelationships )
+      Loggers::get( )->log( "ERROR: getting relationships Array from JSON",
+        LOG_LEVEL_WARNING );
 
+    if ( hasLayout )
+    {
+      importLayoutJSON( layout, &oldGIDToEntity );
     }
     else
     {
-      outputStream << "  ]" << std::endl << "}" << std::endl;
+      Loggers::get( )->log( "ERROR: getting layout Object from JSON",
+        LOG_LEVEL_WARNING );
+      auto canvas = PaneManager::activePane( );
+      canvas->displayEntities( DataManager::rootEntities( ), false, true );
     }
+
+    if ( progressCallback )
+      progressCallback( 1.0f );
+    return true;
   }
 
-  void Domain::importJSON( std::istream& inputStream, const bool replaceGIDs )
+  bool Domain::exportBinary( const std::string& fileName ) const
   {
-    boost::property_tree::ptree root;
-    try
+    const auto& entities = DataManager::entities( ).vector( );
+    if ( entities.empty( ))
     {
-      boost::property_tree::read_json( inputStream, root );
+      Loggers::get( )->log( "ERROR: Exporting scene without entities.",
+        LOG_LEVEL_WARNING );
     }
-    catch ( const std::exception & ex )
+    if ( _exportRelations.size( ) != _exportAggregatedRelations.size( ))
     {
-      Loggers::get( )->log( "ERROR: reading JSON: " + std::string( ex.what( )),
-        LOG_LEVEL_ERROR );
-      return;
-    };
+      Loggers::get( )->log( "Not concordance between export relations size.",
+        LOG_LEVEL_WARNING );
+    }
 
-    if ( root.empty( ))
+    BinaryScene scene;
+    TBinarySceneInfo info;
+    memset( &info, 0, sizeof( TBinarySceneInfo ));
+    info.domainName = scene.addString( _domainName );
+    std::ostringstream maximums;
+    maximums << "{";
+    exportRepresentationMaxMin( maximums, true );
+    maximums << "}";
+    info.maximums = scene.addString( maximums.str( ));
+
+    TLayoutJSON layout;
+    sceneLayout( layout );
+    info.layoutType = layout.layoutType;
+    std::vector< uint32_t > layoutGIDs( layout.entityGIDs.begin( ),
+                                        layout.entityGIDs.end( ));
+    std::vector< float > layoutPositions;
+    layoutPositions.reserve( 2 * layout.positions.size( ));
+    for ( const auto& position : layout.positions )
     {
-      Loggers::get( )->log( "ERROR: empty JSON file",
-        LOG_LEVEL_WARNING );
-      return;
+      layoutPositions.push_back( position.first );
+      layoutPositions.push_back( position.second );
     }
-    try
+
+    const auto& rootEntitiesMap = DataManager::rootEntities( ).map( );
+    std::vector< TBinarySceneEntity > sceneEntities;
+    sceneEntities.reserve( entities.size( ));
+    for ( const auto& entity : entities )
+    {
+      const auto entityGID = entity->entityGid( );
+      sceneEntities.push_back( TBinarySceneEntity{ entityGID,
+        scene.addString( entity->typeName( )), uint32_t(
+          rootEntitiesMap.find( entityGID ) != rootEntitiesMap.end( )), 0 });
+    }
+    std::vector< TBinarySceneColumn > entityColumns;
+    std::vector< uint32_t > values;
+    addPropertyColumns( std::vector< fires::Object* >(
+      entities.begin( ), entities.end( )), scene, entityColumns, values );
+
+    std::vector< TBinarySceneRelationType > relationTypes;
+    std::vector< TBinarySceneRelation > relations;
+    std::vector< TBinarySceneColumn > relationColumns;
+    auto isAggregated = _exportAggregatedRelations.begin( );
+    for ( const auto& relationName : _exportRelations )
     {
-      const std::string domainValue = root.get< std::string >( "domain" );
-      if( domainValue != _domainName )
+      const bool aggregated = *isAggregated++;
+      TBinarySceneRelationType relationType{ scene.addString( relationName ),
+        uint32_t( aggregated ), relations.size( ), 0,
+        uint32_t( relationColumns.size( )), 0 };
+      std::vector< fires::Object* > properties;
+      if ( aggregated )
       {
-        Loggers::get( )->log( "ERROR parsing object: the domain must specify a "
-          + _domainName + " domain.", LOG_LEVEL_ERROR );
+        const auto& relationAggregatedOneToN = DataManager::entities( )
+          .relationships( )[ relationName ]->asAggregatedOneToN( )
+          ->mapAggregatedRels( );
+        for ( const auto& relOrig : relationAggregatedOneToN )
+          for ( const auto& relDest : *relOrig.second )
+          {
+            relations.push_back( TBinarySceneRelation{
+              relOrig.first, relDest.first, 1, 0 });
+            properties.push_back(
+              relDest.second.relationshipAggregatedProperties );
+          }
       }
+      else
+      {
+        const auto& relationOneToN = *( DataManager::entities( )
+          .relationships( )[ relationName ]->asOneToN( ));
+        for ( const auto& relOrig : relationOneToN )
+          for ( const auto& relDest : relOrig.second )
+          {
+            relations.push_back( TBinarySceneRelation{ relOrig.first,
+              relDest.first, uint32_t( relDest.second != nullptr ), 0 });
+            properties.push_back( relDest.second );
+          }
+      }
+      relationType.numRelations =
+        relations.size( ) - relationType.firstRelation;
+      relationType.numColumns = addPropertyColumns(
+        properties, scene, relationColumns, values );
+      relationTypes.push_back( relationType );
     }
-    catch ( const std::exception &ex )
+
+    scene.set( info, std::move( sceneEntities ), std::move( entityColumns ),
+      std::move( relationTypes ), std::move( relations ),
+      std::move( relationColumns ), std::move( values ),
+      std::move( layoutGIDs ), std::move( layoutPositions ));
+    return scene.write( fileName );
+  }
+
+  bool Domain::importBinary( const std::string& fileName,
+    const bool replaceGIDs, const TProgressCallback& progressCallback )
+  {
+    BinaryScene scene;
+    if ( !scene.load( fileName ))
+      return false;
+
+    const auto& info = scene.info( );
+    if ( scene.string( info.domainName ) != _domainName )
     {
-      Loggers::get( )->log( "ERROR: getting Domain from JSON: "
-        + std::string( ex.what( )), LOG_LEVEL_WARNING );
-    };
+      Loggers::get( )->log( "ERROR: the scene must specify a " + _domainName
+        + " domain.", LOG_LEVEL_ERROR );
+      return false;
+    }
 
     try
     {
-      boost::property_tree::ptree maximums = root.get_child( "maximums" );
+      boost::property_tree::ptree maximums;
+      std::istringstream maximumsStream( scene.string( info.maximums ));
+      boost::property_tree::read_json( maximumsStream, maximums );
       importMaximumsJSON( maximums );
     }
-    catch ( const std::exception &ex )
+    catch ( const std::exception& ex )
     {
-      Loggers::get( )->log( "ERROR: getting maximums object from JSON: "
+      Loggers::get( )->log( "ERROR: getting maximums from scene: "
         + std::string( ex.what( )), LOG_LEVEL_WARNING );
-    };
-
-    const auto oldGIDToEntity =
-      new std::unordered_map <unsigned int,shift::Entity*>( );
-
-    try
-    {
-      boost::property_tree::ptree entities = root.get_child( "entities" );
-      importEntititiesJSON( entities, oldGIDToEntity, replaceGIDs );
     }
-    catch ( const std::exception &ex )
+
+    const auto& entities = scene.entities( );
+    const auto& relations = scene.relations( );
+    const size_t total = entities.size( ) + relations.size( );
+    size_t imported = 0;
+    const auto reportProgress = [ & ]( size_t count )
     {
-      Loggers::get( )->log( "ERROR: getting entities Array from JSON: "
-        + std::string( ex.what( )), LOG_LEVEL_WARNING );
+      const auto previous = imported / PROGRESS_REPORT_INTERVAL;
+      imported += count;
+      if ( progressCallback &&
+           imported / PROGRESS_REPORT_INTERVAL != previous )
+        progressCallback( float( imported ) / float( total ));
     };
 
-    try
+    // Entity fields are read from the tables in parallel, entities are
+    // created in order
+    GIDToEntity oldGIDToEntity;
+    std::vector< TEntityJSON > batch( std::min< size_t >(
+      BINARY_BATCH_SIZE, entities.size( )));
+    for ( size_t first = 0; first < entities.size( );
+          first += BINARY_BATCH_SIZE )
     {
-      boost::property_tree::ptree relationships =
-        root.get_child( "relationships" );
-      importRelationshipsJSON( relationships, oldGIDToEntity );
+      const auto size = std::min< size_t >( BINARY_BATCH_SIZE,
+                                            entities.size( ) - first );
+      parallelFor( size, parallelChunks( size, SERIALIZE_CHUNK_SIZE ),
+        [ & ]( size_t begin, size_t end, unsigned int )
+        {
+          for ( auto i = begin; i < end; ++i )
+          {
+            const auto& entity = entities[ first + i ];
+            auto& entityJSON = batch[ i ];
+            entityJSON.entityType = scene.string( entity.type );
+            entityJSON.isRootEntity = entity.isRoot != 0;
+            entityJSON.hasGID = true;
+            entityJSON.entityGID = entity.gid;
+            entityJSON.hasData = true;
+            readPropertyColumns( scene, scene.entityColumns( ).begin( ),
+              uint32_t( scene.entityColumns( ).size( )), first + i,
+              entityJSON.entityData );
+          }
+        });
+      for ( size_t i = 0; i < size; ++i )
+        importEntityJSON( batch[ i ], &oldGIDToEntity, replaceGIDs );
+      reportProgress( size );
     }
-    catch ( const std::exception &ex )
-    {
-      Loggers::get( )->log( "ERROR: getting relationships Array from JSON: "
-        + std::string( ex.what( )), LOG_LEVEL_WARNING );
-    };
+    batch.clear( );
 
-    try
+    for ( const auto& relationType : scene.relationTypes( ))
     {
-      boost::property_tree::ptree layout = root.get_child( "layout" );
-      importLayoutJSON( layout, oldGIDToEntity );
+      const auto relationName = scene.string( relationType.name );
+      const auto columns =
+        scene.relationColumns( ).begin( ) + relationType.firstColumn;
+      for ( uint64_t first = 0; first < relationType.numRelations;
+            first += RELATIONS_BATCH_SIZE )
+      {
+        const auto size = std::min< uint64_t >( RELATIONS_BATCH_SIZE,
+          relationType.numRelations - first );
+        boost::property_tree::ptree relationsJSON;
+        for ( uint64_t i = first; i < first + size; ++i )
+        {
+          const auto& relation = relations[ relationType.firstRelation + i ];
+          auto& relationJSON = relationsJSON.push_back( std::make_pair(
+            std::string( ), boost::property_tree::ptree( )))->second;
+          relationJSON.put( "Source", relation.source );
+          relationJSON.put( "Dest", relation.dest );
+          if ( relation.hasData )
+          {
+            readPropertyColumns( scene, columns, relationType.numColumns, i,
+              relationJSON.put_child( "RelationData",
+                                      boost::property_tree::ptree( )));
+          }
+        }
+        importRelationsJSON( relationName, relationsJSON, &oldGIDToEntity );
+        reportProgress( size_t( size ));
+      }
     }
-    catch ( const std::exception &ex )
-    {
-      Loggers::get( )->log( "ERROR: getting layout Object from JSON: "
-        + std::string( ex.what( )), LOG_LEVEL_WARNING );
-      auto canvas = PaneManager::activePane( );
-      canvas->displayEntities( DataManager::rootEntities( ), false, true );
-    };
-
 
+    TLayoutJSON layout;
+    layout.layoutType = info.layoutType;
+    layout.entityGIDs.assign( scene.layoutGIDs( ).begin( ),
+                              scene.layoutGIDs( ).end( ));
+    const auto& positions = scene.layoutPositions( );
+    for ( size_t i = 0; i + 1 < positions.size( ); i += 2 )
+      layout.positions.push_back(
+        std::make_pair( positions[ i ], positions[ i + 1 ] ));
+    if ( layout.layoutType == Layout::TLayoutIndexes::FREE )
+      layout.positions.resize( layout.entityGIDs.size( ),
+                               std::make_pair( 0.0f, 0.0f ));
+    importLayoutJSON( layout, &oldGIDToEntity );
+
+    if ( progressCallback )
+      progressCallback( 1.0f );
+    return true;
   }
 
   void Domain::exportRelationTypeToJSON( const std::string& relationName,
-    std::ostream& outputStream, const bool minimizeStream,
+    TJSONBuffers& buffers, const bool minimizeStream,
     const bool aggregated ) const
   {
-    std::string relationTypeLabel;
-    std::string relationsLabel;
-    std::string sourceLabel;
-    std::string destLabel;
-    std::string relationDataLabel;
-    std::string continueBracket;
-    std::string closeQuotations;
-
-    if ( minimizeStream )
-    {
-      relationTypeLabel = "{\"relationType\":\"";
-      relationsLabel = "\",\"relations\":[";
-      sourceLabel =  "{\"Source\":\"";
-      destLabel = "\",\"Dest\":\"";
-      relationDataLabel = "\",\"RelationData\":";
-      continueBracket =  "},";
-      closeQuotations =  "\"";
-    }
-    else
-    {
-      relationTypeLabel = "      {\n      \"relationType\": \"";
-      relationsLabel = "\",\n      \"relations\": [\n";
-      sourceLabel =  "          {\n            \"Source\": \"";
-      destLabel = "\",\n            \"Dest\": \"";
-      relationDataLabel = "\",\n            \"RelationData\":\n";
-      continueBracket =  "\n          },\n";
-      closeQuotations =  "\"\n";
-    }
-
-    outputStream << relationTypeLabel
-      << relationName << relationsLabel;
+    const auto& labels = relationLabels[ minimizeStream ? 1 : 0 ];
+    buffers.push_back( std::string( labels.relationType ) + relationName +
+                       labels.relations );
 
-    bool firstIteration = true;
+    // Every relation is preceded by continueBracket, removed later from the
+    // first one
+    const auto firstBuffer = buffers.size( );
     if ( aggregated )
     {
       const auto& relationAggregatedOneToN = DataManager::entities( )
         .relationships( )[ relationName ]->asAggregatedOneToN( )
         ->mapAggregatedRels( );
+      std::vector< decltype( relationAggregatedOneToN.begin( )) > origins;
+      origins.reserve( relationAggregatedOneToN.size( ));
       for( auto relOrigIt = relationAggregatedOneToN.begin( );
         relOrigIt != relationAggregatedOneToN.end( ); ++relOrigIt )
-      {
-        for( auto relDestIt = relOrigIt->second->begin( );
-             relDestIt != relOrigIt->second->end( ); ++relDestIt )
+        origins.push_back( relOrigIt );
+
+      serializeInParallel( origins.size( ), buffers,
+        [ & ]( std::ostream& outputStream, size_t i )
         {
-          if( firstIteration )
-          {
-            firstIteration = false;
-          }
-          else
-          {
-            outputStream << continueBracket;
-          }
-          outputStream << sourceLabel << relOrigIt->first << destLabel
-            << relDestIt->first;
-          outputStream << relationDataLabel;
-          relDestIt->second.relationshipAggregatedProperties->serialize(
-            outputStream, minimizeStream, "            " );
-          if( !minimizeStream )
+          const auto& relOrigIt = origins[ i ];
+          for( auto relDestIt = relOrigIt->second->begin( );
+               relDestIt != relOrigIt->second->end( ); ++relDestIt )
           {
-            outputStream << std::endl;
+            outputStream << labels.continueBracket
+              << labels.source << relOrigIt->first << labels.dest
+              << relDestIt->first << labels.relationData;
+            relDestIt->second.relationshipAggregatedProperties->serialize(
+              outputStream, minimizeStream, "            " );
+            if( !minimizeStream )
+            {
+              outputStream << '\n';
+            }
           }
-        }
-      }
+        });
     }
     else
     {
       const auto& relationOneToN = *( DataManager::entities( )
         .relationships( )[ relationName ]->asOneToN( ));
+      std::vector< decltype( relationOneToN.begin( )) > origins;
+      origins.reserve( relationOneToN.size( ));
       for( auto relOrigIt = relationOneToN.begin( );
         relOrigIt != relationOneToN.end( ); ++relOrigIt )
-      {
-        for( auto relDestIt = relOrigIt->second.begin( );
-          relDestIt != relOrigIt->second.end( ); ++relDestIt )
+        origins.push_back( relOrigIt );
+
+      serializeInParallel( origins.size( ), buffers,
+        [ & ]( std::ostream& outputStream, size_t i )
         {
-          if( firstIteration )
-          {
-            firstIteration = false;
-          }
-          else
-          {
-            outputStream << continueBracket;
-          }
-          outputStream << sourceLabel << relOrigIt->first << destLabel
-            << relDestIt->first;
-          auto props = relDestIt->second;
-          if( props )
+          const auto& relOrigIt = origins[ i ];
+          for( auto relDestIt = relOrigIt->second.begin( );
+            relDestIt != relOrigIt->second.end( ); ++relDestIt )
           {
-            outputStream << relationDataLabel;
-            props->serialize( outputStream,
-              minimizeStream, "            " );
-            if( !minimizeStream )
+            outputStream << labels.continueBracket
+              << labels.source << relOrigIt->first << labels.dest
+              << relDestIt->first;
+            auto props = relDestIt->second;
+            if( props )
             {
-              outputStream << std::endl;
+              outputStream << labels.relationData;
+              props->serialize( outputStream,
+                minimizeStream, "            " );
+              if( !minimizeStream )
+              {
+                outputStream << '\n';
+              }
+            }
+            else
+            {
+              outputStream << labels.closeQuotations;
             }
           }
-          else
-          {
-            outputStream << closeQuotations;
-          }
-        }
-      }
+        });
     }
-    if ( minimizeStream )
+
+    if ( buffers.size( ) > firstBuffer )
     {
-      if ( !firstIteration )
-      {
-        outputStream << "}]";
-      }
-      else
-      {
-        outputStream << "]";
-      }
+      buffers[ firstBuffer ].erase( 0, strlen( labels.continueBracket ));
+      buffers.push_back( labels.closeRelations );
     }
     else
     {
-      if ( !firstIteration )
-      {
-        outputStream << "            }" << std::endl
-          << "          ]" << std::endl;
-      }
-      else
-      {
-        outputStream <<  "          ]" << std::endl;
-      }
+      buffers.push_back( labels.closeEmptyRelations );
     }
   }
 
-  void Domain::importEntityJSON( const boost::property_tree::ptree& entityJSON,
-    shift::Entity*& entity, bool& isRootEntity, unsigned int& entityGID,
-    const bool replaceGIDs )
+  void Domain::importEntityJSON( const TEntityJSON& entityJSON,
+    GIDToEntity* oldGIDToEntity, const bool replaceGIDs )
   {
+    shift::Entity* entity = nullptr;
     try
     {
-      const std::string entityType = entityJSON.get< std::string >( "EntityType" );
       if(!_entitiesTypes) throw std::runtime_error("Uninitialized _entitiesTypes.");
-      entity = _entitiesTypes->getEntityObject( entityType )->create( );
+      const auto entityObject =
+        _entitiesTypes->getEntityObject( entityJSON.entityType );
+      if ( !entityObject )
+        throw std::runtime_error( "unknown type \"" + entityJSON.entityType +
+                                  "\"" );
+      entity = entityObject->create( );
     }
     catch ( const std::exception &ex )
     {
       Loggers::get( )->log( "ERROR: getting EntityType from JSON: "
         + std::string( ex.what( )), LOG_LEVEL_WARNING );
+      return;
     };
 
-    try
-    {
-      isRootEntity = entityJSON.get< std::string >( "RootEntity" )[ 0 ] == 't';
-    }
-    catch ( const std::exception &ex )
-    {
-      Loggers::get( )->log( "ERROR: getting RootEntity from JSON: "
-        + std::string( ex.what( )), LOG_LEVEL_WARNING );
-    };
-
-    try
+    if ( !entityJSON.hasGID )
     {
-      entityGID = entityJSON.get< unsigned int >( "EntityGID" );
-      if ( replaceGIDs )
-      {
-        entity->entityGid( entityGID );
-        shift::Entity::shiftEntityGid( entityGID, true );
-      }
+      Loggers::get( )->log( "ERROR: getting EntityGID from JSON",
+        LOG_LEVEL_WARNING );
     }
-    catch ( const std::exception &ex )
-    {
-      Loggers::get( )->log( "ERROR: getting EntityGID from JSON: "
-        + std::string( ex.what( )), LOG_LEVEL_WARNING );
-    };
-
-    try
+    else if ( replaceGIDs )
     {
-      boost::property_tree::ptree firesJSON =
-        entityJSON.get_child( "EntityData" );
-      entity->deserialize( firesJSON );
+      entity->entityGid( entityJSON.entityGID );
+      shift::Entity::shiftEntityGid( entityJSON.entityGID, true );
     }
-    catch ( const std::exception &ex )
-    {
-      Loggers::get( )->log( "ERROR: getting EntityData from JSON: "
-        + std::string( ex.what( )), LOG_LEVEL_WARNING );
-    };
-  }
 
-  boost::property_tree::ptree& Domain::getRelationsOfType(
-    const std::string& relationName,
-    const boost::property_tree::ptree& relationships )
-  {
-
-    for ( const auto& relation : relationships )
+    if ( entityJSON.hasData )
     {
-      std::string relationType;
       try
       {
-        relationType = relation.second.get< std::string >( "relationType");
+        entity->deserialize( entityJSON.entityData );
       }
       catch ( const std::exception &ex )
       {
-        Loggers::get( )->log( "ERROR: getting relationType from JSON: "
+        Loggers::get( )->log( "ERROR: getting EntityData from JSON: "
           + std::string( ex.what( )), LOG_LEVEL_WARNING );
       };
+    }
+    else
+    {
+      Loggers::get( )->log( "ERROR: getting EntityData from JSON",
+        LOG_LEVEL_WARNING );
+    }
 
-      if ( relationType == relationName )
-      {
-        try
-        {
-          return ( boost::property_tree::ptree& )
-            relation.second.get_child( "relations" );
-        }
-        catch ( const std::exception &ex )
-        {
-          Loggers::get( )->log( "ERROR: getting relations array from JSON: "
-            + std::string( ex.what( )), LOG_LEVEL_WARNING );
-        };
-      }
+    if ( entityJSON.hasGID )
+      oldGIDToEntity->insert( entityJSON.entityGID, entity );
+    DataManager::entities( ).add( entity );
+    if( entity->isNotHierarchy( ))
+    {
+      DataManager::noHierarchyEntities( ).add( entity );
+    }
+    else if ( entityJSON.isRootEntity )
+    {
+      DataManager::rootEntities( ).add( entity );
     }
-    return *new boost::property_tree::ptree( );
   }
 
   void Domain::importJSONRelationGIDS(
     const  boost::property_tree::ptree& relation,
-    std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity,
+    GIDToEntity* oldGIDToEntity,
     shift::Entity*& origEntity, shift::Entity*& destEntity,
     const std::string& relationName, const bool checkConstrained )
   {
     try
     {
       const unsigned int origGID = relation.get< unsigned int >( "Source" );
-      auto search = oldGIDToEntity->find( origGID );
-      if( search == oldGIDToEntity->end( ))
+      origEntity = oldGIDToEntity->find( origGID );
+      if( !origEntity )
       {
         Loggers::get( )->log( "ERROR: old origGID doesn't exist",
           LOG_LEVEL_ERROR );
         origEntity = destEntity = nullptr;
         return;
-        }
-      origEntity = search->second;
+      }
     }
     catch ( const std::exception &ex )
     {
@@ -501,15 +1292,14 @@ namespace nslib
     try
     {
       const unsigned int destGID = relation.get< unsigned int >( "Dest");
-      auto search = oldGIDToEntity->find( destGID );
-      if( search == oldGIDToEntity->end( ))
+      destEntity = oldGIDToEntity->find( destGID );
+      if( !destEntity )
       {
         Loggers::get( )->log( "ERROR: old destGID doesn't exist",
           LOG_LEVEL_ERROR );
         origEntity = destEntity = nullptr;
         return;
       }
-      destEntity = search->second;
     }
     catch ( const std::exception &ex )
     {
@@ -532,7 +1322,7 @@ namespace nslib
 
   void Domain::addConnectsToRelationsFromJSON(
     const boost::property_tree::ptree& relations,
-    std::unordered_map< unsigned int, shift::Entity* >* oldGIDToEntity )
+    GIDToEntity* oldGIDToEntity )
   {
     auto& relAggregatedConnectsTo = *( DataManager::entities( )
       .relationships( )[ "aggregatedConnectsTo" ]->asAggregatedOneToN( ));
@@ -581,9 +1371,9 @@ namespace nslib
 
   void Domain::addIsParentOfRelationshipsFromJSON(
     const boost::property_tree::ptree& relations,
-    std::unordered_map<unsigned int, shift::Entity*>* oldGIDToEntity )
+    GIDToEntity* oldGIDToEntity )
   {
-    auto entities = DataManager::entities( );
+    auto& entities = DataManager::entities( );
     auto& relParentOf = *( entities
       .relationships( )[ "isParentOf" ]->asOneToN( ));
     auto& relChildOf = *( DataManager::entities( )
@@ -603,83 +1393,36 @@ namespace nslib
     }
   }
 
-  void Domain::importEntititiesJSON(
-    const boost::property_tree::ptree& entities,
-    std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity,
-    const bool replaceGIDs )
-  {
-    for ( const auto& entityJSON : entities )
-    {
-      shift::Entity* entity = nullptr;
-      bool isRootEntity;
-      unsigned int oldGID;
-      importEntityJSON( entityJSON.second, entity, isRootEntity,
-        oldGID, replaceGIDs );
-      oldGIDToEntity->insert( std::make_pair( oldGID, entity ));
-      DataManager::entities( ).add( entity );
-      if( entity->isNotHierarchy( ))
-      {
-        DataManager::noHierarchyEntities( ).add( entity );
-      }
-      else if ( isRootEntity )
-      {
-        DataManager::rootEntities( ).add( entity );
-      }
-    }
-  }
-
-  void Domain::exportEntitiesJSON( std::ostream &outputStream,
+  void Domain::exportEntitiesJSON( TJSONBuffers& buffers,
     bool minimizeStream ) const
   {
-    std::string continueBracket;
-    std::string entityTypeLabel;
-    std::string rootEntityLabel;
-    std::string entityGIDLabel;
-    std::string entityDataLabel;
-    if ( minimizeStream )
-    {
-      continueBracket = "},";
-      entityTypeLabel = "{\"EntityType\":\"";
-      rootEntityLabel = "\",\"RootEntity\":\"";
-      entityGIDLabel = "\",\"EntityGID\":\"";
-      entityDataLabel = "\",\"EntityData\":";
-    }
-    else
-    {
-      continueBracket = "\n    },\n";
-      entityTypeLabel = "    {\n      \"EntityType\": \"";
-      rootEntityLabel = "\",\n      \"RootEntity\": \"";
-      entityGIDLabel = "\",\n      \"EntityGID\": \"";
-      entityDataLabel = "\",\n      \"EntityData\":\n";
-    }
-    auto entities = DataManager::entities( ).vector( );
-    auto rootEntitiesMap = DataManager::rootEntities( ).map( );
-    bool firstIteration = true;
-    for ( const auto &entity : entities )
-    {
-      if ( firstIteration )
-      {
-        firstIteration = false;
-      }
-      else
+    const auto& labels = entityLabels[ minimizeStream ? 1 : 0 ];
+    const auto& entities = DataManager::entities( ).vector( );
+    const auto& rootEntitiesMap = DataManager::rootEntities( ).map( );
+
+    serializeInParallel( entities.size( ), buffers,
+      [ & ]( std::ostream& outputStream, size_t i )
       {
-        outputStream << continueBracket;
-      }
-      const auto entityGID = entity->entityGid( );
-      const char isRoot = ( rootEntitiesMap.find( entityGID )
-        != rootEntitiesMap.end( )) ? 't' : 'f';
+        const auto& entity = entities[ i ];
+        if ( i > 0 )
+        {
+          outputStream << labels.continueBracket;
+        }
+        const auto entityGID = entity->entityGid( );
+        const char isRoot = ( rootEntitiesMap.find( entityGID )
+          != rootEntitiesMap.end( )) ? 't' : 'f';
 
-      outputStream << entityTypeLabel  << entity->typeName( )
-        << rootEntityLabel << isRoot << entityGIDLabel
-        << entityGID << entityDataLabel;
+        outputStream << labels.entityType  << entity->typeName( )
+          << labels.rootEntity << isRoot << labels.entityGID
+          << entityGID << labels.entityData;
 
-      entity->serialize( outputStream, minimizeStream, "        " );
-    }
+        entity->serialize( outputStream, minimizeStream, "        " );
+      });
   }
 
   void Domain::addAggregatedConnectionFromJSON(
     const boost::property_tree::ptree& relations, const std::string& name,
-    std::unordered_map< unsigned int, shift::Entity* >* oldGIDToEntity )
+    GIDToEntity* oldGIDToEntity )
   {
     auto& relAggregatedOneToN = *( DataManager::entities( )
       .relationships( )[ name ]->asAggregatedOneToN( ));
@@ -706,12 +1449,65 @@ namespace nslib
         shift::RelationshipProperties* propObject =
           relAggregatedOneToN.getRelationProperties( origEntity->entityGid( ),
           destEntity->entityGid( ));
+        if ( !propObject )
+        {
+          Loggers::get( )->log( "ERROR: " + name + " relation without "
+            "aggregated connections", LOG_LEVEL_WARNING );
+          continue;
+        }
         propObject->deserialize( firesData );
         propObject->autoUpdateProperties( );
       }
     }
   }
 
+  void Domain::sceneLayout( TLayoutJSON& layout ) const
+  {
+    auto currentCanvas = PaneManager::activePane( );
+    layout.layoutType = currentCanvas->activeLayoutIndex( );
+    layout.entityGIDs.clear( );
+    layout.positions.clear( );
+    const bool freeLayout = ( layout.layoutType == Layout::TLayoutIndexes::FREE );
+    shift::Entities& paneEntities = currentCanvas->sceneEntities( );
+    const auto& gidsToEntitiesReps =
+      RepresentationCreatorManager::gidsToEntitiesReps( );
+    for ( auto entity : paneEntities.vector( ))
+    {
+      const auto entityGid = entity->entityGid( );
+      layout.entityGIDs.push_back( entityGid );
+      if ( !freeLayout )
+        continue;
+
+      float posx = 0.0f;
+      float posy = 0.0f;
+      auto rep =
+        gidsToEntitiesReps.find( entityGid );
+
+      if ( rep == gidsToEntitiesReps.end( ))
+      {
+        Loggers::get( )->log( "Representation not found", LOG_LEVEL_WARNING );
+      }
+      else
+      {
+        auto graphicsItemRep =
+          dynamic_cast< QGraphicsItemRepresentation* >( rep->second.second );
+        if ( graphicsItemRep)
+        {
+          auto item = graphicsItemRep->item( &currentCanvas->scene( ));
+          auto itemPos = item->pos( );
+          posx = static_cast<float>(itemPos.x( ));
+          posy = static_cast<float>(itemPos.y( ));
+        }
+        else
+        {
+          Loggers::get( )->log( "GraphicsItemRep not found",
+            LOG_LEVEL_WARNING );
+        }
+      }
+      layout.positions.push_back( std::make_pair( posx, posy ));
+    }
+  }
+
   void Domain::exportLayoutJSON( std::ostream& outputStream,
     const bool minimizeStream ) const
   {
@@ -743,12 +1539,10 @@ namespace nslib
       entityPosYLabel = ",\n        \"PosY\": ";
     }
 
-    auto currentCanvas = PaneManager::activePane( );
-    const int layoutIndex = currentCanvas->activeLayoutIndex( );
-    shift::Entities& paneEntities = currentCanvas->sceneEntities( );
-    outputStream << layoutTypeLabel << layoutIndex << entitiesLabel;
-    bool firstIteration = true;
-    if (layoutIndex == Layout::TLayoutIndexes::FREE )
+    TLayoutJSON layout;
+    sceneLayout( layout );
+    outputStream << layoutTypeLabel << layout.layoutType << entitiesLabel;
+    if ( layout.layoutType == Layout::TLayoutIndexes::FREE )
     {
       if ( minimizeStream )
       {
@@ -761,175 +1555,79 @@ namespace nslib
         closeEntitiesLabel = "\n    }\n    ]\n";
       }
 
-      auto gidsToEntitiesReps =
-        RepresentationCreatorManager::gidsToEntitiesReps( );
-      for (auto entity : paneEntities.vector( ))
+      for ( size_t i = 0; i < layout.entityGIDs.size( ); ++i )
       {
-        if ( firstIteration )
-        {
-          firstIteration = false;
-        }
-        else
+        if ( i > 0 )
         {
           outputStream << continueBracket;
         }
-
-        const auto entityGid = entity->entityGid( );
-        float posx = 0.0f;
-        float posy = 0.0f;
-        auto rep =
-          gidsToEntitiesReps.find( entityGid );
-
-        if ( rep == gidsToEntitiesReps.end( ))
-        {
-          Loggers::get( )->log( "Representation not found", LOG_LEVEL_WARNING );
-        }
-        else
-        {
-          auto graphicsItemRep =
-            dynamic_cast< QGraphicsItemRepresentation* >( rep->second.second );
-          if ( graphicsItemRep)
-          {
-            auto item = graphicsItemRep->item( &currentCanvas->scene( ));
-            auto itemPos = item->pos( );
-            posx = static_cast<float>(itemPos.x( ));
-            posy = static_cast<float>(itemPos.y( ));
-          }
-          else
-          {
-            Loggers::get( )->log( "GraphicsItemRep not found",
-              LOG_LEVEL_WARNING );
-          }
-        }
-
-        outputStream << entityGIDLabel << entityGid << entityPosXLabel
-          << posx << entityPosYLabel << posy;
+        outputStream << entityGIDLabel << layout.entityGIDs[ i ]
+          << entityPosXLabel << layout.positions[ i ].first
+          << entityPosYLabel << layout.positions[ i ].second;
       }
     }
     else
     {
-      for (auto entity : paneEntities.vector( ))
+      for ( size_t i = 0; i < layout.entityGIDs.size( ); ++i )
       {
-        if ( firstIteration )
-        {
-          firstIteration = false;
-        }
-        else
+        if ( i > 0 )
         {
           outputStream << continueBracket;
         }
-        outputStream << entity->entityGid( );
+        outputStream << layout.entityGIDs[ i ];
       }
     }
     outputStream << closeEntitiesLabel;
   }
 
-  void Domain::importLayoutJSON(
-    const boost::property_tree::ptree& layoutObject,
-    std::unordered_map<unsigned int, shift::Entity*>* oldGIDToEntity )
+  void Domain::importLayoutJSON( const TLayoutJSON& layout,
+    GIDToEntity* oldGIDToEntity )
   {
     auto canvas = PaneManager::activePane( );
-    int layoutTypeIndex = Layout::TLayoutIndexes::GRID;
-    try
-    {
-      layoutTypeIndex = layoutObject.get<int>( "LayoutType" );
-    }
-    catch ( const std::exception &ex )
-    {
-      Loggers::get( )->log( "ERROR: getting LayoutType from JSON: "
-        + std::string( ex.what( )), LOG_LEVEL_WARNING );
-    };
-    canvas->layoutChanged( layoutTypeIndex );
-    boost::property_tree::ptree entities;
-    try
-    {
-      entities = layoutObject.get_child( "SceneEntities" );
-    }
-    catch ( const std::exception &ex )
-    {
-      Loggers::get( )->log( "ERROR: getting Scene entities Array from JSON: "
-        + std::string( ex.what( )), LOG_LEVEL_WARNING );
-    };
+    canvas->layoutChanged( layout.layoutType );
 
     shift::Entities entitiesNewScene;
-    if ( layoutTypeIndex == Layout::TLayoutIndexes::FREE )
+    if ( layout.layoutType == Layout::TLayoutIndexes::FREE )
     {
       FreeLayout* freeLayout = dynamic_cast< FreeLayout* >(
         canvas->layouts( ) .getLayout( Layout::TLayoutIndexes::FREE ));
       bool moveNewEntities = freeLayout->moveNewEntitiesChecked( );
       freeLayout->moveNewEntitiesChecked( false );
-      for ( auto entityJSON : entities )
+      for ( size_t i = 0; i < layout.entityGIDs.size( ); ++i )
       {
-        shift::Entity* entity = nullptr;
-        try
+        shift::Entity* entity = oldGIDToEntity->find( layout.entityGIDs[ i ]);
+        if ( !entity )
         {
-          const auto entiyGID = entityJSON.second.get<int>( "EntityGID" );
-          auto search = oldGIDToEntity->find( entiyGID );
-          if ( search == oldGIDToEntity->end( ))
-          {
-            Loggers::get( )->log( "ERROR: old scene EntityGID doesn't exist",
-              LOG_LEVEL_ERROR );
-          }
-          else
-          {
-            entity = search->second;
-          }
+          Loggers::get( )->log( "ERROR: old scene EntityGID doesn't exist",
+            LOG_LEVEL_ERROR );
+          continue;
         }
-        catch( const std::exception &ex )
+        const float posx = layout.positions[ i ].first;
+        const float posy = layout.positions[ i ].second;
+        entitiesNewScene.add( entity );
+        shift::Entities loadEntity;
+        loadEntity.add( entity );
+        shift::Representations loadRep;
+        RepresentationCreatorManager::create(loadEntity,loadRep,true,true);
+        if( loadRep.empty( ))
         {
-          entity = nullptr;
-          Loggers::get( )->log( "ERROR: getting scene EntityGID from JSON: "
-            + std::string( ex.what( )), LOG_LEVEL_ERROR );
-        };
-        if ( entity )
+          Loggers::get( )->log(
+            "ERROR: Unable to create entity representation for: "
+            + std::to_string( entity->entityGid( )), LOG_LEVEL_WARNING );
+        }
+        else
         {
-          float posx = 0.0f;
-          float posy = 0.0f;
-          try
-          {
-            posx = entityJSON.second.get<float>( "PosX" );
-          }
-          catch( const std::exception &ex )
-          {
-            Loggers::get( )->log(
-              "ERROR: getting entity pos x from JSON: "
-              + std::string( ex.what( )), LOG_LEVEL_WARNING );
-          };
-          try
-          {
-            posy = entityJSON.second.get<float>( "PosY" );
-          }
-          catch( const std::exception &ex )
-          {
-            Loggers::get( )->log(
-              "ERROR: getting entity pos y from JSON: "
-              + std::string( ex.what( )), LOG_LEVEL_WARNING );
-          };
-          entitiesNewScene.add( entity );
-          shift::Entities loadEntity;
-          loadEntity.add( entity );
-          shift::Representations loadRep;
-          RepresentationCreatorManager::create(loadEntity,loadRep,true,true);
-          if( loadRep.empty( ))
+          auto graphicsItemRep =
+            dynamic_cast< QGraphicsItemRepresentation* >( loadRep.at( 0 ));
+          if ( graphicsItemRep)
           {
-            Loggers::get( )->log(
-              "ERROR: Unable to create entity representation for: "
-              + std::to_string( entity->entityGid( )), LOG_LEVEL_WARNING );
+            auto item = graphicsItemRep->item( &canvas->scene( ));
+            item->setPos(posx, posy );
           }
           else
           {
-            auto graphicsItemRep =
-              dynamic_cast< QGraphicsItemRepresentation* >( loadRep.at( 0 ));
-            if ( graphicsItemRep)
-            {
-              auto item = graphicsItemRep->item( &canvas->scene( ));
-              item->setPos(posx, posy );
-            }
-            else
-            {
-              Loggers::get( )->log( "GraphicsItemRep not found",
-                LOG_LEVEL_WARNING );
-            }
+            Loggers::get( )->log( "GraphicsItemRep not found",
+              LOG_LEVEL_WARNING );
           }
         }
       }
@@ -938,28 +1636,18 @@ namespace nslib
     }
     else
     {
-      for( auto entityJSON : entities )
+      for ( const auto entityGID : layout.entityGIDs )
       {
-        try
+        shift::Entity* entity = oldGIDToEntity->find( entityGID );
+        if ( !entity )
         {
-          auto entiyGID = entityJSON.second.get<int>( "" );
-          auto search = oldGIDToEntity->find( entiyGID );
-          if( search == oldGIDToEntity->end( ))
-          {
-            Loggers::get( )->log( "ERROR: old scene EntityGID doesn't exist",
-              LOG_LEVEL_ERROR );
-          }
-          else
-          {
-            shift::Entity* entity = search->second;
-            entitiesNewScene.add( entity );
-          }
+          Loggers::get( )->log( "ERROR: old scene EntityGID doesn't exist",
+            LOG_LEVEL_ERROR );
         }
-        catch( const std::exception &ex )
+        else
         {
-          Loggers::get( )->log( "ERROR: getting scene EntityGID from JSON: "
-            + std::string( ex.what( )), LOG_LEVEL_ERROR );
-        };
+          entitiesNewScene.add( entity );
+        }
       }
       canvas->displayEntities( entitiesNewScene, false, true );
     }
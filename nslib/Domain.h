@@ -32,6 +32,10 @@
 #include <QMainWindow>
 #include <QMenuBar>
 #include <Eigen/Dense>
+#include <boost/property_tree/ptree.hpp>
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
 #include "DataLoader.h"
 
@@ -41,6 +45,49 @@ namespace nslib
   using Matrix4f = ::Eigen::Matrix4f;
   using Vector4f = ::Eigen::Vector4f;
 
+  //! Maps the entity GIDs found in an imported scene to the entities created
+  //! for them. Exported GIDs are dense so they index a vector, while GIDs far
+  //! beyond the ones seen so far are kept in a hash map.
+  class NSLIB_API GIDToEntity
+  {
+  public:
+    GIDToEntity( void ) : _size( 0 ) {}
+
+    void insert( unsigned int gid, shift::Entity* entity );
+    //! Returns nullptr for unknown gids
+    shift::Entity* find( unsigned int gid ) const;
+    size_t size( void ) const { return _size; }
+
+  protected:
+    std::vector< shift::Entity* > _dense;
+    std::unordered_map< unsigned int, shift::Entity* > _sparse;
+    size_t _size;
+  };
+
+  //! Fields of an entity of an imported scene
+  typedef struct
+  {
+    std::string entityType;
+    bool isRootEntity;
+    bool hasGID;
+    unsigned int entityGID;
+    bool hasData;
+    boost::property_tree::ptree entityData;
+  } TEntityJSON;
+
+  //! Layout section of an imported scene, applied once all entities and
+  //! relationships have been created
+  typedef struct
+  {
+    int layoutType;
+    std::vector< unsigned int > entityGIDs;
+    //! Position of each entity, only for the free layout
+    std::vector< std::pair< float, float >> positions;
+  } TLayoutJSON;
+
+  //! Pieces of a serialized scene, written in order
+  typedef std::vector< std::string > TJSONBuffers;
+
   class NSLIB_API Domain
   {
 
@@ -62,11 +109,44 @@ namespace nslib
     const shift::RelationshipPropertiesTypes &
     relationshipPropertiesTypes( void ) const;
 
+    //! Serializes entities and relationships on the thread pool into
+    //! per chunk buffers, written in order at the end
     virtual void exportJSON( std::ostream& outputStream,
       bool minimizeStream = false ) const;
 
-    virtual void importJSON( std::istream& inputStream,
-      const bool replaceGIDs = false );
+    //! Called with the fraction of the input already imported
+    typedef std::function< void( float ) > TProgressCallback;
+
+    //! Creates the entities and relationships of the scene while it is
+    //! parsed, without building the whole JSON document in memory.
+    //! Relationship types are imported in the order they appear, which is
+    //! the order exportJSON writes them. Returns false if the input is not
+    //! a valid scene, in which case the layout is not applied.
+    virtual bool importJSON( std::istream& inputStream,
+      const bool replaceGIDs = false,
+      const TProgressCallback& progressCallback = nullptr );
+
+    //! Exports to fileName, compressed with gzip or zstd if its extension
+    //! is .gz or .zst. Compressed scenes need NEUROSCHEME_WITH_IOSTREAMS,
+    //! and zstd ones NEUROSCHEME_WITH_ZSTD
+    bool exportJSONFile( const std::string& fileName,
+      bool minimizeStream = false ) const;
+
+    //! Imports fileName, decompressing it while it is parsed if its
+    //! extension is .gz or .zst. Returns false if it cannot be read or
+    //! is not a valid scene
+    bool importJSONFile( const std::string& fileName,
+      const bool replaceGIDs = false,
+      const TProgressCallback& progressCallback = nullptr );
+
+    //! Saves the same content exportJSON does into a binary scene (.nsb)
+    virtual bool exportBinary( const std::string& fileName ) const;
+
+    //! Maps a binary scene and creates its entities, relationships and layout
+    //! through the same steps importJSON uses, without parsing text
+    virtual bool importBinary( const std::string& fileName,
+      const bool replaceGIDs = false,
+      const TProgressCallback& progressCallback = nullptr );
 
     virtual void createGUI( QMainWindow* /* mw */, QMenuBar* /* menubar */ )
     {
@@ -82,45 +162,46 @@ namespace nslib
     shift::RelationshipPropertiesTypes* _relationshipPropertiesTypes;
     std::string _domainName;
 
-    virtual void exportRelationTypeToJSON( const std::string& relationName,
-      std::ostream& outputStream, bool minimizeStream, bool aggregated ) const;
+    //! Fraction of the input imported given the bytes parsed, negative if
+    //! unknown
+    typedef std::function< float( size_t ) > TInputProgress;
 
-    virtual void importEntityJSON(
-      const boost::property_tree::ptree& entityJSON, shift::Entity*& entity,
-      bool& isRootEntity, unsigned int& entityGID, const bool replaceGIDs );
+    virtual bool importJSONStream( std::istream& inputStream,
+      const bool replaceGIDs, const TProgressCallback& progressCallback,
+      const TInputProgress& inputProgress );
 
-    virtual void importRelationshipsJSON(
-      const boost::property_tree::ptree& relationships,
-      std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity ) = 0;
+    //! Serializes the relations of relationName in parallel into buffers
+    virtual void exportRelationTypeToJSON( const std::string& relationName,
+      TJSONBuffers& buffers, bool minimizeStream, bool aggregated ) const;
+
+    virtual void importEntityJSON( const TEntityJSON& entityJSON,
+      GIDToEntity* oldGIDToEntity, const bool replaceGIDs );
 
-    virtual boost::property_tree::ptree& getRelationsOfType(
-      const std::string& relationName,
-      const  boost::property_tree::ptree& relationships );
+    //! Imports a batch of relations of relationType
+    virtual void importRelationsJSON( const std::string& relationType,
+      const boost::property_tree::ptree& relations,
+      GIDToEntity* oldGIDToEntity ) = 0;
 
     virtual void importJSONRelationGIDS(
       const boost::property_tree::ptree& relation,
-      std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity,
+      GIDToEntity* oldGIDToEntity,
       shift::Entity*& origEntity, shift::Entity*& destEntity,
       const std::string& relationName, bool checkConstrained );
 
     virtual void addConnectsToRelationsFromJSON(
       const boost::property_tree::ptree& relations,
-      std::unordered_map< unsigned int, shift::Entity* >* oldGIDToEntity );
+      GIDToEntity* oldGIDToEntity );
 
     virtual void addAggregatedConnectionFromJSON(
       const boost::property_tree::ptree& relations, const std::string& name,
-      std::unordered_map< unsigned int, shift::Entity* >* oldGIDToEntity );
+      GIDToEntity* oldGIDToEntity );
 
     virtual void addIsParentOfRelationshipsFromJSON(
       const boost::property_tree::ptree& relations,
-      std::unordered_map< unsigned int, shift::Entity* >* oldGIDToEntity );
+      GIDToEntity* oldGIDToEntity );
 
-    virtual void importEntititiesJSON(
-      const boost::property_tree::ptree& entities,
-      std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity,
-      const bool replaceGIDs );
-
-    virtual void exportEntitiesJSON( std::ostream& outputStream,
+    //! Serializes the entities in parallel into buffers
+    virtual void exportEntitiesJSON( TJSONBuffers& buffers,
       bool minimizeStream ) const;
 
     virtual void exportRepresentationMaxMin( std::ostream& /*outputStream*/,
@@ -129,9 +210,12 @@ namespace nslib
     virtual void importMaximumsJSON(
       const boost::property_tree::ptree& maximums ) = 0;
 
-    virtual void importLayoutJSON(
-      const boost::property_tree::ptree& layoutObject,
-      std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity );
+    virtual void importLayoutJSON( const TLayoutJSON& layout,
+      GIDToEntity* oldGIDToEntity );
+
+    //! Layout type, entities and, for the free layout, positions of the
+    //! active pane
+    virtual void sceneLayout( TLayoutJSON& layout ) const;
 
     virtual void exportLayoutJSON( std::ostream& outputStream,
       const bool minimizeStream ) const;
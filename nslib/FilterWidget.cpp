@@ -22,6 +22,7 @@
 #include "Canvas.h"
 #include "layouts/Layout.h"
 #include "FilterWidget.h"
+#include "PaneManager.h"
 #include <QGridLayout>
 #include <QToolButton>
 #include <algorithm>
@@ -155,6 +156,8 @@ namespace nslib
                                             spanSlider->upperPosition( ));
     _filterSetConfig.filters( ).push_back(
       std::make_pair( propertyLabel, filter ));
+    _filterRanges[ propertyLabel ] = std::make_pair(
+      spanSlider->lowerPosition( ), spanSlider->upperPosition( ));
 
     _layoutRowsMap[ propertyLabel ] = _numFilterProperties;
     ++_numFilterProperties;
@@ -205,6 +208,7 @@ namespace nslib
     _layoutRowsMap.clear( );
     _numFilterProperties = 0;
     _filterSetConfig.clear( );
+    _filterRanges.clear( );
     delete _removeSignalMapper;
     _removeSignalMapper = new QSignalMapper;
   }
@@ -224,6 +228,7 @@ namespace nslib
       return;
 
     filters.erase( it );
+    _filterRanges.erase( propertyLabel );
 
     auto qGridLayout = dynamic_cast< QGridLayout* >( this->layout( ));
 
@@ -275,6 +280,8 @@ namespace nslib
     fires::PropertyManager::setFilterRange( firesFilter,
                                             spanSlider->lowerPosition( ),
                                             spanSlider->upperPosition( ));
+    _filterRanges[ propertyLabel ] = std::make_pair(
+      spanSlider->lowerPosition( ), spanSlider->upperPosition( ));
 
     if ( _autoFilterCheckBox->isChecked( ))
     {
@@ -284,7 +291,8 @@ namespace nslib
 
   void FilterWidget::refreshParentLayout( void )
   {
-    _parentLayout->refresh( false );
+    PaneManager::requestRefresh( _parentLayout->_canvas,
+      PaneManager::REFRESH_DATA );
   }
 
   void FilterWidget::_autoFilterCheckBoxChanged( void )
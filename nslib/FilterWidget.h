@@ -49,6 +49,11 @@ namespace nslib
     fires::FilterSetConfig& filterSetConfig( void )
     { return _filterSetConfig; }
 
+    //! Span slider positions of each filtered property
+    const std::map< std::string, std::pair< int, int >>& filterRanges(
+      void ) const
+    { return _filterRanges; }
+
     bool useOpacityForFiltering( void )
     { return _useOpacityCheckBox->isChecked( ); }
     int opacityValue( void ) { return _opacitySlider->value( ); }
@@ -72,6 +77,7 @@ namespace nslib
     QSignalMapper* _removeSignalMapper;
     QSignalMapper* _changeSliderSignalMapper;
     std::map< std::string, unsigned int > _layoutRowsMap;
+    std::map< std::string, std::pair< int, int >> _filterRanges;
     QPushButton* _filterButton;
     QLabel* _autoFilterLabel;
     QCheckBox* _autoFilterCheckBox;
@@ -1062,6 +1062,7 @@ namespace nslib
     auto& dataEntities = DataManager::entities( );
     auto relations = dataEntities.relationships( );
     auto entity = dataEntities.at( entityGid_ );
+    SelectionManager::clearSelectableEntitiesIndex( );
     if( entity->isSubEntity( ))
     {
       Loggers::get( )->log( "Deleting a subEntity",
@@ -1115,10 +1116,7 @@ namespace nslib
       }
       //Updated if it's an aggregated
       updateConnectionRelationship( nullptr, nullptr );
-      for ( auto pane : PaneManager::panes( ))
-      {
-        pane->resizeEvent( nullptr );
-      }
+      PaneManager::requestRefresh( PaneManager::REFRESH_DATA );
     }
   }
 
@@ -1196,6 +1194,7 @@ namespace nslib
       }
     }
 
+    SelectionManager::forgetEntity( entity_ );
     dataEntities_.remove( entity_ );
     if( _entityEditWidget && !_entityEditWidget->isHidden( )
         && _entityEditWidget->entity( ) == entity_ )
@@ -1344,4 +1343,16 @@ namespace nslib
     }
   }
 
+  void InteractionManager::forgetItem( QGraphicsItem* item_ )
+  {
+    const auto isItemOrChild = [ item_ ]( QGraphicsItem* other )
+    {
+      return other && ( other == item_ || item_->isAncestorOf( other ));
+    };
+    if ( isItemOrChild( lastShapeItemHoveredOnMouseMove ))
+      lastShapeItemHoveredOnMouseMove = nullptr;
+    if ( isItemOrChild( _item ))
+      _item = nullptr;
+  }
+
 } // namespace nslib
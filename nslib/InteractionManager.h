@@ -118,6 +118,10 @@ namespace nslib
 
     static void updateEntityParents( shift::Entity* entity_ );
 
+    //! Drops any reference kept to item or its children, to be called when
+    //! the item leaves the scene
+    static void forgetItem( QGraphicsItem* item_ );
+
     protected:
     enum HiglightRelationPair
     { HLC_RELATIONSHIP = 0,
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#include "JSONReader.h"
+#include <cstring>
+
+namespace nslib
+{
+  JSONReader::JSONReader( std::istream& stream, size_t bufferSize )
+    : _stream( stream )
+    , _buffer( bufferSize )
+    , _position( 0 )
+    , _size( 0 )
+    , _consumed( 0 )
+    , _expectKey( false )
+    , _afterValue( false )
+  {
+  }
+
+  bool JSONReader::_fill( void )
+  {
+    _consumed += _size;
+    _position = 0;
+    _size = 0;
+    if ( !_stream )
+      return false;
+    _stream.read( _buffer.data( ), std::streamsize( _buffer.size( )));
+    _size = size_t( _stream.gcount( ));
+    return _size > 0;
+  }
+
+  int JSONReader::_peek( void )
+  {
+    if ( _position == _size && !_fill( ))
+      return -1;
+    return ( unsigned char ) _buffer[ _position ];
+  }
+
+  bool JSONReader::_skipWhitespace( void )
+  {
+    while ( true )
+    {
+      const int c = _peek( );
+      if ( c == ' ' || c == '\n' || c == '\r' || c == '\t' )
+        ++_position;
+      else
+        return c != -1;
+    }
+  }
+
+  JSONReader::TToken JSONReader::_fail( const std::string& message )
+  {
+    if ( _error.empty( ))
+      _error = message + " at byte " + std::to_string( bytesRead( ));
+    return JSON_ERROR;
+  }
+
+  void JSONReader::_valueDone( void )
+  {
+    _afterValue = true;
+    _expectKey = !_containers.empty( ) && _containers.back( ) == '{';
+  }
+
+  static void appendUTF8( std::string& string, unsigned int codePoint )
+  {
+    if ( codePoint < 0x80 )
+      string.push_back( char( codePoint ));
+    else if ( codePoint < 0x800 )
+    {
+      string.push_back( char( 0xC0 | ( codePoint >> 6 )));
+      string.push_back( char( 0x80 | ( codePoint & 0x3F )));
+    }
+    else if ( codePoint < 0x10000 )
+    {
+      string.push_back( char( 0xE0 | ( codePoint >> 12 )));
+      string.push_back( char( 0x80 | (( codePoint >> 6 ) & 0x3F )));
+      string.push_back( char( 0x80 | ( codePoint & 0x3F )));
+    }
+    else
+    {
+      string.push_back( char( 0xF0 | ( codePoint >> 18 )));
+      string.push_back( char( 0x80 | (( codePoint >> 12 ) & 0x3F )));
+      string.push_back( char( 0x80 | (( codePoint >> 6 ) & 0x3F )));
+      string.push_back( char( 0x80 | ( codePoint & 0x3F )));
+    }
+  }
+
+  bool JSONReader::_readString( void )
+  {
+    // Opening quote
+    ++_position;
+    _value.clear( );
+
+    const auto readHex = [ this ]( unsigned int& code )
+    {
+      code = 0;
+      for ( int i = 0; i < 4; ++i )
+      {
+        const int c = _peek( );
+        ++_position;
+        code <<= 4;
+        if ( c >= '0' && c <= '9' )
+          code |= c - '0';
+        else if ( c >= 'a' && c <= 'f' )
+          code |= c - 'a' + 10;
+        else if ( c >= 'A' && c <= 'F' )
+          code |= c - 'A' + 10;
+        else
+          return false;
+      }
+      return true;
+    };
+
+    while ( true )
+    {
+      if ( _position == _size && !_fill( ))
+        return false;
+
+      // Copy the run of plain characters at once
+      const char* begin = _buffer.data( ) + _position;
+      const char* end = _buffer.data( ) + _size;
+      const char* it = begin;
+      while ( it != end && *it != '"' && *it != '\\' )
+        ++it;
+      _value.append( begin, it );
+      _position += it - begin;
+      if ( it == end )
+        continue;
+
+      ++_position;
+      if ( *it == '"' )
+        return true;
+
+      const int escaped = _peek( );
+      ++_position;
+      switch ( escaped )
+      {
+        case '"': _value.push_back( '"' ); break;
+        case '\\': _value.push_back( '\\' ); break;
+        case '/': _value.push_back( '/' ); break;
+        case 'b': _value.push_back( '\b' ); break;
+        case 'f': _value.push_back( '\f' ); break;
+        case 'n': _value.push_back( '\n' ); break;
+        case 'r': _value.push_back( '\r' ); break;
+        case 't': _value.push_back( '\t' ); break;
+        case 'u':
+        {
+          unsigned int code;
+          if ( !readHex( code ))
+            return false;
+          // Surrogate pairs
+          if ( code >= 0xD800 && code < 0xDC00 )
+          {
+            unsigned int low;
+            if ( _peek( ) != '\\' )
+              return false;
+            ++_position;
+            if ( _peek( ) != 'u' )
+              return false;
+            ++_position;
+            if ( !readHex( low ) || low < 0xDC00 || low >= 0xE000 )
+              return false;
+            code = 0x10000 + (( code - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+          }
+          appendUTF8( _value, code );
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+  }
+
+  void JSONReader::_readNumber( void )
+  {
+    _value.clear( );
+    while ( true )
+    {
+      const int c = _peek( );
+      if (( c >= '0' && c <= '9' ) || c == '-' || c == '+' || c == '.' ||
+          c == 'e' || c == 'E' )
+      {
+        _value.push_back( char( c ));
+        ++_position;
+      }
+      else
+        return;
+    }
+  }
+
+  bool JSONReader::_readLiteral( const char* literal )
+  {
+    for ( ; *literal; ++literal, ++_position )
+      if ( _peek( ) != *literal )
+        return false;
+    return true;
+  }
+
+  JSONReader::TToken JSONReader::next( void )
+  {
+    if ( !_error.empty( ))
+      return JSON_ERROR;
+
+    if ( !_skipWhitespace( ))
+    {
+      if ( _containers.empty( ) && _afterValue )
+        return JSON_END;
+      return _fail( "Unexpected end of JSON" );
+    }
+
+    int c = _peek( );
+    if ( c == ',' )
+    {
+      if ( !_afterValue || _containers.empty( ))
+        return _fail( "Unexpected ','" );
+      ++_position;
+      _afterValue = false;
+      if ( !_skipWhitespace( ))
+        return _fail( "Unexpected end of JSON" );
+      c = _peek( );
+      if ( c == '}' || c == ']' )
+        return _fail( "Unexpected trailing ','" );
+    }
+    else if ( _afterValue && c != '}' && c != ']' )
+    {
+      return _fail( _containers.empty( ) ? "Unexpected data after JSON" :
+                    "Expected ','" );
+    }
+
+    if ( c == '}' || c == ']' )
+    {
+      if ( _containers.empty( ) || ( _containers.back( ) == '{' ) != ( c == '}' ))
+        return _fail( std::string( "Unexpected '" ) + char( c ) + "'" );
+      ++_position;
+      _containers.pop_back( );
+      _valueDone( );
+      return c == '}' ? JSON_END_OBJECT : JSON_END_ARRAY;
+    }
+
+    if ( _expectKey )
+    {
+      if ( c != '"' || !_readString( ))
+        return _fail( "Expected key string" );
+      if ( !_skipWhitespace( ) || _peek( ) != ':' )
+        return _fail( "Expected ':'" );
+      ++_position;
+      _expectKey = false;
+      return JSON_KEY;
+    }
+
+    _afterValue = false;
+    switch ( c )
+    {
+      case '{':
+        ++_position;
+        _containers.push_back( '{' );
+        _expectKey = true;
+        return JSON_BEGIN_OBJECT;
+      case '[':
+        ++_position;
+        _containers.push_back( '[' );
+        return JSON_BEGIN_ARRAY;
+      case '"':
+        if ( !_readString( ))
+          return _fail( "Invalid string" );
+        _valueDone( );
+        return JSON_STRING;
+      case 't':
+        if ( !_readLiteral( "true" ))
+          return _fail( "Invalid literal" );
+        _valueDone( );
+        return JSON_TRUE;
+      case 'f':
+        if ( !_readLiteral( "false" ))
+          return _fail( "Invalid literal" );
+        _valueDone( );
+        return JSON_FALSE;
+      case 'n':
+        if ( !_readLiteral( "null" ))
+          return _fail( "Invalid literal" );
+        _valueDone( );
+        return JSON_NULL;
+      default:
+        if ( c == '-' || ( c >= '0' && c <= '9' ))
+        {
+          _readNumber( );
+          _valueDone( );
+          return JSON_NUMBER;
+        }
+        return _fail( std::string( "Unexpected '" ) + char( c ) + "'" );
+    }
+  }
+
+  bool JSONReader::readValue( boost::property_tree::ptree& tree )
+  {
+    return readValue( next( ), tree );
+  }
+
+  bool JSONReader::readValue( TToken token, boost::property_tree::ptree& tree )
+  {
+    switch ( token )
+    {
+      case JSON_BEGIN_OBJECT:
+        while ( true )
+        {
+          token = next( );
+          if ( token == JSON_END_OBJECT )
+            return true;
+          if ( token != JSON_KEY )
+            return false;
+          auto& child = tree.push_back(
+            std::make_pair( _value, boost::property_tree::ptree( )))->second;
+          if ( !readValue( child ))
+            return false;
+        }
+      case JSON_BEGIN_ARRAY:
+        while ( true )
+        {
+          token = next( );
+          if ( token == JSON_END_ARRAY )
+            return true;
+          auto& child = tree.push_back(
+            std::make_pair( std::string( ), boost::property_tree::ptree( )))->second;
+          if ( !readValue( token, child ))
+            return false;
+        }
+      case JSON_STRING:
+      case JSON_NUMBER:
+        tree.data( ) = _value;
+        return true;
+      case JSON_TRUE:
+        tree.data( ) = "true";
+        return true;
+      case JSON_FALSE:
+        tree.data( ) = "false";
+        return true;
+      case JSON_NULL:
+        tree.data( ) = "null";
+        return true;
+      default:
+        _fail( "Unexpected token" );
+        return false;
+    }
+  }
+
+  bool JSONReader::skipValue( void )
+  {
+    return skipValue( next( ));
+  }
+
+  bool JSONReader::skipValue( TToken token )
+  {
+    if ( token != JSON_BEGIN_OBJECT && token != JSON_BEGIN_ARRAY )
+      return token != JSON_ERROR && token != JSON_END &&
+        token != JSON_END_OBJECT && token != JSON_END_ARRAY &&
+        token != JSON_KEY;
+
+    const auto depth = _containers.size( );
+    while ( _containers.size( ) >= depth )
+    {
+      token = next( );
+      if ( token == JSON_ERROR || token == JSON_END )
+        return false;
+    }
+    return true;
+  }
+}
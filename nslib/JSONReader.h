@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef __NSLIB_JSON_READER__
+#define __NSLIB_JSON_READER__
+
+#include <nslib/api.h>
+#include <boost/property_tree/ptree.hpp>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace nslib
+{
+  //! Pull parser reading JSON tokens from a stream through a fixed size
+  //! buffer, so documents are never held in memory as a whole. Values can
+  //! also be read into a ptree with the same layout read_json would produce.
+  class NSLIB_API JSONReader
+  {
+  public:
+    typedef enum
+    {
+      JSON_BEGIN_OBJECT,
+      JSON_END_OBJECT,
+      JSON_BEGIN_ARRAY,
+      JSON_END_ARRAY,
+      JSON_KEY,
+      JSON_STRING,
+      JSON_NUMBER,
+      JSON_TRUE,
+      JSON_FALSE,
+      JSON_NULL,
+      JSON_END,
+      JSON_ERROR
+    } TToken;
+
+    JSONReader( std::istream& stream, size_t bufferSize = 1 << 20 );
+
+    //! Reads the next token. Text of keys, strings and numbers is
+    //! available through value( )
+    TToken next( void );
+    const std::string& value( void ) const { return _value; }
+
+    //! Reads the value starting at the next token into tree
+    bool readValue( boost::property_tree::ptree& tree );
+    //! Same as readValue but for a value whose first token was already read
+    bool readValue( TToken token, boost::property_tree::ptree& tree );
+    //! Skips the value starting at the next token
+    bool skipValue( void );
+    bool skipValue( TToken token );
+
+    //! Bytes of the stream consumed so far
+    size_t bytesRead( void ) const { return _consumed + _position; }
+    const std::string& error( void ) const { return _error; }
+
+  protected:
+    int _peek( void );
+    bool _fill( void );
+    bool _skipWhitespace( void );
+    bool _readString( void );
+    void _readNumber( void );
+    bool _readLiteral( const char* literal );
+    TToken _fail( const std::string& message );
+    void _valueDone( void );
+
+    std::istream& _stream;
+    std::vector< char > _buffer;
+    size_t _position;
+    size_t _size;
+    size_t _consumed;
+
+    //! Open containers, '{' or '['
+    std::vector< char > _containers;
+    bool _expectKey;
+    bool _afterValue;
+    std::string _value;
+    std::string _error;
+  };
+}
+
+#endif
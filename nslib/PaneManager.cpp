@@ -22,10 +22,12 @@
 #include "DataManager.h"
 #include "PaneManager.h"
 #include "Loggers.h"
+#include "SelectionManager.h"
 #include <assert.h>
 #include <QLabel>
 #include <QPushButton>
 #include <QComboBox>
+#include <QTimer>
 
 namespace nslib
 {
@@ -40,8 +42,12 @@ namespace nslib
   //unsigned int PaneManager::_nextColumn = 0;
   Eigen::Matrix4f PaneManager::_modelViewMatrix =
     Eigen::Matrix4f::Identity( );
-  std::chrono::time_point< std::chrono::system_clock >
-  PaneManager::lastMatrixClock = std::chrono::system_clock::now( );
+  std::map< Canvas*, unsigned int > PaneManager::_pendingRefreshes =
+    std::map< Canvas*, unsigned int >( );
+  bool PaneManager::_refreshScheduled = false;
+
+  // Refreshes requested within this time are served together
+  static const int REFRESH_FRAME_MS = 16;
   PaneManager::TPaneDivision PaneManager::_paneDivision =
     PaneManager::VERTICAL;
 
@@ -200,6 +206,7 @@ namespace nslib
       grandParentSplitter->insertWidget( indexOfParentSplitter, sibling );
       auto paneIt = std::find( _panes.begin( ), _panes.end( ), orig );
       _panes.erase( paneIt );
+      _pendingRefreshes.erase( orig );
       delete orig;
       delete parentSplitter;
 
@@ -209,11 +216,7 @@ namespace nslib
 
   void PaneManager::updateSelection( void )
   {
-    auto updateCanvasSelection = [](Canvas *c)
-    {
-      c->layouts( ).getLayout(c->activeLayoutIndex( ))->updateSelection( );
-    };
-    std::for_each(_panes.begin(), _panes.end(), updateCanvasSelection);
+    requestRefresh( REFRESH_SELECTION );
   }
 
   void PaneManager::killActivePane( void )
@@ -232,21 +235,65 @@ namespace nslib
     _modelViewMatrix.row( 3 ) =
       Vector4f( values[3], values[7], values[11], values[15] );
 
-    const int elapsedMs = std::chrono::duration_cast< std::chrono::milliseconds >
-      ( std::chrono::system_clock::now( ) - lastMatrixClock ).count( );
+    requestRefresh( REFRESH_CAMERA );
+  }
+
+  void PaneManager::requestRefresh( Canvas* pane, unsigned int reasons )
+  {
+    if ( !pane )
+      return;
 
-    // Only update if 50ms passed
-    if ( elapsedMs > 50 )
+    _pendingRefreshes[ pane ] |= reasons;
+    if ( !_refreshScheduled )
     {
-      auto refreshPane = [](Canvas *c)
-      {
-        auto l = c->layouts( ).getLayout( c->activeLayoutIndex( ));
-        if ( l->flags( ) & Layout::CAMERA_ENABLED )
-          l->refresh( false );
-      };
-      std::for_each(_panes.begin(), _panes.end(), refreshPane);
+      _refreshScheduled = true;
+      QTimer::singleShot( REFRESH_FRAME_MS, &PaneManager::flushRefreshes );
+    }
+  }
 
-      lastMatrixClock = std::chrono::system_clock::now( );
+  void PaneManager::requestRefresh( unsigned int reasons )
+  {
+    for ( auto pane : _panes )
+      requestRefresh( pane, reasons );
+  }
+
+  void PaneManager::flushRefreshes( void )
+  {
+    _refreshScheduled = false;
+
+    // Refreshing may request new refreshes, those go to the next frame
+    std::map< Canvas*, unsigned int > pendingRefreshes;
+    pendingRefreshes.swap( _pendingRefreshes );
+    std::vector< shift::Entity* > changedEntities;
+    SelectionManager::takeChangedEntities( changedEntities );
+    // Selection changes are shown in every pane, whoever requested them
+    if ( !changedEntities.empty( ))
+    {
+      for ( auto pane : _panes )
+        pendingRefreshes[ pane ] |= REFRESH_SELECTION;
+    }
+
+    for ( const auto& pending : pendingRefreshes )
+    {
+      auto pane = pending.first;
+      const unsigned int reasons = pending.second;
+      if ( _panes.count( pane ) == 0 )
+        continue;
+      auto layout_ = pane->layouts( ).getLayout( pane->activeLayoutIndex( ));
+      if ( !layout_ )
+        continue;
+
+      // A full display also updates camera placement and selection pens
+      if ( reasons & ( REFRESH_DATA | REFRESH_RESIZE ))
+        pane->displayEntities( false, false );
+      else
+      {
+        if (( reasons & REFRESH_CAMERA ) &&
+            ( layout_->flags( ) & Layout::CAMERA_ENABLED ))
+          layout_->refresh( false );
+        else if ( reasons & REFRESH_SELECTION )
+          layout_->updateSelection( changedEntities );
+      }
     }
   }
 
@@ -25,10 +25,10 @@
 #include <nslib/api.h>
 #include "Canvas.h"
 #include <set>
+#include <map>
 #include <QGridLayout>
 #include <QSplitter>
 #include <Eigen/Dense>
-#include <chrono>
 
 namespace nslib
 {
@@ -57,6 +57,24 @@ namespace nslib
 
     static void setViewMatrix( const double* values );
 
+    //! Reasons to refresh a pane. Reasons requested for the same pane before
+    //! the next frame are merged and served with the cheapest action
+    //! covering all of them.
+    typedef enum
+    {
+      REFRESH_SELECTION = 0x01,
+      REFRESH_CAMERA = 0x02,
+      REFRESH_RESIZE = 0x04,
+      REFRESH_DATA = 0x08
+    } TRefreshReason;
+
+    //! Marks a pane dirty, it will be refreshed at most once per frame
+    static void requestRefresh( Canvas* pane, unsigned int reasons );
+    //! Marks every pane dirty
+    static void requestRefresh( unsigned int reasons );
+    //! Runs the pending refreshes right away
+    static void flushRefreshes( void );
+
     using Matrix4f = Eigen::Matrix4f;
     static const Matrix4f& viewMatrix( void ) { return _modelViewMatrix; }
 
@@ -74,7 +92,8 @@ namespace nslib
     //static unsigned int _nextRow, _nextColumn;
 
     static Matrix4f _modelViewMatrix;
-    static std::chrono::time_point< std::chrono::system_clock > lastMatrixClock;
+    static std::map< Canvas*, unsigned int > _pendingRefreshes;
+    static bool _refreshScheduled;
     static TPaneDivision _paneDivision;
   };
 } // namespace nslib
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef __NSLIB_PARALLEL_FOR__
+#define __NSLIB_PARALLEL_FOR__
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace nslib
+{
+  //! Function run for the elements [ begin, end ) of the given chunk
+  typedef std::function< void( size_t begin, size_t end,
+                               unsigned int chunk ) > TChunkFunction;
+
+  //! Number of chunks parallelFor will use for size elements, so callers can
+  //! allocate per chunk results beforehand
+  inline unsigned int parallelChunks( size_t size, size_t minChunkSize = 1024 )
+  {
+    const size_t maxChunks = std::max( 1, QThreadPool::globalInstance( )->
+                                          maxThreadCount( ));
+    const size_t chunks = ( size + minChunkSize - 1 ) / minChunkSize;
+    return static_cast< unsigned int >(
+      std::max( size_t( 1 ), std::min( chunks, maxChunks )));
+  }
+
+  class ChunkRunnable : public QRunnable
+  {
+  public:
+    ChunkRunnable( const TChunkFunction& function_, size_t begin_,
+                   size_t end_, unsigned int chunk_, QSemaphore& done_ )
+      : _function( function_ )
+      , _begin( begin_ )
+      , _end( end_ )
+      , _chunk( chunk_ )
+      , _done( done_ )
+    {
+      setAutoDelete( true );
+    }
+
+    void run( void ) override
+    {
+      _function( _begin, _end, _chunk );
+      _done.release( );
+    }
+
+  protected:
+    const TChunkFunction& _function;
+    size_t _begin;
+    size_t _end;
+    unsigned int _chunk;
+    QSemaphore& _done;
+  };
+
+  //! Splits [ 0, size ) in numChunks contiguous chunks, runs them in the
+  //! global Qt thread pool and the calling thread and waits for all of them
+  inline void parallelFor( size_t size, unsigned int numChunks,
+                           const TChunkFunction& function )
+  {
+    if ( size == 0 )
+      return;
+    if ( numChunks <= 1 )
+    {
+      function( 0, size, 0 );
+      return;
+    }
+
+    const size_t chunkSize = ( size + numChunks - 1 ) / numChunks;
+    QSemaphore done;
+    unsigned int numQueued = 0;
+    for ( unsigned int chunk = 1; chunk < numChunks; ++chunk )
+    {
+      const size_t begin = chunk * chunkSize;
+      if ( begin >= size )
+        break;
+      QThreadPool::globalInstance( )->start( new ChunkRunnable(
+        function, begin, std::min( size, begin + chunkSize ), chunk, done ));
+      ++numQueued;
+    }
+    function( 0, std::min( size, chunkSize ), 0 );
+    done.acquire( numQueued );
+  }
+
+  //! Sorts the chunks parallelFor would use in parallel and then merges
+  //! pairs of sorted runs, each round of merges in parallel
+  template < typename T >
+  inline void parallelSort( std::vector< T >& values,
+                            size_t minChunkSize = 1 << 16 )
+  {
+    const size_t size = values.size( );
+    const unsigned int numChunks = parallelChunks( size, minChunkSize );
+    parallelFor( size, numChunks,
+      [ &values ]( size_t begin, size_t end, unsigned int )
+      {
+        std::sort( values.begin( ) + begin, values.begin( ) + end );
+      });
+    if ( numChunks <= 1 )
+      return;
+
+    for ( size_t runSize = ( size + numChunks - 1 ) / numChunks;
+          runSize < size; runSize *= 2 )
+    {
+      const size_t numMerges = ( size + 2 * runSize - 1 ) / ( 2 * runSize );
+      parallelFor( numMerges, parallelChunks( numMerges, 1 ),
+        [ &values, size, runSize ]( size_t begin, size_t end, unsigned int )
+        {
+          for ( size_t merge = begin; merge < end; ++merge )
+          {
+            const size_t first = merge * 2 * runSize;
+            const size_t middle = std::min( size, first + runSize );
+            const size_t last = std::min( size, first + 2 * runSize );
+            std::inplace_merge( values.begin( ) + first,
+                                values.begin( ) + middle,
+                                values.begin( ) + last );
+          }
+        });
+    }
+  }
+}
+
+#endif
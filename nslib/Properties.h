@@ -22,6 +22,9 @@
 #ifndef __NSLIB_PROPERTIES__
 #define __NSLIB_PROPERTIES__
 
+#include <map>
+#include <string>
+
 namespace nslib
 {
 
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#include "PropertyColumns.h"
+#include <fires/fires.h>
+#include "ParallelFor.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace nslib
+{
+  namespace
+  {
+    //! Types of the values stored in fires properties which are read as
+    //! they are. Any other is read through its caster
+    typedef enum
+    {
+      VALUE_FLOAT,
+      VALUE_DOUBLE,
+      VALUE_INT,
+      VALUE_UNSIGNED_INT,
+      VALUE_CASTER
+    } TValueType;
+
+    template < typename T >
+    bool holds( const fires::Property& property )
+    {
+      try
+      {
+        property.value< T >( );
+        return true;
+      }
+      catch ( ... )
+      {
+        return false;
+      }
+    }
+
+    TValueType valueType( const fires::Property& property )
+    {
+      if ( holds< float >( property ))
+        return VALUE_FLOAT;
+      if ( holds< double >( property ))
+        return VALUE_DOUBLE;
+      if ( holds< int >( property ))
+        return VALUE_INT;
+      if ( holds< unsigned int >( property ))
+        return VALUE_UNSIGNED_INT;
+      return VALUE_CASTER;
+    }
+
+    float floatValue( const fires::Property& property, TValueType type,
+                      fires::PropertyCaster* caster )
+    {
+      switch ( type )
+      {
+        case VALUE_FLOAT:
+          return property.value< float >( );
+        case VALUE_DOUBLE:
+          return float( property.value< double >( ));
+        case VALUE_INT:
+          return float( property.value< int >( ));
+        case VALUE_UNSIGNED_INT:
+          return float( property.value< unsigned int >( ));
+        default:
+          return float( caster->toInt( property ));
+      }
+    }
+
+    //! Reads property as an int through its caster and as a float, trying
+    //! type first and updating it if the property stores another one.
+    //! Returns false without throwing if the property cannot be read
+    bool readValue( const fires::Property& property,
+                    fires::PropertyCaster* caster, TValueType& type,
+                    int& intValue, float& floatValue_ )
+    {
+      try
+      {
+        intValue = caster->toInt( property );
+        try
+        {
+          floatValue_ = floatValue( property, type, caster );
+        }
+        catch ( ... )
+        {
+          type = valueType( property );
+          floatValue_ = floatValue( property, type, caster );
+        }
+        return true;
+      }
+      catch ( ... )
+      {
+        return false;
+      }
+    }
+
+    //! Integer bound of value, clamped to the int range
+    int clampToInt( double value )
+    {
+      if ( value <= double( INT_MIN ))
+        return INT_MIN;
+      if ( value >= double( INT_MAX ))
+        return INT_MAX;
+      return int( value );
+    }
+  }
+
+  PropertyColumns::PropertyColumns( void )
+    : _version( 0 )
+    , _valid( false )
+  {
+  }
+
+  void PropertyColumns::build( const std::vector< shift::Entity* >& entities,
+                               unsigned int version )
+  {
+    _entities = entities;
+    _columns.clear( );
+    _ranges.clear( );
+
+    const size_t numEntities = _entities.size( );
+    const unsigned int numChunks = parallelChunks( numEntities );
+
+    // Labels of the aggregatable properties, gathered per chunk
+    std::vector< std::set< std::string >> chunkLabels( numChunks );
+    parallelFor( numEntities, numChunks,
+      [ this, &chunkLabels ]( size_t begin, size_t end, unsigned int chunk )
+      {
+        auto& labels = chunkLabels[ chunk ];
+        for ( size_t i = begin; i < end; ++i )
+          for ( const auto& propertyGid_ : _entities[ i ]->properties( ))
+            if ( fires::PropertyManager::getAggregator( propertyGid_.first ))
+              labels.insert( fires::PropertyGIDsManager::getPropertyLabel(
+                propertyGid_.first ));
+      });
+
+    std::vector< std::string > labels;
+    std::vector< TColumn* > columns;
+    std::vector< fires::PropertyCaster* > casters;
+    for ( const auto& chunkLabels_ : chunkLabels )
+      for ( const auto& label : chunkLabels_ )
+      {
+        if ( _columns.count( label ) == 1 )
+          continue;
+        auto caster = fires::PropertyManager::getPropertyCaster( label );
+        if ( !caster )
+          continue;
+        auto& column = _columns[ label ];
+        column.values.resize( numEntities, 0 );
+        column.floats.resize( numEntities,
+                              std::numeric_limits< float >::quiet_NaN( ));
+        labels.push_back( label );
+        columns.push_back( &column );
+        casters.push_back( caster );
+      }
+
+    // Values are cast and reduced to min/max in the same pass, each chunk
+    // writing its own rows and ranges. The stored type is checked for each
+    // property, starting with the last one found in the chunk, and nothing
+    // in the workers may throw
+    std::vector< std::vector< TPropertyData >> chunkRanges(
+      numChunks, std::vector< TPropertyData >(
+        columns.size( ), TPropertyData{ INT_MAX, INT_MIN }));
+    parallelFor( numEntities, numChunks,
+      [ &, this ]( size_t begin, size_t end, unsigned int chunk )
+      {
+        auto& ranges = chunkRanges[ chunk ];
+        std::vector< TValueType > types( columns.size( ), VALUE_FLOAT );
+        for ( size_t i = begin; i < end; ++i )
+        {
+          const auto entity = _entities[ i ];
+          for ( size_t c = 0; c < columns.size( ); ++c )
+          {
+            if ( !entity->hasProperty( labels[ c ] ))
+              continue;
+            const auto& property = entity->getProperty( labels[ c ] );
+            auto& column = *columns[ c ];
+            int intValue;
+            float value;
+            if ( !readValue( property, casters[ c ], types[ c ],
+                             intValue, value ))
+              continue;
+            column.values[ i ] = intValue;
+            column.floats[ i ] = value;
+            if ( std::isnan( value ))
+              continue;
+            ranges[ c ].rangeMin = std::min( ranges[ c ].rangeMin,
+                                             clampToInt( std::floor( value )));
+            ranges[ c ].rangeMax = std::max( ranges[ c ].rangeMax,
+                                             clampToInt( std::ceil( value )));
+          }
+        }
+      });
+
+    for ( size_t c = 0; c < columns.size( ); ++c )
+    {
+      TPropertyData range{ INT_MAX, INT_MIN };
+      for ( const auto& ranges : chunkRanges )
+      {
+        range.rangeMin = std::min( range.rangeMin, ranges[ c ].rangeMin );
+        range.rangeMax = std::max( range.rangeMax, ranges[ c ].rangeMax );
+      }
+      _ranges[ labels[ c ]] = range;
+    }
+
+    _indices.clear( );
+    _indices.reserve( numEntities );
+    for ( size_t i = 0; i < numEntities; ++i )
+      _indices[ _entities[ i ]] = static_cast< unsigned int >( i );
+
+    _version = version;
+    _valid = true;
+  }
+
+  int PropertyColumns::index( const shift::Entity* entity ) const
+  {
+    const auto indexIt = _indices.find( entity );
+    return indexIt == _indices.end( ) ? -1 : int( indexIt->second );
+  }
+
+  const PropertyColumns::TColumn* PropertyColumns::column(
+    const std::string& label ) const
+  {
+    const auto columnIt = _columns.find( label );
+    return columnIt == _columns.end( ) ? nullptr : &columnIt->second;
+  }
+
+  bool PropertyColumns::filter( const std::string& label,
+                                int rangeMin, int rangeMax,
+                                std::vector< bool >& passes ) const
+  {
+    const auto column_ = column( label );
+    if ( !column_ || passes.size( ) != _entities.size( ))
+      return false;
+
+    // Inclusive on both ends, entities without the property (NaN) fail
+    const float min = float( rangeMin );
+    const float max = float( rangeMax );
+    const auto& floats = column_->floats;
+    for ( unsigned int i = 0; i < floats.size( ); ++i )
+      passes[ i ] = passes[ i ] && floats[ i ] >= min && floats[ i ] <= max;
+    return true;
+  }
+}
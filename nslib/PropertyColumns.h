@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef __NSLIB_PROPERTY_COLUMNS__
+#define __NSLIB_PROPERTY_COLUMNS__
+
+#include <nslib/api.h>
+#include <shift/shift.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Properties.h"
+
+namespace nslib
+{
+  //! Columnar cache of the aggregatable properties of a set of entities.
+  //! Each property is stored as contiguous arrays indexed by the
+  //! position of the entity in the cache, so ranges, filters and scatter
+  //! positions are computed with tight loops instead of one fires lookup
+  //! per entity. Columns are filled and reduced in parallel by the Qt global
+  //! thread pool.
+  class NSLIB_API PropertyColumns
+  {
+  public:
+    typedef struct
+    {
+      //! Value as returned by the property caster default rounding
+      std::vector< int > values;
+      //! Value as stored in the property, NaN for entities without it
+      std::vector< float > floats;
+    } TColumn;
+
+    PropertyColumns( void );
+
+    void build( const std::vector< shift::Entity* >& entities,
+                unsigned int version );
+    void invalidate( void ) { _valid = false; }
+    bool valid( unsigned int version ) const
+    { return _valid && _version == version; }
+
+    unsigned int size( void ) const
+    { return static_cast< unsigned int >( _entities.size( )); }
+    const std::vector< shift::Entity* >& entities( void ) const
+    { return _entities; }
+
+    //! Position of the entity in the cache or -1 if not cached
+    int index( const shift::Entity* entity ) const;
+
+    //! Column of a property or nullptr if no entity has it
+    const TColumn* column( const std::string& label ) const;
+
+    //! Floor of the minimum and ceil of the maximum of each property,
+    //! reduced while building the columns
+    const TProperties& ranges( void ) const { return _ranges; }
+
+    //! Clears the positions whose value is out of [ rangeMin, rangeMax ],
+    //! comparing the stored values as fires range filters do
+    bool filter( const std::string& label, int rangeMin, int rangeMax,
+                 std::vector< bool >& passes ) const;
+
+  protected:
+    std::vector< shift::Entity* > _entities;
+    std::unordered_map< const shift::Entity*, unsigned int > _indices;
+    std::map< std::string, TColumn > _columns;
+    TProperties _ranges;
+    unsigned int _version;
+    bool _valid;
+  };
+}
+
+#endif
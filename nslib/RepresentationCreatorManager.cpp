@@ -231,6 +231,11 @@ namespace nslib
     const unsigned int repCreatorId,
     const bool freeLayoutInUse_ )
   {
+    // Cached property values and projected positions of the edited
+    // entities are no longer valid
+    for ( auto canvas : PaneManager::panes( ))
+      canvas->entitiesUpdated( );
+
     bool representationUpdated = false;
     auto creator = RepresentationCreatorManager::getCreator( repCreatorId );
     for (const auto updatedEntity : updatedEntities_.vector( ))
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#include "SceneFile.h"
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#ifdef NEUROSCHEME_WITH_ZSTD
+#include <boost/iostreams/filter/zstd.hpp>
+#endif
+#include <fstream>
+
+// Compressed bytes read from or written to the file at once
+#define SCENE_FILE_BUFFER_SIZE ( 1 << 16 )
+
+namespace nslib
+{
+  namespace
+  {
+    bool endsWith( const std::string& str, const std::string& suffix )
+    {
+      return str.size( ) >= suffix.size( ) &&
+        str.compare( str.size( ) - suffix.size( ), suffix.size( ),
+                     suffix ) == 0;
+    }
+
+    //! Counts the bytes read from the source below it
+    class ByteCounter
+    {
+    public:
+      typedef char char_type;
+      typedef boost::iostreams::multichar_input_filter_tag category;
+
+      ByteCounter( uint64_t& count ) : _count( &count ) {}
+
+      template < typename Source >
+      std::streamsize read( Source& source, char* data, std::streamsize size )
+      {
+        const auto read_ = boost::iostreams::read( source, data, size );
+        if ( read_ > 0 )
+          *_count += uint64_t( read_ );
+        return read_;
+      }
+
+    protected:
+      uint64_t* _count;
+    };
+  }
+
+  TSceneCompression sceneCompression( const std::string& fileName )
+  {
+    if ( endsWith( fileName, ".gz" ))
+      return SCENE_GZIP;
+    if ( endsWith( fileName, ".zst" ))
+      return SCENE_ZSTD;
+    return SCENE_UNCOMPRESSED;
+  }
+
+  SceneFileInput::SceneFileInput( const std::string& fileName )
+    : _isOpen( false )
+    , _fileSize( 0 )
+    , _fileBytesRead( 0 )
+  {
+    std::ifstream file( fileName, std::ios::binary | std::ios::ate );
+    if ( !file )
+      return;
+    _fileSize = uint64_t( file.tellg( ));
+    file.close( );
+
+    switch ( sceneCompression( fileName ))
+    {
+    case SCENE_GZIP:
+      push( boost::iostreams::gzip_decompressor( ));
+      break;
+    case SCENE_ZSTD:
+#ifdef NEUROSCHEME_WITH_ZSTD
+      push( boost::iostreams::zstd_decompressor( ));
+      break;
+#else
+      return;
+#endif
+    case SCENE_UNCOMPRESSED:
+      break;
+    }
+    push( ByteCounter( _fileBytesRead ));
+    push( boost::iostreams::file_source( fileName, std::ios::binary ),
+          SCENE_FILE_BUFFER_SIZE );
+    _isOpen = component< boost::iostreams::file_source >(
+      size( ) - 1 )->is_open( );
+  }
+
+  SceneFileOutput::SceneFileOutput( const std::string& fileName )
+    : _isOpen( false )
+  {
+    switch ( sceneCompression( fileName ))
+    {
+    case SCENE_GZIP:
+      push( boost::iostreams::gzip_compressor( ));
+      break;
+    case SCENE_ZSTD:
+#ifdef NEUROSCHEME_WITH_ZSTD
+      push( boost::iostreams::zstd_compressor( ));
+      break;
+#else
+      return;
+#endif
+    case SCENE_UNCOMPRESSED:
+      break;
+    }
+    push( boost::iostreams::file_sink( fileName, std::ios::binary ),
+          SCENE_FILE_BUFFER_SIZE );
+    _isOpen = component< boost::iostreams::file_sink >(
+      size( ) - 1 )->is_open( );
+  }
+
+  bool SceneFileOutput::close( void )
+  {
+    bool written = _isOpen && good( );
+    try
+    {
+      // Closing the chain writes the end of the compressed stream
+      reset( );
+    }
+    catch ( const std::exception& )
+    {
+      written = false;
+    }
+    _isOpen = false;
+    return written && !bad( );
+  }
+}
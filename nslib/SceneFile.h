@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef __NSLIB_SCENE_FILE__
+#define __NSLIB_SCENE_FILE__
+
+#include <nslib/api.h>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <cstdint>
+#include <string>
+
+namespace nslib
+{
+  //! Compression of scene files, chosen by their extension
+  typedef enum
+  {
+    SCENE_UNCOMPRESSED = 0,
+    //! .gz files
+    SCENE_GZIP,
+    //! .zst files, only if built with NEUROSCHEME_WITH_ZSTD
+    SCENE_ZSTD
+  } TSceneCompression;
+
+  NSLIB_API TSceneCompression sceneCompression( const std::string& fileName );
+
+  //! Scene file read through a filter chain that decompresses it on the fly,
+  //! so neither the compressed nor the decompressed file is held in memory
+  class NSLIB_API SceneFileInput
+    : public boost::iostreams::filtering_istream
+  {
+  public:
+    SceneFileInput( const std::string& fileName );
+
+    bool isOpen( void ) const { return _isOpen; }
+    uint64_t fileSize( void ) const { return _fileSize; }
+    //! Bytes of the file read so far, compressed ones for compressed files
+    uint64_t fileBytesRead( void ) const { return _fileBytesRead; }
+
+  protected:
+    bool _isOpen;
+    uint64_t _fileSize;
+    uint64_t _fileBytesRead;
+  };
+
+  //! Scene file written through a filter chain that compresses it on the fly
+  class NSLIB_API SceneFileOutput
+    : public boost::iostreams::filtering_ostream
+  {
+  public:
+    SceneFileOutput( const std::string& fileName );
+
+    bool isOpen( void ) const { return _isOpen; }
+    //! Flushes the compressor and closes the file. Returns false if any
+    //! write failed
+    bool close( void );
+
+  protected:
+    bool _isOpen;
+  };
+}
+
+#endif
@@ -21,47 +21,67 @@
  */
 #include "DataManager.h"
 #include "DomainManager.h"
-#include "InteractionManager.h"
 #include "PaneManager.h"
 #include "SelectionManager.h"
+#include <cassert>
 
 namespace nslib
 {
-  SelectionManager::TSelection SelectionManager::_activeSelection =
-    TSelection( );
+  Bitmap SelectionManager::_selected = Bitmap( );
+  Bitmap SelectionManager::_partiallySelected = Bitmap( );
   SelectionManager::TSelections SelectionManager::_storedSelections =
     TSelections( );
+  std::unordered_set< shift::Entity* > SelectionManager::_changedEntities =
+    std::unordered_set< shift::Entity* >( );
+  std::unordered_map< unsigned int, shift::Entity* >
+    SelectionManager::_selectableIdToEntity =
+    std::unordered_map< unsigned int, shift::Entity* >( );
+  Bitmap SelectionManager::_selectableEntitiesMask = Bitmap( );
+  bool SelectionManager::_selectableEntitiesIndexValid = false;
+  size_t SelectionManager::_indexedEntitiesSize = 0;
+  Domain* SelectionManager::_indexedDomain = nullptr;
 
   void SelectionManager::setSelectedState( shift::Entity* entity,
                                            SelectedState state )
   {
-    _activeSelection[ entity ] = state;
+    const auto gid = entity->entityGid( );
+    if ( getSelectedState( entity ) != state )
+      _changedEntities.insert( entity );
+    _selected.set( gid, state == SelectedState::SELECTED );
+    _partiallySelected.set( gid, state == SelectedState::PARTIALLY_SELECTED );
   }
 
   SelectedState SelectionManager::getSelectedState( shift::Entity* entity )
   {
-    if ( _activeSelection.find( entity ) == _activeSelection.end( ))
-      return SelectedState::UNSELECTED;
-    else
-      return _activeSelection.at( entity );
+    const auto gid = entity->entityGid( );
+    if ( _selected.test( gid ))
+      return SelectedState::SELECTED;
+    if ( _partiallySelected.test( gid ))
+      return SelectedState::PARTIALLY_SELECTED;
+    return SelectedState::UNSELECTED;
   }
 
   std::vector< shift::Entity* > SelectionManager::getActiveSelection( void )
   {
     std::vector< shift::Entity* > activeSelection;
+    const auto& entities = DataManager::entities( ).map( );
 
-    for ( auto selection: _activeSelection )
+    _selected.forEach( [ & ]( unsigned int gid )
     {
-      if( selection.second == SelectedState::SELECTED )
-        activeSelection.push_back( selection.first );
-    }
+      const auto entity = entities.find( gid );
+      if ( entity != entities.end( ))
+        activeSelection.push_back( entity->second );
+    });
 
     return activeSelection;
   }
 
   void SelectionManager::clearActiveSelection( void )
   {
-    _activeSelection.clear( );
+    _markSelectionChanged( _selected );
+    _markSelectionChanged( _partiallySelected );
+    _selected.clear( );
+    _partiallySelected.clear( );
   }
 
   void SelectionManager::clearStoredSelections( void )
@@ -69,41 +89,116 @@ namespace nslib
     _storedSelections.clear( );
   }
 
+  void SelectionManager::forgetEntity( shift::Entity* entity )
+  {
+    const auto gid = entity->entityGid( );
+    _selected.set( gid, false );
+    _partiallySelected.set( gid, false );
+    _changedEntities.erase( entity );
+  }
+
+  void SelectionManager::reset( void )
+  {
+    _selected.clear( );
+    _partiallySelected.clear( );
+    _storedSelections.clear( );
+    _changedEntities.clear( );
+    clearSelectableEntitiesIndex( );
+  }
+
   void SelectionManager::storeActiveSelection(
     const std::string& selectionName )
   {
-    _storedSelections[ selectionName ] = _activeSelection;
+    _storedSelections[ selectionName ] =
+      TSelection{ CompressedBitmap( _selected ),
+                  CompressedBitmap( _partiallySelected ) };
   }
 
   void SelectionManager::restoreStoredSelection(
     const std::string& selectionName )
   {
-    _activeSelection = _storedSelections[ selectionName ];
+    clearActiveSelection( );
+    const auto& storedSelection = _storedSelections[ selectionName ];
+    storedSelection.selected.decompress( _selected );
+    storedSelection.partiallySelected.decompress( _partiallySelected );
+    _markSelectionChanged( _selected );
+    _markSelectionChanged( _partiallySelected );
+  }
+
+  void SelectionManager::takeChangedEntities(
+    std::vector< shift::Entity* >& changedEntities )
+  {
+    changedEntities.assign( _changedEntities.begin( ),
+                            _changedEntities.end( ));
+    _changedEntities.clear( );
+  }
+
+  void SelectionManager::_markSelectionChanged( const Bitmap& selection )
+  {
+    const auto& entities = DataManager::entities( ).map( );
+    selection.forEach( [ & ]( unsigned int gid )
+    {
+      const auto entity = entities.find( gid );
+      if ( entity != entities.end( ))
+        _changedEntities.insert( entity->second );
+    });
   }
 
-  unsigned int selectionSize( const SelectionManager::TSelection& selection )
+  void SelectionManager::buildSelectableEntitiesIndex( void )
   {
-    assert( DomainManager::getActiveDomain( ) != nullptr );
-    return std::count_if(
-      selection.begin( ), selection.end( ),
-      []( const std::pair< shift::Entity*, SelectedState>& statePair )
+    const auto domain = DomainManager::getActiveDomain( );
+    assert( domain != nullptr );
+    const auto& entities = DataManager::entities( ).map( );
+
+    _selectableIdToEntity.clear( );
+    _selectableIdToEntity.reserve( entities.size( ));
+    _selectableEntitiesMask.clear( );
+    for ( const auto& entity : entities )
+    {
+      if ( domain->isSelectableEntity( entity.second ))
       {
-        return
-          DomainManager::getActiveDomain( )->isSelectableEntity(
-            statePair.first ) &&
-          statePair.second == SelectedState::SELECTED;
-      } );
+        _selectableIdToEntity[ domain->selectableEntityId( entity.second ) ] =
+          entity.second;
+        _selectableEntitiesMask.set( entity.first );
+      }
+    }
+
+    _selectableEntitiesIndexValid = true;
+    _indexedEntitiesSize = entities.size( );
+    _indexedDomain = domain;
+  }
+
+  void SelectionManager::clearSelectableEntitiesIndex( void )
+  {
+    _selectableIdToEntity.clear( );
+    _selectableEntitiesMask.clear( );
+    _selectableEntitiesIndexValid = false;
+  }
+
+  void SelectionManager::_checkSelectableEntitiesIndex( void )
+  {
+    if ( !_selectableEntitiesIndexValid ||
+         _indexedDomain != DomainManager::getActiveDomain( ) ||
+         _indexedEntitiesSize != DataManager::entities( ).map( ).size( ))
+      buildSelectableEntitiesIndex( );
+  }
+
+  const Bitmap& SelectionManager::_selectableEntities( void )
+  {
+    _checkSelectableEntitiesIndex( );
+    return _selectableEntitiesMask;
   }
 
   unsigned int SelectionManager::activeSelectionSize( void )
   {
-    return selectionSize( _activeSelection );
+    return _selected.countAnd( _selectableEntities( ));
   }
 
   unsigned int SelectionManager::storedSelectionSize(
     const std::string& selectionName )
   {
-    return selectionSize( _storedSelections[ selectionName ] );
+    return _storedSelections[ selectionName ].selected.countAnd(
+      _selectableEntities( ));
   }
 
   bool SelectionManager::existsStoredSelection(
@@ -123,18 +218,55 @@ namespace nslib
     return true;
   }
 
+  bool SelectionManager::combineStoredSelections(
+    const std::string& resultName, const std::string& firstName,
+    const std::string& secondName, TSelectionOperation operation )
+  {
+    const auto first = _storedSelections.find( firstName );
+    const auto second = _storedSelections.find( secondName );
+    if ( first == _storedSelections.end( ) ||
+         second == _storedSelections.end( ))
+      return false;
+
+    TSelection result;
+    switch ( operation )
+    {
+      case SELECTION_UNION:
+        result.selected = CompressedBitmap::unite(
+          first->second.selected, second->second.selected );
+        break;
+      case SELECTION_INTERSECTION:
+        result.selected = CompressedBitmap::intersect(
+          first->second.selected, second->second.selected );
+        break;
+      case SELECTION_DIFFERENCE:
+        result.selected = CompressedBitmap::subtract(
+          first->second.selected, second->second.selected );
+        break;
+    }
+    result.partiallySelected = CompressedBitmap::subtract(
+      CompressedBitmap::unite( first->second.partiallySelected,
+                               second->second.partiallySelected ),
+      result.selected );
+
+    _storedSelections[ resultName ] = result;
+    return true;
+  }
+
   void SelectionManager::selectableEntitiesIds(
       std::vector< unsigned int >& selectableEntitiesIds )
   {
     selectableEntitiesIds.clear( );
     const auto& domain = DomainManager::getActiveDomain( );
-    for ( const auto& statePair : _activeSelection )
+    const auto& selectable = _selectableEntities( );
+    const auto& entities = DataManager::entities( ).map( );
+    _selected.forEach( [ & ]( unsigned int gid )
     {
-      if ( domain->isSelectableEntity( statePair.first ) &&
-           statePair.second == SelectedState::SELECTED )
+      const auto entity = entities.find( gid );
+      if ( selectable.test( gid ) && entity != entities.end( ))
         selectableEntitiesIds.push_back(
-          domain->selectableEntityId( statePair.first ));
-    }
+          domain->selectableEntityId( entity->second ));
+    });
   }
 
   void propagateSelectedToChilds(
@@ -156,70 +288,54 @@ namespace nslib
   void SelectionManager::setSelectionFromSelectableEntitiesIds(
       const std::vector< unsigned int >& selectableEntitiesIds )
   {
-    _activeSelection.clear( );
-    const auto& domain = DomainManager::getActiveDomain( );
+    clearActiveSelection( );
+    _checkSelectableEntitiesIndex( );
 
-    // This is very costly
-    // TODO improve, this map could be computed once per domain
-    std::unordered_map< unsigned int, shift::Entity* > idToEntity;
     const auto& entities = DataManager::entities( );
-    for ( const auto& entity : entities.map( ))
-    {
-      if ( domain->isSelectableEntity( entity.second ))
-        idToEntity[ domain->selectableEntityId( entity.second ) ] =
-          entity.second;
-    }
-
     auto& relParentOf = *( DataManager::entities( ).
                            relationships( )[ "isParentOf" ]->asOneToN( ));
     auto& relChildOf = *( DataManager::entities( ).relationships( )
                           [ "isChildOf" ]->asOneToOne( ));
 
-    std::unordered_set< shift::Entity* > postCheckParentEntities;
+    // Number of selected children of each parent reached by this selection.
+    // A parent only changes state when one of its children becomes selected,
+    // so each newly selected entity walks up its ancestors at most once.
+    std::unordered_map< unsigned int, unsigned int > selectedChildren;
     for ( auto entityId : selectableEntitiesIds )
     {
-      setSelectedState( idToEntity[ entityId ], SelectedState::SELECTED );
-      propagateSelectedToChilds( entities, relParentOf,
-                                 idToEntity[ entityId ]->entityGid( ));
-      shift::Entity* entity = idToEntity[ entityId ];
-      postCheckParentEntities.insert(
-        entities.at( relChildOf[ entity->entityGid( ) ].entity ));
-    }
+      const auto entityIt = _selectableIdToEntity.find( entityId );
+      if ( entityIt == _selectableIdToEntity.end( ))
+        continue;
+      shift::Entity* entity = entityIt->second;
 
-    // This might get ugly :(
-    // TODO recheck
-    while ( postCheckParentEntities.size( ) > 0 )
-    {
-      for ( auto entityIt = postCheckParentEntities.begin( );
-            entityIt != postCheckParentEntities.end( ); )
+      // Selected entities already have their whole subtree selected
+      if ( getSelectedState( entity ) == SelectedState::SELECTED )
+        continue;
+      setSelectedState( entity, SelectedState::SELECTED );
+      propagateSelectedToChilds( entities, relParentOf, entity->entityGid( ));
+
+      auto childGid = entity->entityGid( );
+      while ( true )
       {
-        // c++11 to erase iterators without invalidating
-        const auto& entity = *entityIt;
-        const auto entityGid = entity->entityGid( );
-        entityIt = postCheckParentEntities.erase( entityIt );
-
-        bool allChildrenSelected;
-        bool noChildrenSelected;
-        InteractionManager::queryChildrenSelectedState(
-          entities, relParentOf, entityGid,
-          allChildrenSelected, noChildrenSelected );
-
-        // Partially selected
-        if ( !allChildrenSelected && !noChildrenSelected )
-          setSelectedState( entity,
-                            SelectedState::PARTIALLY_SELECTED );
-        else if ( allChildrenSelected )
-          setSelectedState( entity, SelectedState::SELECTED );
-
-        if ( relChildOf.find( entityGid ) != relChildOf.end( ) &&
-             entities.map( ).find( relChildOf[ entityGid ].entity ) !=
-             entities.map( ).end( ))
+        const auto parentIt = relChildOf.find( childGid );
+        if ( parentIt == relChildOf.end( ))
+          break;
+        const auto parentGid = parentIt->second.entity;
+        const auto parentEntity = entities.map( ).find( parentGid );
+        if ( parentEntity == entities.map( ).end( ))
+          break;
+
+        if ( ++selectedChildren[ parentGid ] <
+             relParentOf.at( parentGid ).size( ))
         {
-          // TODO If partially selected parent is always partially selected which
-          // can be an optimization
-          postCheckParentEntities.insert(
-            entities.at( relChildOf[ entityGid ].entity ));
+          if ( getSelectedState( parentEntity->second ) ==
+               SelectedState::UNSELECTED )
+            setSelectedState( parentEntity->second,
+                              SelectedState::PARTIALLY_SELECTED );
+          break;
         }
+        setSelectedState( parentEntity->second, SelectedState::SELECTED );
+        childGid = parentGid;
       }
     }
 
@@ -24,10 +24,15 @@
 
 #include <nslib/api.h>
 #include "SelectedState.h"
+#include "Bitmap.h"
 #include <shift/shift.h>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace nslib
 {
+  class Domain;
+
   class SelectableEntity
   {
   public:
@@ -37,9 +42,21 @@ namespace nslib
   class SelectionManager
   {
   public:
-    typedef std::unordered_map< shift::Entity*, SelectedState > TSelection;
+    //! Stored selections keep the entity gids of each state compressed
+    typedef struct
+    {
+      CompressedBitmap selected;
+      CompressedBitmap partiallySelected;
+    } TSelection;
     typedef std::unordered_map< std::string, TSelection > TSelections;
 
+    typedef enum
+    {
+      SELECTION_UNION,
+      SELECTION_INTERSECTION,
+      SELECTION_DIFFERENCE
+    } TSelectionOperation;
+
     NSLIB_API
     static void setSelectedState( shift::Entity* entity,
                                   SelectedState state );
@@ -53,6 +70,14 @@ namespace nslib
     static void clearStoredSelections( void );
     NSLIB_API
     static unsigned int activeSelectionSize( void );
+    //! Clears the selected state of an entity about to be deleted, as its
+    //! gid may be used by a new entity
+    NSLIB_API
+    static void forgetEntity( shift::Entity* entity );
+    //! Drops the active and stored selections and pending changes, to be
+    //! called when all entities are deleted and gids start over
+    NSLIB_API
+    static void reset( void );
 
     NSLIB_API
     static void storeActiveSelection( const std::string& selectionName );
@@ -64,6 +89,13 @@ namespace nslib
     static bool existsStoredSelection( const std::string& selectionName );
     NSLIB_API
     static bool deleteStoredSelection( const std::string& selectionName );
+    //! Stores as resultName the combination of two stored selections.
+    //! Partially selected marks of both are kept where the result is not
+    //! selected.
+    NSLIB_API
+    static bool combineStoredSelections( const std::string& resultName,
+      const std::string& firstName, const std::string& secondName,
+      TSelectionOperation operation );
 
     NSLIB_API
     static void selectableEntitiesIds(
@@ -72,10 +104,38 @@ namespace nslib
     static void setSelectionFromSelectableEntitiesIds(
       const std::vector< unsigned int >& selectableEntitiesIds );
 
+    //! Indexes the entities of the active domain by their selectable id.
+    //! Called once data has been loaded, it is also rebuilt on demand when
+    //! the domain or the number of entities changes.
+    NSLIB_API
+    static void buildSelectableEntitiesIndex( void );
+    //! Drops the index, to be called when entities are deleted
+    NSLIB_API
+    static void clearSelectableEntitiesIndex( void );
+
+    //! Moves into changedEntities the entities whose selected state changed
+    //! since the last call, so views only update their items
+    NSLIB_API
+    static void takeChangedEntities(
+      std::vector< shift::Entity* >& changedEntities );
+
   protected:
+    static void _markSelectionChanged( const Bitmap& selection );
+    //! Gids of the entities the active domain can select
+    static const Bitmap& _selectableEntities( void );
+    static void _checkSelectableEntitiesIndex( void );
 
-    static TSelection _activeSelection;
+    //! Active selection state, as two dense bitmaps indexed by entity gid
+    static Bitmap _selected;
+    static Bitmap _partiallySelected;
     static TSelections _storedSelections;
+    static std::unordered_map< unsigned int, shift::Entity* >
+      _selectableIdToEntity;
+    static Bitmap _selectableEntitiesMask;
+    static bool _selectableEntitiesIndexValid;
+    static size_t _indexedEntitiesSize;
+    static Domain* _indexedDomain;
+    static std::unordered_set< shift::Entity* > _changedEntities;
   };
 }
 
@@ -25,6 +25,7 @@
 #include <zeroeq/zeroeq.h>
 #include <lexis/lexis.h>
 #include <QObject>
+#include <algorithm>
 #include "PaneManager.h"
 
 #ifdef NEUROSCHEME_USE_GMRVLEX
@@ -38,24 +39,99 @@ namespace nslib
 {
   zeroeq::Subscriber* ZeroEQManager::_subscriber = nullptr;
   zeroeq::Publisher* ZeroEQManager::_publisher = nullptr;
-  SubscriberTimer* ZeroEQManager::_timer = nullptr;
+  std::vector< unsigned int > ZeroEQManager::_lastPublishedSelection =
+    std::vector< unsigned int >( );
+  bool ZeroEQManager::_hasPublishedSelection = false;
+  SubscriberThread* ZeroEQManager::_thread = nullptr;
 
-  SubscriberTimer::SubscriberTimer( void )
+  SubscriberThread::SubscriberThread( void )
+    : _stopped( false )
+    , _notified( false )
+    , _hasSelection( false )
+    , _hasViewMatrix( false )
   {
-    connect( this, SIGNAL( timeout( )),
-             this, SLOT( receiveEvents( )));
+    // The thread object lives in the GUI thread, so the slot runs there
+    connect( this, SIGNAL( eventsReceived( )),
+             this, SLOT( applyEvents( )), Qt::QueuedConnection );
   }
 
-  void SubscriberTimer::receiveEvents( void )
+  void SubscriberThread::stop( void )
+  {
+    _stopped = true;
+    wait( );
+  }
+
+  void SubscriberThread::run( void )
   {
     auto subscriber = ZeroEQManager::subscriber( );
-    if(subscriber)
+    while ( subscriber && !_stopped )
+    {
+      // Wake up on socket readiness, then drain the burst before the GUI
+      // thread gets to apply it
+      if ( subscriber->receive( RECEIVE_TIMEOUT_MS ))
+        while ( !_stopped && subscriber->receive( 0 ));
+    }
+  }
+
+  void SubscriberThread::setPendingSelection(
+    const std::vector< unsigned int >& ids )
+  {
+    QMutexLocker locker( &_mutex );
+    _selection = ids;
+    _hasSelection = true;
+    _notify( );
+  }
+
+  void SubscriberThread::setPendingViewMatrix( const double* matrix )
+  {
+    QMutexLocker locker( &_mutex );
+    std::copy( matrix, matrix + 16, _viewMatrix );
+    _hasViewMatrix = true;
+    _notify( );
+  }
+
+  void SubscriberThread::_notify( void )
+  {
+    // One queued call per burst, whatever the number of events
+    if ( !_notified )
     {
-      while ( subscriber->receive( 0 ));
-      this->start( 50 );
+      _notified = true;
+      emit eventsReceived( );
     }
   }
 
+  void SubscriberThread::applyEvents( void )
+  {
+    std::vector< unsigned int > selection;
+    double viewMatrix[ 16 ];
+    bool hasSelection, hasViewMatrix;
+    {
+      QMutexLocker locker( &_mutex );
+      hasSelection = _hasSelection;
+      hasViewMatrix = _hasViewMatrix;
+      if ( hasSelection )
+        selection.swap( _selection );
+      if ( hasViewMatrix )
+        std::copy( _viewMatrix, _viewMatrix + 16, viewMatrix );
+      _hasSelection = _hasViewMatrix = _notified = false;
+    }
+
+    if ( hasSelection )
+    {
+      nslib::Loggers::get( )->log(
+        std::string( "NeuroScheme: received selection with " +
+                     std::to_string( selection.size( )) +
+                     std::string( " neurons" )),
+        nslib::LOG_LEVEL_VERBOSE, NEUROSCHEME_FILE_LINE );
+      SelectionManager::setSelectionFromSelectableEntitiesIds( selection );
+      // Peers no longer have the last selection published from here, so
+      // selecting it again locally has to be sent
+      ZeroEQManager::_hasPublishedSelection = false;
+    }
+    if ( hasViewMatrix )
+      PaneManager::setViewMatrix( viewMatrix );
+  }
+
   void ZeroEQManager::connect( const std::string& session )
   {
     try
@@ -64,7 +140,7 @@ namespace nslib
         session.empty() ? zeroeq::DEFAULT_SESSION : session );
       _publisher = new zeroeq::Publisher(
         session.empty() ? zeroeq::DEFAULT_SESSION : session );
-      _timer = new SubscriberTimer( );
+      _thread = new SubscriberThread( );
 
       // _subscriber.subscribe(
       //   lexis::render::LookOut::ZEROBUF_TYPE_IDENTIFIER(),
@@ -96,7 +172,7 @@ namespace nslib
         { _modelViewUpdatedCallback(
             lexis::render::LookOut::create( data, size ));});
 
-      _timer->start( 50 );
+      _thread->start( );
     }
     catch(const std::exception &e)
     {
@@ -109,11 +185,14 @@ namespace nslib
 
   void ZeroEQManager::disconnect( void )
   {
-    if(_timer)
+    if(_thread)
     {
-      delete _timer;
-      _timer = nullptr;
+      _thread->stop( );
+      delete _thread;
+      _thread = nullptr;
     }
+    _lastPublishedSelection.clear( );
+    _hasPublishedSelection = false;
 
     if(_subscriber)
     {
@@ -128,10 +207,18 @@ namespace nslib
     }
   }
 
-  void ZeroEQManager::publishSelection(const std::vector< unsigned int >& gids )
+  void ZeroEQManager::publishSelection(const std::vector< unsigned int >& gids,
+                                       bool force )
   {
   if ( _publisher )
     {
+      // Views republish on every selection change, skip the repeated ones
+      if ( !force && _hasPublishedSelection &&
+           gids == _lastPublishedSelection )
+        return;
+      _lastPublishedSelection = gids;
+      _hasPublishedSelection = true;
+
       nslib::Loggers::get( )->log(
         std::string( "NeuroScheme: publishing selection with " +
                      std::to_string( gids.size( )) +
@@ -156,16 +243,15 @@ namespace nslib
 
   void ZeroEQManager::_selectionUpdateCallback (lexis::data::ConstSelectedIDsPtr event )
   {
-    std::cout << "Received " << event->getIdsVector( ).size( ) << " GIDS: ";
-    std::cout << std::endl;
-    SelectionManager::setSelectionFromSelectableEntitiesIds(
-      event->getIdsVector( ));
+    if ( _thread )
+      _thread->setPendingSelection( event->getIdsVector( ));
   }
 
   void ZeroEQManager::_modelViewUpdatedCallback (
     lexis::render::ConstLookOutPtr event )
   {
-    PaneManager::setViewMatrix( event->getMatrix( ));
+    if ( _thread )
+      _thread->setPendingViewMatrix( event->getMatrix( ));
   }
 
 #ifdef NEUROSCHEME_USE_ZEROEQ
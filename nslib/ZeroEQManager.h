@@ -26,7 +26,9 @@
 #include <shift/shift.h>
 #include "reps/SelectableItem.h"
 #include <QObject>
-#include <QTimer>
+#include <QMutex>
+#include <QThread>
+#include <atomic>
 
 #ifndef NEUROSCHEME_USE_ZEROEQ
 #define NEUROSCHEME_USE_ZEROEQ_IMPL { }
@@ -51,18 +53,46 @@
 
 namespace nslib
 {
-  class NSLIB_API SubscriberTimer : public QTimer
+  //! Blocks on the subscriber in its own thread and hands the received
+  //! events to the GUI thread. Only the latest selection and camera of a
+  //! burst are kept, so a backlog is applied once.
+  class NSLIB_API SubscriberThread : public QThread
   {
     Q_OBJECT;
   public:
-    SubscriberTimer( void ) NEUROSCHEME_USE_ZEROEQ_IMPL;
+    SubscriberThread( void ) NEUROSCHEME_USE_ZEROEQ_IMPL;
+    void stop( void ) NEUROSCHEME_USE_ZEROEQ_IMPL;
+
+    void setPendingSelection(
+      const std::vector< unsigned int >& /*ids*/ ) NEUROSCHEME_USE_ZEROEQ_IMPL;
+    void setPendingViewMatrix( const double* /*matrix*/ )
+      NEUROSCHEME_USE_ZEROEQ_IMPL;
+
+  signals:
+    void eventsReceived( void );
 
   public slots:
-    void receiveEvents( void ) NEUROSCHEME_USE_ZEROEQ_IMPL;
+    void applyEvents( void ) NEUROSCHEME_USE_ZEROEQ_IMPL;
+
+  protected:
+    void run( void ) override NEUROSCHEME_USE_ZEROEQ_IMPL;
+    void _notify( void ) NEUROSCHEME_USE_ZEROEQ_IMPL;
+
+    static const int RECEIVE_TIMEOUT_MS = 100;
+
+    QMutex _mutex;
+    std::atomic< bool > _stopped;
+    bool _notified;
+    bool _hasSelection;
+    bool _hasViewMatrix;
+    std::vector< unsigned int > _selection;
+    double _viewMatrix[ 16 ];
   };
 
   class NSLIB_API ZeroEQManager
   {
+    friend class SubscriberThread;
+
   public:
 
     static void connect( const std::string& /*session*/ )
@@ -71,8 +101,11 @@ namespace nslib
     NEUROSCHEME_USE_ZEROEQ_IMPL;
     ~ZeroEQManager( void ) NEUROSCHEME_USE_ZEROEQ_IMPL;
     static void receiveEvents( void ) NEUROSCHEME_USE_ZEROEQ_IMPL;
+    //! Publishes gids unless they were the last selection published and
+    //! no remote selection has been received since then, or force is set
     static void publishSelection(
-      const std::vector< unsigned int >& ) NEUROSCHEME_USE_GMRVLEX_IMPL;
+      const std::vector< unsigned int >&, bool /*force*/ = false )
+      NEUROSCHEME_USE_GMRVLEX_IMPL;
     static void publishFocusOnSelection(
       const std::vector< unsigned int >& ) NEUROSCHEME_USE_GMRVLEX_IMPL;
 
@@ -91,9 +124,11 @@ namespace nslib
 #ifdef NEUROSCHEME_USE_ZEROEQ
     static zeroeq::Subscriber *_subscriber;
     static zeroeq::Publisher *_publisher;
+    static std::vector< unsigned int > _lastPublishedSelection;
+    static bool _hasPublishedSelection;
 #endif
 
-    static SubscriberTimer* _timer;
+    static SubscriberThread* _thread;
 
   };
 } // namespace nslib
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#include "Animator.h"
+#include "../reps/Item.h"
+#include <algorithm>
+
+namespace nslib
+{
+  // Animations are advanced once per display frame
+  static const int ANIMATOR_TICK_MS = 16;
+
+  Animator::Animator( QObject* parent_ )
+    : QObject( parent_ )
+  {
+    _timer.setTimerType( Qt::PreciseTimer );
+    _timer.setInterval( ANIMATOR_TICK_MS );
+    connect( &_timer, SIGNAL( timeout( )), this, SLOT( _tick( )));
+    _clock.start( );
+  }
+
+  Animator::~Animator( void )
+  {
+    for ( auto item : _items )
+    {
+      item->_animationSlot = Item::NO_ANIMATION;
+      item->_animator = nullptr;
+    }
+  }
+
+  void Animator::animate( QGraphicsItem* graphicsItem, qreal toScale,
+    const QPointF& toPos, int duration )
+  {
+    auto item = dynamic_cast< Item* >( graphicsItem );
+    if ( !item )
+      return;
+
+    // Another canvas animator can not be driving the same item
+    if ( item->_animator && item->_animator != this )
+      item->_animator->stop( item );
+
+    const qint64 now = _clock.elapsed( );
+    unsigned int slot = item->_animationSlot;
+    if ( slot != Item::NO_ANIMATION )
+    {
+      // Stop where it is and retarget, taking the time already elapsed
+      _duration[ slot ] = now - _startTime[ slot ];
+    }
+    else
+    {
+      slot = static_cast< unsigned int >( _items.size( ));
+      _items.push_back( item );
+      _graphicsItems.push_back( graphicsItem );
+      _startPos.push_back( QPointF( ));
+      _endPos.push_back( QPointF( ));
+      _startScale.push_back( 0.0 );
+      _endScale.push_back( 0.0 );
+      _startTime.push_back( 0 );
+      _duration.push_back( duration );
+      item->_animationSlot = slot;
+      item->_animator = this;
+    }
+
+    _startPos[ slot ] = graphicsItem->pos( );
+    _startScale[ slot ] = graphicsItem->scale( );
+    _endPos[ slot ] = toPos;
+    _endScale[ slot ] = toScale;
+    _startTime[ slot ] = now;
+
+    auto& animation = item->animation( );
+    animation.startPos = _startPos[ slot ];
+    animation.endPos = toPos;
+    animation.startScale = _startScale[ slot ];
+    animation.endScale = toScale;
+
+    if ( !_timer.isActive( ))
+      _timer.start( );
+  }
+
+  void Animator::stop( Item* item )
+  {
+    if ( item->_animator == this && item->_animationSlot != Item::NO_ANIMATION )
+      _remove( item->_animationSlot );
+  }
+
+  void Animator::finish( void )
+  {
+    for ( unsigned int slot = 0; slot < _items.size( ); ++slot )
+    {
+      _graphicsItems[ slot ]->setPos( _endPos[ slot ]);
+      _graphicsItems[ slot ]->setScale( _endScale[ slot ]);
+    }
+    while ( !_items.empty( ))
+      _remove( static_cast< unsigned int >( _items.size( ) - 1 ));
+    _timer.stop( );
+  }
+
+  void Animator::_tick( void )
+  {
+    const qint64 now = _clock.elapsed( );
+    unsigned int slot = 0;
+    while ( slot < _items.size( ))
+    {
+      const qint64 duration = _duration[ slot ];
+      const qreal t = duration <= 0 ? 1.0 :
+        std::min( qreal( now - _startTime[ slot ]) / qreal( duration ), 1.0 );
+
+      _graphicsItems[ slot ]->setPos(
+        _startPos[ slot ] + ( _endPos[ slot ] - _startPos[ slot ]) * t );
+      _graphicsItems[ slot ]->setScale(
+        _startScale[ slot ] + ( _endScale[ slot ] - _startScale[ slot ]) * t );
+
+      // Finished animations are swapped with the last one, so the slot is
+      // visited again
+      if ( t >= 1.0 )
+        _remove( slot );
+      else
+        ++slot;
+    }
+
+    if ( _items.empty( ))
+      _timer.stop( );
+  }
+
+  void Animator::_remove( unsigned int slot )
+  {
+    const unsigned int last = static_cast< unsigned int >( _items.size( ) - 1 );
+    _items[ slot ]->_animationSlot = Item::NO_ANIMATION;
+    _items[ slot ]->_animator = nullptr;
+    if ( slot != last )
+    {
+      _items[ slot ] = _items[ last ];
+      _graphicsItems[ slot ] = _graphicsItems[ last ];
+      _startPos[ slot ] = _startPos[ last ];
+      _endPos[ slot ] = _endPos[ last ];
+      _startScale[ slot ] = _startScale[ last ];
+      _endScale[ slot ] = _endScale[ last ];
+      _startTime[ slot ] = _startTime[ last ];
+      _duration[ slot ] = _duration[ last ];
+      _items[ slot ]->_animationSlot = slot;
+    }
+    _items.pop_back( );
+    _graphicsItems.pop_back( );
+    _startPos.pop_back( );
+    _endPos.pop_back( );
+    _startScale.pop_back( );
+    _endScale.pop_back( );
+    _startTime.pop_back( );
+    _duration.pop_back( );
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef __NSLIB_ANIMATOR__
+#define __NSLIB_ANIMATOR__
+
+#include <nslib/api.h>
+#include <QElapsedTimer>
+#include <QGraphicsItem>
+#include <QObject>
+#include <QPointF>
+#include <QTimer>
+#include <vector>
+
+namespace nslib
+{
+  class Item;
+
+  //! Animates position and scale of the items of a canvas. Animations are
+  //! kept in contiguous arrays and all of them are advanced in a single
+  //! timer tick, instead of having a QPropertyAnimation pair per item.
+  class NSLIB_API Animator : public QObject
+  {
+    Q_OBJECT
+
+  public:
+    Animator( QObject* parent_ = nullptr );
+    virtual ~Animator( void );
+
+    //! Animates graphicsItem from its current position and scale. If it is
+    //! already being animated, the animation is stopped where it is and
+    //! retargeted, lasting the time it had been running.
+    void animate( QGraphicsItem* graphicsItem, qreal toScale,
+      const QPointF& toPos, int duration );
+
+    //! Stops the animation of item, leaving it where it is
+    void stop( Item* item );
+
+    //! Moves every animated item to its final position and scale
+    void finish( void );
+
+    unsigned int size( void ) const
+    {
+      return static_cast< unsigned int >( _items.size( ));
+    }
+
+  protected slots:
+    void _tick( void );
+
+  protected:
+    void _remove( unsigned int slot );
+
+    QTimer _timer;
+    QElapsedTimer _clock;
+
+    std::vector< Item* > _items;
+    std::vector< QGraphicsItem* > _graphicsItems;
+    std::vector< QPointF > _startPos;
+    std::vector< QPointF > _endPos;
+    std::vector< qreal > _startScale;
+    std::vector< qreal > _endScale;
+    std::vector< qint64 > _startTime;
+    std::vector< qint64 > _duration;
+  };
+}
+
+#endif
@@ -33,14 +33,50 @@ namespace nslib
 #define FAR 100.0f
 #define FOV 53.1301f
 
+// Items whose projection moves less than this are left in place
+#define MOVE_THRESHOLD 0.5f
+
   CameraBasedLayout::CameraBasedLayout( void )
     : Layout( "3D", Layout::CAMERA_ENABLED )
+    , _cachedEntitiesVersion( 0 )
   {
   }
 
+  void CameraBasedLayout::_cachePositions( const shift::Representations& reps )
+  {
+    if ( _cachedReps == reps &&
+         _cachedEntitiesVersion == _canvas->entitiesVersion( ))
+      return;
+
+    const auto& repsToEntities =
+      RepresentationCreatorManager::repsToEntities( );
+    const auto domain = DomainManager::getActiveDomain( );
+
+    _cachedReps = reps;
+    _cachedEntitiesVersion = _canvas->entitiesVersion( );
+    _cachedGraphicsReps.resize( reps.size( ));
+    _positions.resize( 4, reps.size( ));
+    for ( unsigned int position = 0; position < reps.size( ); ++position )
+    {
+      _cachedGraphicsReps[ position ] =
+        dynamic_cast< QGraphicsItemRepresentation* >( reps[ position ]);
+      _positions.col( position ) = Vector4f( 0.0f, 0.0f, 0.0f, 1.0f );
+
+      const auto entities = repsToEntities.find( reps[ position ]);
+      if ( entities == repsToEntities.end( ) || entities->second.size( ) < 1 )
+      {
+        Loggers::get( )->log( "No entities associated to representation",
+          LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+        continue;
+      }
+      _positions.col( position ) =
+        domain->entity3DPosition( *entities->second.begin( ));
+    }
+  }
+
   void CameraBasedLayout::_arrangeItems( const shift::Representations& reps,
                                          bool animate,
-                                         const shift::Representations& )
+                                         const TFilterBitmap& passesFilter )
   {
     const auto sceneWidth = 1000; //_scene->width( );
     const auto sceneHeight = 1000; //_scene->height( );
@@ -55,75 +91,87 @@ namespace nslib
                 2 * NEAR * FAR / (NEAR - FAR));
     _projectionMatrix.row( 3 ) = Vector4f( 0, 0, 1, 0 );
 
-    const auto& repsToEntities =
-      RepresentationCreatorManager::repsToEntities( );
+    _cachePositions( reps );
+
+    // All the entities are projected at once
+    const Eigen::Matrix< float, 4, Eigen::Dynamic > eyePositions =
+      PaneManager::viewMatrix( ) * _positions;
+    const Eigen::Matrix< float, 4, Eigen::Dynamic > clipPositions =
+      _projectionMatrix * eyePositions;
 
-    const auto& viewMatrix = PaneManager::viewMatrix( );
-    for ( const auto& representation : reps )
+    for ( unsigned int position = 0; position < reps.size( ); ++position )
     {
-      auto graphicsItemRep =
-        dynamic_cast< nslib::QGraphicsItemRepresentation* >( representation );
-      if ( graphicsItemRep )
+      auto graphicsItemRep = _cachedGraphicsReps[ position ];
+      if ( !graphicsItemRep )
+        continue;
+
+      auto graphicsItem = graphicsItemRep->item( &_canvas->scene( ));
+      if ( !graphicsItem || graphicsItem->parentItem( ))
+        continue;
+
+      auto item = dynamic_cast< Item* >( graphicsItem );
+      if ( !item )
+        continue;
+
+      const auto pos = eyePositions.col( position );
+      const float distance = pos.norm( );
+      const bool behindCamera = pos.z( ) > 0;
+      if ( behindCamera || distance == 0.0f )
+      {
+        graphicsItem->setVisible( false );
+        continue;
+      }
+
+      const auto clipPos = clipPositions.col( position );
+      auto posW = clipPos.w( );
+      if ( posW == 0.0f )
+      {
+        posW = 2.0f;
+      }
+      else
+      {
+        posW = posW + posW;
+      }
+      const float x = clipPos[0] * float( sceneWidth ) / posW;
+      const float y = clipPos[1] * float( sceneHeight ) / posW;
+      const float scale = 250.0f / distance;
+
+      // Culled when the item does not reach the frustum sides
+      const auto itemRect = graphicsItem->boundingRect( );
+      const float margin =
+        scale * std::max( itemRect.width( ), itemRect.height( ));
+      if ( std::abs( x ) > sceneWidth * 0.5f + margin ||
+           std::abs( y ) > sceneHeight * 0.5f + margin )
+      {
+        graphicsItem->setVisible( false );
+        continue;
+      }
+      graphicsItem->setVisible( true );
+      graphicsItem->setOpacity( _itemOpacity( passesFilter, position ));
+
+      // Compared against where the item is or is being animated to
+      QPointF currentPos = graphicsItem->pos( );
+      qreal currentScale = graphicsItem->scale( );
+      if ( item->animating( ))
+      {
+        currentPos = item->animation( ).endPos;
+        currentScale = item->animation( ).endScale;
+      }
+      const QPointF newPos( x, y );
+      if (( newPos - currentPos ).manhattanLength( ) < MOVE_THRESHOLD &&
+          std::abs( currentScale - scale ) *
+          std::max( itemRect.width( ), itemRect.height( )) < MOVE_THRESHOLD )
+        continue;
+
+      graphicsItem->setZValue( -distance );
+      if ( animate )
+      {
+        animateItem( graphicsItem, scale, QPoint( x, y ));
+      }
+      else // not animation
       {
-        auto graphicsItem = graphicsItemRep->item( &_canvas->scene( ));
-        if ( graphicsItem->parentItem( ))
-          continue;
-
-        auto item = dynamic_cast< Item* >( graphicsItem );
-        auto obj = dynamic_cast< QObject* >( graphicsItem );
-        if ( graphicsItem && item )
-        {
-
-          const auto entities = repsToEntities.at( representation );
-          if ( entities.size( ) < 1 )
-          {
-            Loggers::get( )->log( "No entities associated to representation",
-              LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
-          }
-          auto center = DomainManager::getActiveDomain( )->entity3DPosition(
-            *entities.begin( ));
-
-          Vector4f pos = viewMatrix * center;
-          const float distance = pos.norm( );
-          bool behindCamera = pos.z( ) > 0;
-
-//#define ANIM_DURATION 1200
-
-          if ( behindCamera || distance == 0.0f)
-          {
-            graphicsItem->setScale( 0.000001f );
-          }
-          else
-          {
-            pos = _projectionMatrix * pos;
-            auto posW = pos.w( );
-            if ( posW == 0.0f )
-            {
-              posW = 2.0f;
-            }
-            else
-            {
-              posW = posW + posW;
-            }
-            auto x = pos[0] * float( sceneWidth ) / posW;
-            auto y = pos[1] * float( sceneHeight ) / posW;
-
-            auto scale = 250.0f / distance;
-            auto zValue = -distance;
-
-            if ( obj && animate )
-            {
-              graphicsItem->setZValue( zValue );
-              animateItem( graphicsItem, scale, QPoint( x, y ));
-            }
-            else // not animation
-            {
-              graphicsItem->setZValue( zValue );
-              graphicsItem->setPos( x, y );
-              graphicsItem->setScale( scale );
-            }
-          }
-        }
+        graphicsItem->setPos( newPos );
+        graphicsItem->setScale( scale );
       }
     }
   }
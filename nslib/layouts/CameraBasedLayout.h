@@ -25,6 +25,8 @@
 #include <nslib/api.h>
 #include "Layout.h"
 #include "../DomainManager.h"
+#include "../reps/QGraphicsItemRepresentation.h"
+#include <Eigen/Dense>
 
 namespace nslib
 {
@@ -36,13 +38,22 @@ namespace nslib
   protected:
     void _arrangeItems( const shift::Representations& reps,
                         bool animate = true,
-                        const shift::Representations& postFilterReps =
-                        shift::Representations( )) final;
+                        const TFilterBitmap& passesFilter =
+                        TFilterBitmap( )) final;
 
     Layout* clone( void ) const override
     {
       return new CameraBasedLayout;
     }
+
+    //! Caches the 3D position of the entity of each rep in a column of
+    //! _positions. Rebuilt only when reps or the canvas entities change.
+    void _cachePositions( const shift::Representations& reps );
+
+    shift::Representations _cachedReps;
+    std::vector< QGraphicsItemRepresentation* > _cachedGraphicsReps;
+    Eigen::Matrix< float, 4, Eigen::Dynamic > _positions;
+    unsigned int _cachedEntitiesVersion;
   };
 }
 
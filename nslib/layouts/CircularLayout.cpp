@@ -67,12 +67,8 @@ namespace nslib
   }
 
   void CircularLayout::_arrangeItems( const shift::Representations& reps,
-    bool animate, const shift::Representations& postFilterReps )
+    bool animate, const TFilterBitmap& passesFilter )
   {
-    std::unordered_set< QGraphicsItem* > filteredOutItems;
-    auto useOpacityForFilter = _filterWidget->useOpacityForFiltering( );
-    const bool doFiltering =
-      _filterWidget && !_filterWidget->filterSetConfig( ).filters( ).empty( );
     unsigned int maxItemWidth = 0, maxItemHeight = 0;
     unsigned int repsToBeArranged = 0;
     for ( const auto& representation : reps )
@@ -89,14 +85,6 @@ namespace nslib
         if ( !item->parentItem( ))
         {
           ++repsToBeArranged;
-          if ( doFiltering && useOpacityForFilter )
-          {
-            if ( std::find( postFilterReps.begin( ), postFilterReps.end( ),
-              representation ) == postFilterReps.end( ))
-            {
-              filteredOutItems.insert( item );
-            }
-          }
           QRectF rect = item->childrenBoundingRect( ) | item->boundingRect( );
 
           if ( rect.width( ) > maxItemWidth )
@@ -121,11 +109,10 @@ namespace nslib
       ( 1.0f - static_cast< float >( _lineEditRadius->value( )) * 0.01f )
       * deltaAngle * radius;
 
-    const auto opacity = _filterWidget
-      ? float( _filterWidget->opacityValue( )) * 0.01f : 1.0f;
     qreal repsScale = 1.0f;
-    for ( const auto representation : reps )
+    for ( unsigned int position = 0; position < reps.size( ); ++position )
     {
+      const auto representation = reps[ position ];
       auto graphicsItemRep =
         dynamic_cast< nslib::QGraphicsItemRepresentation* >( representation );
       if ( !graphicsItemRep )
@@ -168,13 +155,7 @@ namespace nslib
             posY = radius * sin( angle );
           }
 
-          if ( useOpacityForFilter &&
-               filteredOutItems.count( graphicsItem ) == 1 )
-          {
-            graphicsItem->setOpacity( opacity );
-          }
-          else
-            graphicsItem->setOpacity( 1.0f );
+          graphicsItem->setOpacity( _itemOpacity( passesFilter, position ));
 
           if ( obj && animate )
           {
@@ -39,8 +39,7 @@ namespace nslib
   protected:
     void _arrangeItems( const shift::Representations& reps,
       bool animate = true,
-      const shift::Representations& postFilterReps =
-      shift::Representations( )) override;
+      const TFilterBitmap& passesFilter = TFilterBitmap( )) override;
     void _updateOptionsWidget( void ) override;
 
     Layout* clone( void ) const override;
@@ -31,6 +31,7 @@
 #include <nslib/Config.h>
 #include <nslib/SelectionManager.h>
 #include <QtWidgets/QMainWindow>
+#include <unordered_set>
 
 
 namespace nslib
@@ -39,6 +40,7 @@ namespace nslib
   FreeLayout::FreeLayout( QStatusBar* statusBar_ )
     : Layout( "Free", 0, new QWidget )
     , _movedItem{nullptr}
+    , _movedRep{nullptr}
     , _moveNewCheckBox( new QCheckBox )
     , _statusBar(statusBar_)
   {
@@ -57,7 +59,7 @@ namespace nslib
   }
 
   void FreeLayout::_arrangeItems( const shift::Representations& /*reps*/,
-    const bool /*animate*/, const shift::Representations& /*postFilterReps*/ )
+    const bool /*animate*/, const TFilterBitmap& /*passesFilter*/ )
   {
     Loggers::get( )->log( "Free Layout unable to arrange items.",
       LOG_LEVEL_WARNING );
@@ -77,6 +79,7 @@ namespace nslib
       static_cast<int>(std::max( itemSize.top( ), itemsBoundingRect.top( )))));
 
     _movedItem = nullptr;
+    _movedRep = nullptr;
     _statusBar->showMessage( "", 5 );
   }
 
@@ -99,6 +102,7 @@ namespace nslib
       auto itemRepresentation =
         dynamic_cast< QGraphicsItemRepresentation* >( nslibItem->parentRep( ));
       _movedItem = itemRepresentation->item( &_canvas->scene( ));
+      _movedRep = nslibItem->parentRep( );
       _moveStart = item_->pos( )- clickPos_;
       if( Config::showConnectivity( ))
       {
@@ -116,7 +120,10 @@ namespace nslib
       QString( " Y: " ) + QString::number( newItemPos.y( )));
     if( Config::showConnectivity( ))
     {
-      for ( auto& relationshipRep : _relationshipReps )
+      const auto incidentReps = _incidentRelationshipReps.find( _movedRep );
+      if ( incidentReps == _incidentRelationshipReps.end( ))
+        return;
+      for ( auto& relationshipRep : incidentReps->second )
       {
         relationshipRep->preRender( &preRenderOpConfig );
       }
@@ -139,29 +146,23 @@ namespace nslib
       entities, representations,
       true, true );
 
+    const std::unordered_set< shift::Representation* > currentReps(
+      representations.begin( ), representations.end( ));
+    const std::unordered_set< shift::Representation* > previousReps(
+      _entitiesReps.begin( ), _entitiesReps.end( ));
+
     shift::Representations removeReps;
-    shift::Representations updateReps;
     for( const auto& oldRep : _entitiesReps )
     {
-      if( std::find( representations.begin( ), representations.end( ),
-        oldRep ) == representations.end( ))
-      {
+      if( currentReps.count( oldRep ) == 0 )
         removeReps.push_back( oldRep );
-      }
-      else
-      {
-        updateReps.push_back( oldRep );
-      }
     }
     _removeRepresentations( removeReps );
     shift::Representations newReps;
     for( const auto& newRep : representations )
     {
-      if( std::find( updateReps.begin( ), updateReps.end( ),
-        newRep ) == updateReps.end( ))
-      {
+      if( previousReps.count( newRep ) == 0 )
         newReps.push_back( newRep );
-      }
     }
 
     _addRepresentations( newReps, true );
@@ -176,6 +177,7 @@ namespace nslib
       RepresentationCreatorManager::generateRelations( entities,
         newRepresentations, "aggregatedConnectsTo", true );
       _relationshipReps = newRepresentations;
+      _indexRelationshipReps( );
       _addRepresentations( _relationshipReps, false );
       OpConfig opConfig( &_canvas->scene( ), false, _isGrid );
       for ( auto& relationshipRep : _relationshipReps )
@@ -252,7 +254,7 @@ namespace nslib
         }
 
         if ( !item->parentItem( )
-          && !_canvas->scene( ).items( ).contains( item ))
+          && item->scene( ) != &_canvas->scene( ))
         {
           if ( isEntity )
           {
@@ -278,6 +280,7 @@ namespace nslib
             }
             item->setScale( repsScale );
           }
+          item->setVisible( true );
           _canvas->scene( ).addItem( item );
         }
       }
@@ -304,7 +307,7 @@ namespace nslib
         }
 
         if ( !item->parentItem( )
-             && _canvas->scene( ).items( ).contains( item ))
+             && item->scene( ) == &_canvas->scene( ))
         {
           _canvas->scene( ).removeItem( item );
         }
@@ -322,12 +325,35 @@ namespace nslib
   {
     _removeRepresentations( _relationshipReps );
     _relationshipReps.clear( );
+    _incidentRelationshipReps.clear( );
+  }
+
+  void FreeLayout::_indexRelationshipReps( void )
+  {
+    _incidentRelationshipReps.clear( );
+    const std::unordered_set< shift::Representation* > displayedRelationships(
+      _relationshipReps.begin( ), _relationshipReps.end( ));
+
+    for ( const auto& relatedEntities :
+      RepresentationCreatorManager::relatedEntities( ))
+    {
+      const auto& relatedTuple = relatedEntities.second;
+      auto relationshipRep = std::get< 0 >( relatedTuple );
+      if ( displayedRelationships.count( relationshipRep ) == 0 )
+        continue;
+      auto srcRep = std::get< 3 >( relatedTuple );
+      auto dstRep = std::get< 4 >( relatedTuple );
+      _incidentRelationshipReps[ srcRep ].push_back( relationshipRep );
+      if ( dstRep != srcRep )
+        _incidentRelationshipReps[ dstRep ].push_back( relationshipRep );
+    }
   }
 
   void FreeLayout::init( )
   {
     _relationshipReps.clear( );
     _entitiesReps.clear( );
+    _incidentRelationshipReps.clear( );
   }
 
   void FreeLayout::_addRepresentations( const shift::Representations& reps )
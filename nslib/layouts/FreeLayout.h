@@ -26,6 +26,7 @@
 #include <nslib/api.h>
 #include <QtWidgets/QStatusBar>
 #include "Layout.h"
+#include <unordered_map>
 
 namespace nslib
 {
@@ -63,20 +64,27 @@ namespace nslib
       void _removeRepresentations( const shift::Representations& reps );
 
       void _arrangeItems( const shift::Representations& reps, bool animate = true,
-        const shift::Representations& postFilterReps = shift::Representations( ))
+        const TFilterBitmap& passesFilter = TFilterBitmap( ))
       override;
 
       void _updateOptionsWidget( void ) override;
 
       Layout* clone( void ) const override;
 
+      //! Maps every entity rep to the relationship reps attached to it, so
+      //! dragging only has to update the arrows of the moved rep
+      void _indexRelationshipReps( void );
+
     private:
       QGraphicsItem* _movedItem;
+      shift::Representation* _movedRep;
       QPointF _moveStart;
       QCheckBox* _moveNewCheckBox;
       OpConfig preRenderOpConfig;
       shift::Representations _relationshipReps;
       shift::Representations _entitiesReps;
+      std::unordered_map< shift::Representation*, shift::Representations >
+        _incidentRelationshipReps;
       QStatusBar* _statusBar;
   };
 
@@ -80,49 +80,82 @@ namespace nslib
     return _lineEditPaddingY->value( );
   }
 
+  bool GridLayout::_hasParentRep(
+    const shift::Representation* representation ) const
+  {
+    // Reps of subentities are drawn inside the items of their super entities
+    const auto& repsToEntities =
+      RepresentationCreatorManager::repsToEntities( );
+    const auto entities = repsToEntities.find(
+      const_cast< shift::Representation* >( representation ));
+    if ( entities != repsToEntities.end( ) && !entities->second.empty( ) &&
+         ( *entities->second.begin( ))->isSubEntity( ))
+      return true;
+
+    // Items already created tell it directly
+    auto graphicsItemRep =
+      dynamic_cast< const QGraphicsItemRepresentation* >( representation );
+    if ( !graphicsItemRep )
+      return false;
+    const auto item = graphicsItemRep->items( ).find( &_canvas->scene( ));
+    return item != graphicsItemRep->items( ).end( ) && item->second &&
+      item->second->parentItem( );
+  }
+
   void GridLayout::_arrangeItems( const shift::Representations& reps,
-    bool animate, const shift::Representations& postFilterReps )
+    bool animate, const TFilterBitmap& passesFilter )
   {
     _isGrid = true;
-    std::unordered_set< QGraphicsItem* > filteredOutItems;
-    auto useOpacityForFilter = _filterWidget->useOpacityForFiltering( );
-    bool doFiltering =
-      _filterWidget && !_filterWidget->filterSetConfig( ).filters( ).empty( );
     unsigned int maxItemWidth = 0, maxItemHeight = 0;
     unsigned int repsToBeArranged = 0;
-    for ( const auto& representation : reps )
+    if ( _virtualized )
     {
-      auto graphicsItemRep =
-        dynamic_cast< nslib::QGraphicsItemRepresentation* >( representation );
-      if ( !graphicsItemRep )
+      // Only the first item is built to size the grid cells, the rest of
+      // virtual items are assumed to share its bounds
+      _virtualBoundingRect = QRectF( );
+      for ( const auto& representation : reps )
       {
-        nslib::Loggers::get( )->log( "Item null",
-          nslib::LOG_LEVEL_WARNING );
+        auto graphicsItemRep =
+          dynamic_cast< nslib::QGraphicsItemRepresentation* >( representation );
+        if ( !graphicsItemRep || _hasParentRep( representation ))
+          continue;
+        ++repsToBeArranged;
+        if ( repsToBeArranged > 1 )
+          continue;
+        auto item = graphicsItemRep->item( &_canvas->scene( ));
+        _virtualItemRect = item->childrenBoundingRect( ) | item->boundingRect( );
+        maxItemWidth = static_cast< unsigned int >( _virtualItemRect.width( ));
+        maxItemHeight = static_cast< unsigned int >( _virtualItemRect.height( ));
+        _materializedReps.insert( representation );
       }
-      else
+    }
+    else
+    {
+      for ( const auto& representation : reps )
       {
-        auto item = graphicsItemRep->item( &_canvas->scene( ));
-        if ( !item->parentItem( ))
+        auto graphicsItemRep =
+          dynamic_cast< nslib::QGraphicsItemRepresentation* >( representation );
+        if ( !graphicsItemRep )
         {
-          ++repsToBeArranged;
-          if ( doFiltering && useOpacityForFilter )
+          nslib::Loggers::get( )->log( "Item null",
+            nslib::LOG_LEVEL_WARNING );
+        }
+        else
+        {
+          auto item = graphicsItemRep->item( &_canvas->scene( ));
+          if ( !item->parentItem( ))
           {
-            if ( std::find( postFilterReps.begin( ), postFilterReps.end( ),
-              representation ) == postFilterReps.end( ))
+            ++repsToBeArranged;
+            const QRectF rect = item->childrenBoundingRect( ) | item->boundingRect( );
+
+            if ( rect.width( ) > maxItemWidth )
             {
-              filteredOutItems.insert( item );
+              maxItemWidth = static_cast< unsigned int >( rect.width( ));
+            }
+            if ( rect.height( ) > maxItemHeight )
+            {
+              maxItemHeight = static_cast<unsigned int>( rect.height( ));
             }
-          }
-
-          const QRectF rect = item->childrenBoundingRect( ) | item->boundingRect( );
-
-          if ( rect.width( ) > maxItemWidth )
-          {
-            maxItemWidth = static_cast< unsigned int >( rect.width( ));
-          }
-          if ( rect.height( ) > maxItemHeight )
-          {
-            maxItemHeight = static_cast<unsigned int>( rect.height( ));
           }
         }
       }
@@ -182,14 +215,35 @@ namespace nslib
     const int topMargin = static_cast< int >( ( ( deltaY * repsScale ) +
       ( gv->height( ) - numRows * deltaY * repsScale )) * 0.5f);
 
-    const auto opacity = _filterWidget
-      ? float( _filterWidget->opacityValue( )) * 0.01 : 1.0f;
+    if ( _virtualized )
+      _virtualGrid = TVirtualGrid{
+        QPointF( - gv->width( ) * 0.5f + leftMargin -
+                 repsScale * _virtualItemRect.center( ).x( ),
+                 - gv->height( ) * 0.5f + topMargin -
+                 repsScale * _virtualItemRect.center( ).y( )),
+        QSizeF( deltaX * repsScale, deltaY * repsScale ), numColumns };
 
-    for ( const auto& representation : reps )
+    for ( unsigned int position = 0; position < reps.size( ); ++position )
     {
+      const auto& representation = reps[ position ];
       auto graphicsItemRep =
         dynamic_cast< nslib::QGraphicsItemRepresentation* >( representation );
-      if ( !graphicsItemRep )
+      if ( _virtualized )
+      {
+        if ( !graphicsItemRep || _hasParentRep( representation ))
+          continue;
+        const qreal posX = _x * deltaX * repsScale - gv->width( ) * 0.5f +
+          leftMargin - repsScale * _virtualItemRect.center( ).x( );
+        const qreal posY = _y * deltaY * repsScale - gv->height( ) * 0.5f +
+          topMargin - repsScale * _virtualItemRect.center( ).y( );
+        _virtualItems.push_back( TVirtualItem{ representation,
+          QPointF( posX, posY ), repsScale,
+          _itemOpacity( passesFilter, position )});
+        _virtualBoundingRect |= QRectF(
+          QPointF( posX, posY ) + _virtualItemRect.topLeft( ) * repsScale,
+          _virtualItemRect.size( ) * repsScale );
+      }
+      else if ( !graphicsItemRep )
       {
         Loggers::get( )->log( "Item null", LOG_LEVEL_WARNING );
       }
@@ -210,12 +264,7 @@ namespace nslib
           const qreal posY = _y * deltaY * repsScale - gv->height( ) * 0.5f +
             topMargin - repsScale * rect.center( ).y( );
 
-          if ( useOpacityForFilter && filteredOutItems.count( graphicsItem ) == 1 )
-          {
-            graphicsItem->setOpacity( opacity );
-          }
-          else
-            graphicsItem->setOpacity( 1.0f );
+          graphicsItem->setOpacity( _itemOpacity( passesFilter, position ));
 
           if ( obj && animate )
           {
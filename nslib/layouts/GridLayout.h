@@ -39,9 +39,15 @@ namespace nslib
   protected:
     void _arrangeItems( const shift::Representations& reps,
       bool animate = true,
-      const shift::Representations& postFilterReps =
-      shift::Representations( )) override;
+      const TFilterBitmap& passesFilter = TFilterBitmap( )) override;
     void _updateOptionsWidget( void ) override;
+    //! Whether the rep is drawn inside the item of another rep, so it takes
+    //! no cell of the grid
+    bool _hasParentRep( const shift::Representation* representation ) const;
+    bool _supportsVirtualization( void ) const override
+    {
+      return true;
+    }
 
     Layout* clone( void ) const override;
 
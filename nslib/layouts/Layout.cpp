@@ -23,15 +23,29 @@
 #include "../error.h"
 #include "../Config.h"
 #include "../DataManager.h"
+#include "../InteractionManager.h"
 #include "Layout.h"
 #include "../reps/Item.h"
 #include "../reps/SelectableItem.h"
 #include "../RepresentationCreatorManager.h"
 #include "../reps/CollapseButtonItem.h"
 #include "../SelectionManager.h"
+#include "../Canvas.h"
+#include "../PaneManager.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
 
 namespace nslib
 {
+  typedef std::chrono::steady_clock TDisplayClock;
+
+  static inline double elapsedMs( const TDisplayClock::time_point& start )
+  {
+    return std::chrono::duration< double, std::milli >(
+      TDisplayClock::now( ) - start ).count( );
+  }
+
   LayoutOptionsWidget::LayoutOptionsWidget( void )
     : _layout( new QGridLayout )
   {
@@ -43,6 +57,8 @@ namespace nslib
     return _layout;
   }
 
+  unsigned int Layout::_virtualizationThreshold = 20000;
+
   Layout::Layout( const std::string& name_,  unsigned int flags_,
     QWidget* layoutOptions_ )
     : _canvas( nullptr )
@@ -55,6 +71,9 @@ namespace nslib
     , _scatterPlotWidget( nullptr )
     , _layoutSpecialProperties( layoutOptions_ )
     , _isGrid( false )
+    , _displayTimings( TDisplayTimings{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 })
+    , _virtualized( false )
+    , _virtualGrid( TVirtualGrid{ QPointF( ), QSizeF( ), 0 })
   {
     _optionsWidget->layout( )->addWidget( _toolbox, 0, 0 );
 
@@ -114,6 +133,7 @@ namespace nslib
       "display " + std::to_string( entities.size( )),
       LOG_LEVEL_VERBOSE, NEUROSCHEME_FILE_LINE );
     representations.clear( );
+    _displayTimings = TDisplayTimings{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
 
     const bool doFiltering =
       _filterWidget &&
@@ -123,24 +143,27 @@ namespace nslib
       _sortWidget &&
       !_sortWidget->sortConfig( ).properties( ).empty( );
 
-    fires::Objects objects;
+    const bool useOpacityForFiltering =
+      doFiltering && _filterWidget->useOpacityForFiltering( );
+
     shift::Representations preFilterRepresentations;
     shift::Representations relationshipReps;
+    TFilterBitmap passesFilter;
+    auto stageStart = TDisplayClock::now( );
     if ( doFiltering || doSorting )
     {
+      // Sub-entities are not displayed on their own
+      shift::RelationshipOneToOne* relSubEntityOf = nullptr;
+      if ( DataManager::entities( ).
+           relationships( ).count( "isSubEntityOf" ) == 1 )
+        relSubEntityOf = DataManager::entities( ).
+          relationships( )[ "isSubEntityOf" ]->asOneToOne( );
+
+      fires::Objects objects;
       for ( const auto& entity : entities.vector( ))
       {
-        // If the entity is a sub-entity skip it
-        if ( DataManager::entities( ).
-             relationships( ).count( "isSubEntityOf" ) == 0 )
-        {
-          const auto& relSubEntityOf =
-            *( DataManager::entities( ).
-               relationships( )[ "isSubEntityOf" ]->asOneToOne( ));
-          if ( relSubEntityOf.count( entity->entityGid( )) == 0 )
-            objects.add( entity );
-        }
-        else
+        if ( !relSubEntityOf ||
+             relSubEntityOf->count( entity->entityGid( )) == 0 )
           objects.add( entity );
       }
 
@@ -150,29 +173,93 @@ namespace nslib
         firesSort.eval( objects, _sortWidget->sortConfig( ));
       }
 
-      fires::Objects objectsPreFilter = objects;
+      // Filters are evaluated once and the result is kept per position
+      // instead of as a second entity list. Canvas property columns are used
+      // when they hold every filtered property, fires otherwise.
+      std::vector< bool > entityPassesFilter( objects.size( ), true );
+      bool filteredWithColumns = false;
       if ( doFiltering )
       {
+        const auto& columns = _canvas->propertyColumns( );
+        const auto& filterRanges = _filterWidget->filterRanges( );
+        std::vector< bool > columnPassesFilter( columns.size( ), true );
+        filteredWithColumns = true;
+        for ( const auto& filter : _filterWidget->filterSetConfig( ).filters( ))
+        {
+          const auto range = filterRanges.find( filter.first );
+          if ( range == filterRanges.end( ) ||
+               !columns.filter( filter.first, range->second.first,
+                                range->second.second, columnPassesFilter ))
+          {
+            filteredWithColumns = false;
+            break;
+          }
+        }
+
+        unsigned int position = 0;
+        for ( const auto& object : objects )
+        {
+          if ( !filteredWithColumns )
+            break;
+          const int index =
+            columns.index( static_cast< shift::Entity* >( object ));
+          if ( index < 0 )
+            filteredWithColumns = false;
+          else
+            entityPassesFilter[ position++ ] = columnPassesFilter[ index ];
+        }
+      }
+      if ( doFiltering && !filteredWithColumns )
+      {
+        fires::Objects filteredObjects = objects;
         fires::FilterSet firesFilterSet;
-        firesFilterSet.eval( objects, _filterWidget->filterSetConfig( ));
+        firesFilterSet.eval( filteredObjects,
+                             _filterWidget->filterSetConfig( ));
+
+        const std::unordered_set< fires::Object* > passingObjects(
+          filteredObjects.begin( ), filteredObjects.end( ));
+        unsigned int position = 0;
+        for ( const auto& object : objects )
+          entityPassesFilter[ position++ ] = passingObjects.count( object ) == 1;
       }
 
-      shift::Entities filteredAndSortedEntities;
+      shift::Entities sortedEntities;
       for ( const auto& entity : objects )
-        filteredAndSortedEntities.add( static_cast< shift::Entity* >( entity ));
+        sortedEntities.add( static_cast< shift::Entity* >( entity ));
+      _displayTimings.sortFilter = elapsedMs( stageStart );
 
+      stageStart = TDisplayClock::now( );
       RepresentationCreatorManager::create(
-        filteredAndSortedEntities, representations,
+        sortedEntities, preFilterRepresentations,
         true, true );
 
-      shift::Entities entitiesPreFilter;
-      for ( const auto& entity : objectsPreFilter )
-        entitiesPreFilter.add( static_cast< shift::Entity* >( entity ));
+      // Reps are created once for all the sorted entities, filtered ones and
+      // the bitmap are then taken from each entity reps, which keeps them
+      // aligned with preFilterRepresentations
+      const auto& entitiesToReps =
+        RepresentationCreatorManager::entitiesToReps( );
+      shift::Entities filteredAndSortedEntities;
+      unsigned int position = 0;
+      for ( const auto& entity : sortedEntities.vector( ))
+      {
+        const bool passes = entityPassesFilter[ position++ ];
+        if ( passes )
+          filteredAndSortedEntities.add( entity );
 
-      RepresentationCreatorManager::create(
-        entitiesPreFilter, preFilterRepresentations,
-        true, true );
+        const auto entityReps = entitiesToReps.find( entity );
+        if ( entityReps == entitiesToReps.end( ))
+          continue;
+        for ( const auto& rep : entityReps->second )
+        {
+          if ( useOpacityForFiltering )
+            passesFilter.push_back( passes );
+          if ( passes )
+            representations.push_back( rep );
+        }
+      }
+      _displayTimings.create = elapsedMs( stageStart );
 
+      stageStart = TDisplayClock::now( );
       if ( Config::showConnectivity( ))
       {
         // Generate relationship representations
@@ -182,6 +269,7 @@ namespace nslib
           filteredAndSortedEntities, relationshipReps,
           "aggregatedConnectsTo", true );
       }
+      _displayTimings.generateRelations = elapsedMs( stageStart );
     }
     else
     {
@@ -191,8 +279,13 @@ namespace nslib
 
       auto& vector = entities.vector( );
       std::sort( vector.begin( ), vector.end( ), lessThanGid );
+      _displayTimings.sortFilter = elapsedMs( stageStart );
+
+      stageStart = TDisplayClock::now( );
       RepresentationCreatorManager::create( entities, representations, true, true );
+      _displayTimings.create = elapsedMs( stageStart );
 
+      stageStart = TDisplayClock::now( );
       if ( Config::showConnectivity( ))
       {
         // Generate relationship representations
@@ -201,36 +294,70 @@ namespace nslib
         RepresentationCreatorManager::generateRelations( entities,
           relationshipReps, "aggregatedConnectsTo", true );
       }
+      _displayTimings.generateRelations = elapsedMs( stageStart );
     }
 
+    // Arrows need the items of both ends, so connectivity disables
+    // virtualization
+    const auto numArrangedReps = useOpacityForFiltering ?
+      preFilterRepresentations.size( ) : representations.size( );
+    _virtualized = _supportsVirtualization( ) &&
+      _virtualizationThreshold > 0 &&
+      numArrangedReps >= _virtualizationThreshold &&
+      !Config::showConnectivity( );
+
+    stageStart = TDisplayClock::now( );
     _clearScene( );
-    if ( doFiltering && _filterWidget->useOpacityForFiltering( ))
-      _addRepresentations( preFilterRepresentations );
-    else
-      _addRepresentations( representations );
+    _virtualItems.clear( );
+    if ( !_virtualized )
+    {
+      _materializedReps.clear( );
+      if ( useOpacityForFiltering )
+        _addRepresentations( preFilterRepresentations );
+      else
+        _addRepresentations( representations );
+    }
+    _displayTimings.addRepresentations = elapsedMs( stageStart );
 
-    if ( doFiltering && _filterWidget->useOpacityForFiltering( ))
+    stageStart = TDisplayClock::now( );
+    if ( useOpacityForFiltering )
     {
-      _arrangeItems( preFilterRepresentations, animate, representations );
+      _arrangeItems( preFilterRepresentations, animate, passesFilter );
     }
     else
     {
       _arrangeItems( representations, animate );
     }
+    if ( _virtualized )
+      updateVirtualItems( );
+    _displayTimings.arrangeItems = elapsedMs( stageStart );
 
     if ( Config::showConnectivity( ))
     {
+      stageStart = TDisplayClock::now( );
       _addRepresentations( relationshipReps );
+      _displayTimings.addRepresentations += elapsedMs( stageStart );
 
+      stageStart = TDisplayClock::now( );
       OpConfig opConfig( &_canvas->scene( ), animate, _isGrid );
 
       for ( auto& relationshipRep : relationshipReps )
       {
         relationshipRep->preRender( &opConfig );
       }
+      _displayTimings.preRender = elapsedMs( stageStart );
     }
   }
 
+  float Layout::_itemOpacity( const TFilterBitmap& passesFilter,
+    unsigned int position ) const
+  {
+    if ( !_filterWidget || position >= passesFilter.size( ) ||
+         passesFilter[ position ] )
+      return 1.0f;
+    return float( _filterWidget->opacityValue( )) * 0.01f;
+  }
+
   void Layout::refreshWidgetsProperties( const TProperties& properties )
   {
     Loggers::get( )->log( "Refreshing property " + _name, LOG_LEVEL_VERBOSE,
@@ -321,9 +448,6 @@ namespace nslib
 
   void Layout::_addRepresentations( const shift::Representations& reps )
   {
-    const auto& repsToEntities =
-      RepresentationCreatorManager::repsToEntities( );
-
     for ( const auto representation : reps )
     {
       auto graphicsItemRep =
@@ -340,141 +464,256 @@ namespace nslib
         if ( !item || item->parentItem( ))
           continue;
 
-        // Find out if its entity is selected and if so set its pen
-        if ( repsToEntities.count( representation ) > 0 )
-        {
-          const auto entities = repsToEntities.at( representation );
-          if ( entities.empty( ))
-            Loggers::get( )->log(
-              "No entities associated to representation",
-              LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
-
-          auto selectableItem = dynamic_cast< SelectableItem* >( item );
-          if ( selectableItem )
-          {
-            auto selectedState = SelectionManager::getSelectedState(
-              *entities.begin( ));
-
-            selectableItem->setSelected( selectedState );
-
-            auto shapeItem =
-              dynamic_cast< QAbstractGraphicsShapeItem* >( item );
-
-            if ( shapeItem )
-            {
-              if ( selectedState == SelectedState::SELECTED )
-                shapeItem->setPen( SelectableItem::selectedPen( ));
-              else if ( selectedState == SelectedState::PARTIALLY_SELECTED )
-                shapeItem->setPen(
-                  SelectableItem::partiallySelectedPen( ));
-            }
-          }
-        }
+        _selectItem( representation, item );
 
         if ( !item->parentItem( ))
         {
+          // Items may have been culled by the 3D layout
+          item->setVisible( true );
           _canvas->scene( ).addItem( item );
         }
       }
     }
   }
 
-  void Layout::updateSelection( void )
+  void Layout::_selectItem( shift::Representation* representation,
+    QGraphicsItem* item )
   {
-    QList< QGraphicsItem* > items_ = _canvas->scene( ).items( );
-    for ( auto qitem = items_.begin( ); qitem != items_.end( ); ++qitem )
+    const auto& repsToEntities =
+      RepresentationCreatorManager::repsToEntities( );
+
+    // Find out if its entity is selected and if so set its pen
+    if ( repsToEntities.count( representation ) > 0 )
     {
-      auto selectableItem_ = dynamic_cast< SelectableItem* >( *qitem );
-      if ( selectableItem_ )
+      const auto entities = repsToEntities.at( representation );
+      if ( entities.empty( ))
+      {
+        Loggers::get( )->log(
+          "No entities associated to representation",
+          LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+        return;
+      }
+
+      auto selectableItem = dynamic_cast< SelectableItem* >( item );
+      if ( selectableItem )
       {
-        auto item = dynamic_cast< Item* >( *qitem );
-        if ( !item ) continue;
+        auto selectedState = SelectionManager::getSelectedState(
+          *entities.begin( ));
 
-        const auto& repsToEntities =
-          RepresentationCreatorManager::repsToEntities( );
+        selectableItem->setSelected( selectedState );
 
-        if ( repsToEntities.find( item->parentRep( )) != repsToEntities.end( ))
+        auto shapeItem =
+          dynamic_cast< QAbstractGraphicsShapeItem* >( item );
+
+        if ( shapeItem )
         {
-          const auto entities = repsToEntities.at( item->parentRep( ));
-          // Check only the first entity, this might not be ok
-          // TODO check this
-          if ( !entities.empty( ))
-          {
-            const auto& entity = *entities.begin( );
-            auto shapeItem =
-              dynamic_cast< QAbstractGraphicsShapeItem* >( item );
-
-            const auto state = SelectionManager::getSelectedState( entity );
-            selectableItem_->setSelected( state );
-            if ( state == SelectedState::UNSELECTED )
-              shapeItem->setPen( SelectableItem::unselectedPen( ));
-            else if ( state == SelectedState::SELECTED )
-              shapeItem->setPen( SelectableItem::selectedPen( ));
-            else if ( state == SelectedState::PARTIALLY_SELECTED )
-              shapeItem->setPen(
-                SelectableItem::partiallySelectedPen( ));
-          }
+          if ( selectedState == SelectedState::SELECTED )
+            shapeItem->setPen( SelectableItem::selectedPen( ));
+          else if ( selectedState == SelectedState::PARTIALLY_SELECTED )
+            shapeItem->setPen(
+              SelectableItem::partiallySelectedPen( ));
         }
       }
     }
   }
 
-  void Layout::_updateOptionsWidget( void )
+  void Layout::virtualizationThreshold( unsigned int threshold )
   {
+    _virtualizationThreshold = threshold;
   }
 
-  void Layout::animateItem( QGraphicsItem* graphicsItem,
-                            float toScale, const QPoint& toPos )
+  unsigned int Layout::virtualizationThreshold( void )
   {
-    auto obj = dynamic_cast< QObject* >( graphicsItem );
-    auto item = dynamic_cast< Item* >( graphicsItem );
+    return _virtualizationThreshold;
+  }
 
-    auto& scaleAnim = item->scaleAnim( );
-    if ( scaleAnim.state( ) == QAbstractAnimation::Running )
+  void Layout::updateVirtualItems( void )
+  {
+    if ( !_virtualized )
+      return;
+
+    auto& scene = _canvas->scene( );
+    const auto& view = _canvas->view( );
+    QRectF visibleRect =
+      view.mapToScene( view.viewport( )->rect( )).boundingRect( );
+    // Half a view of margin around, so short pans find their items ready
+    const qreal marginX = visibleRect.width( ) * 0.5;
+    const qreal marginY = visibleRect.height( ) * 0.5;
+    visibleRect.adjust( -marginX, -marginY, marginX, marginY );
+
+    // Only the cells of the rows and columns crossing the visible rect are
+    // checked, so panning does not depend on the number of items
+    const size_t numItems = _virtualItems.size( );
+    const size_t numColumns = std::max( _virtualGrid.numColumns, 1u );
+    const size_t numRows = ( numItems + numColumns - 1 ) / numColumns;
+    const auto cellRange = [ ]( qreal visibleMin, qreal visibleMax,
+                                qreal first, qreal extent, qreal cellSize,
+                                size_t numCells,
+                                size_t& begin, size_t& end )
     {
-      scaleAnim.stop( );
-      assert( scaleAnim.state( ) == QAbstractAnimation::Stopped );
-      scaleAnim.setStartValue( scaleAnim.currentValue( ));
-      scaleAnim.setDuration( scaleAnim.currentTime( ));
-      scaleAnim.setCurrentTime( 0 );
-    }
-    else
+      begin = 0;
+      end = numCells;
+      if ( cellSize <= 0 )
+        return;
+      const qreal firstCell = std::floor(
+        ( visibleMin - first - extent ) / cellSize );
+      const qreal lastCell = std::ceil( ( visibleMax - first ) / cellSize );
+      begin = size_t( std::min( std::max( firstCell, qreal( 0 )),
+                                qreal( numCells )));
+      end = size_t( std::max( std::min( lastCell + 1, qreal( numCells )),
+                              qreal( 0 )));
+    };
+
+    const qreal scale = numItems > 0 ? _virtualItems.front( ).scale : 1;
+    const QRectF itemRect( _virtualItemRect.topLeft( ) * scale,
+                           _virtualItemRect.size( ) * scale );
+    size_t firstColumn, endColumn, firstRow, endRow;
+    cellRange( visibleRect.left( ), visibleRect.right( ),
+               _virtualGrid.origin.x( ) + itemRect.left( ), itemRect.width( ),
+               _virtualGrid.cellSize.width( ), numColumns,
+               firstColumn, endColumn );
+    cellRange( visibleRect.top( ), visibleRect.bottom( ),
+               _virtualGrid.origin.y( ) + itemRect.top( ), itemRect.height( ),
+               _virtualGrid.cellSize.height( ), numRows,
+               firstRow, endRow );
+
+    std::unordered_set< shift::Representation* > visibleReps;
+    for ( size_t row = firstRow; row < endRow; ++row )
+      for ( size_t column = firstColumn; column < endColumn; ++column )
+      {
+        const size_t index = row * numColumns + column;
+        if ( index >= numItems )
+          break;
+        const auto& virtualItem = _virtualItems[ index ];
+        if ( !visibleRect.intersects( itemRect.translated( virtualItem.pos )))
+          continue;
+
+        auto graphicsItemRep = dynamic_cast< QGraphicsItemRepresentation* >(
+          virtualItem.representation );
+        if ( !graphicsItemRep )
+          continue;
+        auto item = graphicsItemRep->item( &scene );
+        if ( !item || item->parentItem( ))
+          continue;
+
+        visibleReps.insert( virtualItem.representation );
+        if ( item->scene( ) != &scene )
+        {
+          item->setPos( virtualItem.pos );
+          item->setScale( virtualItem.scale );
+          item->setOpacity( virtualItem.opacity );
+          item->setVisible( true );
+          _selectItem( virtualItem.representation, item );
+          scene.addItem( item );
+        }
+      }
+
+    for ( const auto& representation : _materializedReps )
     {
-      assert( scaleAnim.state( ) == QAbstractAnimation::Stopped );
-      scaleAnim.setTargetObject( obj );
-      scaleAnim.setDuration( ANIM_DURATION );
-      scaleAnim.setStartValue( graphicsItem->scale( ));
+      if ( visibleReps.count( representation ) == 0 &&
+           !_recycleItem( representation ))
+        visibleReps.insert( representation );
     }
-    scaleAnim.setEndValue( toScale );
+    _materializedReps.swap( visibleReps );
+  }
 
-    auto& posAnim = item->posAnim( );
-    if ( posAnim.state( ) == QAbstractAnimation::Running )
+  bool Layout::_recycleItem( shift::Representation* representation )
+  {
+    auto graphicsItemRep =
+      dynamic_cast< QGraphicsItemRepresentation* >( representation );
+    if ( !graphicsItemRep )
+      return true;
+
+    QGraphicsScene* scene = &_canvas->scene( );
+    auto sceneItem = graphicsItemRep->items( ).find( scene );
+    if ( sceneItem == graphicsItemRep->items( ).end( ) || !sceneItem->second )
+      return true;
+
+    // Children belonging to other reps are shared with them, so items
+    // owning child reps stay in the scene
+    auto graphicsItem = sceneItem->second;
+    for ( const auto& child : graphicsItem->childItems( ))
     {
-      posAnim.stop( );
-      assert( posAnim.state( ) == QAbstractAnimation::Stopped );
-      posAnim.setStartValue( posAnim.currentValue( ));
-      posAnim.setDuration( posAnim.currentTime( ));
-      posAnim.setCurrentTime( 0 );
+      auto childItem = dynamic_cast< Item* >( child );
+      if ( childItem && childItem->parentRep( ) &&
+           childItem->parentRep( ) != representation )
+        return false;
     }
-    else
+
+    // The item is kept by its rep, ready to be added again when it gets
+    // back close to the view
+    InteractionManager::forgetItem( graphicsItem );
+    if ( graphicsItem->scene( ) == scene )
+      scene->removeItem( graphicsItem );
+    return true;
+  }
+
+  void Layout::updateSelection(
+    const std::vector< shift::Entity* >& changedEntities )
+  {
+    const auto& entitiesToReps =
+      RepresentationCreatorManager::entitiesToReps( );
+    QGraphicsScene* scene = &_canvas->scene( );
+
+    for ( const auto& entity : changedEntities )
     {
-      assert( posAnim.state( ) == QAbstractAnimation::Stopped );
-      posAnim.setTargetObject( obj );
-      posAnim.setDuration( ANIM_DURATION );
-      posAnim.setStartValue( graphicsItem->pos( ));
+      const auto entityReps = entitiesToReps.find( entity );
+      if ( entityReps == entitiesToReps.end( ))
+        continue;
+
+      const auto state = SelectionManager::getSelectedState( entity );
+      for ( const auto& representation : entityReps->second )
+      {
+        auto graphicsItemRep =
+          dynamic_cast< QGraphicsItemRepresentation* >( representation );
+        if ( !graphicsItemRep )
+          continue;
+
+        // Only items already in this scene, none is created here
+        const auto& repItems = graphicsItemRep->items( );
+        const auto sceneItem = repItems.find( scene );
+        if ( sceneItem != repItems.end( ) && sceneItem->second &&
+             sceneItem->second->scene( ) == scene )
+          _setItemSelectedState( sceneItem->second, state );
+      }
     }
+  }
+
+  void Layout::_setItemSelectedState( QGraphicsItem* item,
+    SelectedState state )
+  {
+    auto selectableItem = dynamic_cast< SelectableItem* >( item );
+    auto shapeItem = dynamic_cast< QAbstractGraphicsShapeItem* >( item );
+    if ( !selectableItem || !shapeItem )
+      return;
+
+    selectableItem->setSelected( state );
+    if ( state == SelectedState::UNSELECTED )
+      shapeItem->setPen( SelectableItem::unselectedPen( ));
+    else if ( state == SelectedState::SELECTED )
+      shapeItem->setPen( SelectableItem::selectedPen( ));
+    else if ( state == SelectedState::PARTIALLY_SELECTED )
+      shapeItem->setPen( SelectableItem::partiallySelectedPen( ));
+  }
+
+  void Layout::_updateOptionsWidget( void )
+  {
+  }
+
+  void Layout::animateItem( QGraphicsItem* graphicsItem,
+                            float toScale, const QPoint& toPos )
+  {
     if ( toPos.x( ) != toPos.x( ) ||
          toPos.y( ) != toPos.y( ))
-      posAnim.setEndValue( QPoint( 0, 0 ));
+      _canvas->animator( ).animate( graphicsItem, toScale, QPoint( 0, 0 ),
+        ANIM_DURATION );
     else
-      posAnim.setEndValue( toPos );
-
-    posAnim.start( );
-    scaleAnim.start( );
+      _canvas->animator( ).animate( graphicsItem, toScale, toPos,
+        ANIM_DURATION );
   }
 
   void Layout::refreshCanvas( void )
   {
-    _canvas->displayEntities( false, false );
+    PaneManager::requestRefresh( _canvas, PaneManager::REFRESH_DATA );
   }
 }
@@ -32,11 +32,15 @@
 #include <QToolBox>
 #include <map>
 #include <iostream>
+#include <chrono>
+#include <vector>
+#include <unordered_set>
 #include <shift/shift.h>
 #include "../FilterWidget.h"
 #include "../ScatterPlotWidget.h"
 #include "../SortWidget.h"
 #include "../Properties.h"
+#include "../SelectedState.h"
 
 #define ANIM_DURATION 500
 
@@ -89,6 +93,41 @@ namespace nslib
       SCATTERPLOT_ENABLED = 0x08
     };
 
+    //! Wall time in milliseconds spent in each stage of the last display
+    typedef struct
+    {
+      double sortFilter;
+      double create;
+      double generateRelations;
+      double addRepresentations;
+      double arrangeItems;
+      double preRender;
+    } TDisplayTimings;
+
+    //! Dense bitmap, indexed by display position, telling which of the
+    //! representations passed to _arrangeItems pass the active filters.
+    //! Empty when every representation passes.
+    typedef std::vector< bool > TFilterBitmap;
+
+    //! Placement computed for a representation of a virtualized layout. Its
+    //! item is only created once the placement gets close to the view.
+    typedef struct
+    {
+      shift::Representation* representation;
+      QPointF pos;
+      qreal scale;
+      float opacity;
+    } TVirtualItem;
+
+    //! Cells in which virtual items are placed, row by row. Virtual item i
+    //! is at origin + ( i % numColumns, i / numColumns ) * cellSize
+    typedef struct
+    {
+      QPointF origin;
+      QSizeF cellSize;
+      unsigned int numColumns;
+    } TVirtualGrid;
+
     enum TLayoutIndexes {
       UNDEFINED = -1,
       GRID = 0,
@@ -115,7 +154,8 @@ namespace nslib
                           shift::Representations& representations,
                           bool animate = true );
 
-    void updateSelection( );
+    //! Updates only the items of the given entities
+    void updateSelection( const std::vector< shift::Entity* >& changedEntities );
 
     void canvas( Canvas* canvas_ )
     {
@@ -129,6 +169,31 @@ namespace nslib
 
     void refreshWidgetsProperties( const TProperties& properties );
 
+    const TDisplayTimings& displayTimings( void ) const
+    {
+      return _displayTimings;
+    }
+
+    //! Number of representations from which layouts supporting it only
+    //! create the items of the visible area. 0 disables virtualization.
+    static void virtualizationThreshold( unsigned int threshold );
+    static unsigned int virtualizationThreshold( void );
+
+    bool virtualized( void ) const
+    {
+      return _virtualized;
+    }
+
+    //! Scene rect covering every placement of a virtualized layout
+    const QRectF& virtualBoundingRect( void ) const
+    {
+      return _virtualBoundingRect;
+    }
+
+    //! Adds the items entering the visible rect (plus a margin) and removes
+    //! from the scene the ones that left it. Called on pan and zoom.
+    void updateVirtualItems( void );
+
   public slots:
     void refreshCanvas( void );
 
@@ -138,10 +203,26 @@ namespace nslib
     virtual void _addRepresentations( const shift::Representations& reps );
     virtual void _arrangeItems( const shift::Representations& /* reps */,
       bool /* animate */,
-      const shift::Representations& preFilterReps =  shift::Representations( ))
-    { ( void ) preFilterReps; }
+      const TFilterBitmap& passesFilter = TFilterBitmap( ))
+    { ( void ) passesFilter; }
+    float _itemOpacity( const TFilterBitmap& passesFilter,
+      unsigned int position ) const;
     virtual void _updateOptionsWidget( void );
 
+    //! Whether the layout is able to arrange representations as virtual
+    //! items, without creating all their graphics items
+    virtual bool _supportsVirtualization( void ) const
+    {
+      return false;
+    }
+    void _selectItem( shift::Representation* representation,
+      QGraphicsItem* item );
+    //! Takes the item of the representation out of the scene. Returns false
+    //! when it has to stay, as it owns items of other representations
+    bool _recycleItem( shift::Representation* representation );
+    static void _setItemSelectedState( QGraphicsItem* item,
+      SelectedState state );
+
     Canvas* _canvas;
     unsigned int _flags;
     LayoutOptionsWidget* _optionsWidget;
@@ -152,6 +233,16 @@ namespace nslib
     ScatterPlotWidget* _scatterPlotWidget;
     QWidget* _layoutSpecialProperties;
     bool _isGrid;
+    TDisplayTimings _displayTimings;
+
+    bool _virtualized;
+    std::vector< TVirtualItem > _virtualItems;
+    //! Item bounds, in item coordinates, used for every virtual item
+    QRectF _virtualItemRect;
+    QRectF _virtualBoundingRect;
+    TVirtualGrid _virtualGrid;
+    std::unordered_set< shift::Representation* > _materializedReps;
+    static unsigned int _virtualizationThreshold;
   };
 }
 
@@ -35,7 +35,7 @@ namespace nslib
   void ScatterPlotLayout::_arrangeItems(
     const shift::Representations& reps ,
     bool animate,
-    const shift::Representations& )
+    const TFilterBitmap& passesFilter )
   {
     if ( reps.size( ) == 0 )
     {
@@ -82,9 +82,13 @@ namespace nslib
 
     const auto& repsToEntities =
       RepresentationCreatorManager::repsToEntities( );
+    const auto& columns = _canvas->propertyColumns( );
+    const auto xColumn = columns.column( xProp );
+    const auto yColumn = columns.column( yProp );
 
-    for ( const auto& representation : reps )
+    for ( unsigned int position = 0; position < reps.size( ); ++position )
     {
+      const auto& representation = reps[ position ];
       auto graphicsItemRep =
         dynamic_cast< nslib::QGraphicsItemRepresentation* >(
           representation );
@@ -102,12 +106,23 @@ namespace nslib
         if ( item )
         {
           auto& entity = *( repsToEntities.at( representation ).begin( ));
-          auto xVal = entity->hasProperty( xProp ) ?
-            fires::PropertyManager::getPropertyCaster( xProp )->toInt(
-            entity->getProperty( xProp )) : 0;
-          auto yVal = entity->hasProperty( yProp ) ?
-            fires::PropertyManager::getPropertyCaster( yProp )->toInt(
-            entity->getProperty( yProp )) : 0;
+          const int index = columns.index( entity );
+          int xVal = 0;
+          int yVal = 0;
+          if ( index >= 0 )
+          {
+            xVal = xColumn ? xColumn->values[ index ] : 0;
+            yVal = yColumn ? yColumn->values[ index ] : 0;
+          }
+          else
+          {
+            xVal = entity->hasProperty( xProp ) ?
+              fires::PropertyManager::getPropertyCaster( xProp )->toInt(
+              entity->getProperty( xProp )) : 0;
+            yVal = entity->hasProperty( yProp ) ?
+              fires::PropertyManager::getPropertyCaster( yProp )->toInt(
+              entity->getProperty( yProp )) : 0;
+          }
 
           qreal posX = xMapper.map( xVal );
           qreal posY = - yMapper.map( yVal );
@@ -115,6 +130,8 @@ namespace nslib
           if ( posY != posY ) posY = 0;
           const qreal scale_ = _scatterPlotWidget->scale( ) / 100.0f;
 
+          graphicsItem->setOpacity( _itemOpacity( passesFilter, position ));
+
           if ( obj && animate )
           {
             animateItem( graphicsItem, scale_, QPoint( posX, posY ));
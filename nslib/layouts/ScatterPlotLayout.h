@@ -35,9 +35,8 @@ namespace nslib
 
     virtual void _arrangeItems( const shift::Representations& /* reps */,
                                 bool /* animate */,
-                                const shift::Representations&
-                                preFilterReps =
-                                shift::Representations( )) final;
+                                const TFilterBitmap& passesFilter =
+                                TFilterBitmap( )) final;
 
     Layout* clone( void ) const override
     {
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#include "DetailedItem.h"
+#include <algorithm>
+
+namespace nslib
+{
+  qreal DetailedItem::_dotThreshold = 4.0;
+  qreal DetailedItem::_glyphThreshold = 32.0;
+
+  DetailedItem::TLevelOfDetail DetailedItem::levelOfDetail( qreal screenSize )
+  {
+    if ( screenSize < _dotThreshold )
+      return DOT;
+    if ( screenSize < _glyphThreshold )
+      return GLYPH;
+    return FULL;
+  }
+
+  void DetailedItem::setThresholds( qreal dotThreshold_,
+    qreal glyphThreshold_ )
+  {
+    _dotThreshold = dotThreshold_;
+    _glyphThreshold = std::max( dotThreshold_, glyphThreshold_ );
+  }
+
+  qreal DetailedItem::dotThreshold( void )
+  {
+    return _dotThreshold;
+  }
+
+  qreal DetailedItem::glyphThreshold( void )
+  {
+    return _glyphThreshold;
+  }
+
+  void DetailedItem::setChildVisible( QGraphicsItem* child, bool visible )
+  {
+    auto parent = dynamic_cast< DetailedItem* >( child->parentItem( ));
+    if ( parent && parent->_levelOfDetail != FULL )
+    {
+      // Shown children wait hidden for the parent to get back to full detail
+      auto& hidden = parent->_childrenHiddenByDetail;
+      const auto hiddenChild = std::find( hidden.begin( ), hidden.end( ),
+                                          child );
+      if ( !visible && hiddenChild != hidden.end( ))
+        hidden.erase( hiddenChild );
+      else if ( visible && hiddenChild == hidden.end( ))
+        hidden.push_back( child );
+      child->setVisible( false );
+      return;
+    }
+    child->setVisible( visible );
+  }
+
+  DetailedItem::TLevelOfDetail DetailedItem::_updateLevelOfDetail(
+    QGraphicsItem* item_, const QPainter* painter )
+  {
+    const qreal screenSize = item_->boundingRect( ).width( ) *
+      QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform( ));
+    const auto levelOfDetail_ = levelOfDetail( screenSize );
+
+    if (( levelOfDetail_ == FULL ) != ( _levelOfDetail == FULL ))
+    {
+      // Children are only needed at full detail. Changing their visibility
+      // schedules a new update, so children stacked behind the parent get
+      // in sync in the next frame. Children hidden for other reasons, such
+      // as collapsed layers, are left as they are.
+      if ( levelOfDetail_ == FULL )
+      {
+        for ( auto child : _childrenHiddenByDetail )
+          child->setVisible( true );
+        _childrenHiddenByDetail.clear( );
+      }
+      else
+      {
+        for ( auto child : item_->childItems( ))
+          if ( child->isVisibleTo( item_ ))
+          {
+            _childrenHiddenByDetail.push_back( child );
+            child->setVisible( false );
+          }
+      }
+    }
+    _levelOfDetail = levelOfDetail_;
+    return _levelOfDetail;
+  }
+
+} // namespace nslib
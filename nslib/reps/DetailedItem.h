@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef __NSLIB__DETAILED_ITEM__
+#define __NSLIB__DETAILED_ITEM__
+
+#include <nslib/api.h>
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <vector>
+
+namespace nslib
+{
+  //! Mixin for items able to reduce their geometry when they are small on
+  //! screen. The on-screen size is taken from the painter world transform,
+  //! which already includes the canvas repsScale and the view transform.
+  class NSLIB_API DetailedItem
+  {
+  public:
+    typedef enum
+    {
+      DOT = 0,
+      GLYPH,
+      FULL
+    } TLevelOfDetail;
+
+    DetailedItem( void )
+      : _levelOfDetail( FULL )
+    {}
+
+    virtual ~DetailedItem( void )
+    {}
+
+    TLevelOfDetail levelOfDetail( void ) const
+    {
+      return _levelOfDetail;
+    }
+
+    //! Level of detail for an item whose width on screen is given in pixels
+    static TLevelOfDetail levelOfDetail( qreal screenSize );
+
+    //! Thresholds (in pixels) under which items are painted as a dot or as a
+    //! flat glyph. Setting them to 0 disables level of detail.
+    static void setThresholds( qreal dotThreshold, qreal glyphThreshold );
+    static qreal dotThreshold( void );
+    static qreal glyphThreshold( void );
+
+    //! Shows or hides child, a child item of a detailed item or not. It has
+    //! to be used instead of setVisible for children of detailed items, so
+    //! children shown while their parent has less than full detail are
+    //! shown once it gets back to full detail, and hidden ones stay hidden.
+    static void setChildVisible( QGraphicsItem* child, bool visible );
+
+  protected:
+
+    //! Recomputes the level of detail of item_ when painting it. Leaving
+    //! full detail hides its visible children, and getting back to it only
+    //! shows the children hidden that way.
+    TLevelOfDetail _updateLevelOfDetail( QGraphicsItem* item_,
+      const QPainter* painter );
+
+    TLevelOfDetail _levelOfDetail;
+    //! Children hidden because of the level of detail
+    std::vector< QGraphicsItem* > _childrenHiddenByDetail;
+
+    static qreal _dotThreshold;
+    static qreal _glyphThreshold;
+  };
+
+} // namespace nslib
+
+#endif // __NSLIB__DETAILED_ITEM__
@@ -24,22 +24,39 @@
 
 #include <shift/shift.h>
 #include "QGraphicsItemRepresentation.h"
-#include <QPropertyAnimation>
+#include "../layouts/Animator.h"
+#include <QPointF>
 
 namespace nslib
 {
   class Item
   {
+    friend class Animator;
+
   public:
+    //! Start and end values of the last animation of the item
+    typedef struct
+    {
+      QPointF startPos;
+      QPointF endPos;
+      qreal startScale;
+      qreal endScale;
+    } TAnimation;
+
+    static const unsigned int NO_ANIMATION = ~0u;
+
     Item( void )
       : _parentRep( nullptr )
+      , _animation( TAnimation{ QPointF( ), QPointF( ), 1.0, 1.0 })
+      , _animator( nullptr )
+      , _animationSlot( NO_ANIMATION )
     {
-      _scaleAnim.setPropertyName( "scale" );
-      _posAnim.setPropertyName( "pos" );
     }
 
     virtual ~Item( void )
     {
+      if ( _animator )
+        _animator->stop( this );
      if ( _parentRep )
       {
         auto* parentRep_ =
@@ -64,13 +81,16 @@ namespace nslib
       return false;
     }
 
-    QPropertyAnimation& posAnim( ) { return _posAnim; }
-    QPropertyAnimation& scaleAnim( ) { return _scaleAnim; }
+    const TAnimation& animation( void ) const { return _animation; }
+    TAnimation& animation( void ) { return _animation; }
+    bool animating( void ) const { return _animationSlot != NO_ANIMATION; }
 
   protected:
     shift::Representation* _parentRep;
-    QPropertyAnimation _posAnim;
-    QPropertyAnimation _scaleAnim;
+    TAnimation _animation;
+    //! Animator driving the item and index of the item in its arrays
+    Animator* _animator;
+    unsigned int _animationSlot;
   };
 } // namespace nslib
 
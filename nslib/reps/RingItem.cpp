@@ -21,9 +21,14 @@
  */
 #include "RingItem.h"
 #include <QBrush>
+#include <QMutex>
 
 namespace nslib
 {
+  std::map< RingItem::TRingKey, QPainterPath > RingItem::_pathCache;
+
+  static QMutex _pathCacheMutex;
+
   RingItem::RingItem( unsigned int initAngle,
                       unsigned int xRadius,
                       unsigned int yRadius,
@@ -31,30 +36,46 @@ namespace nslib
                       int angle,
                       Color color )
   {
+    this->setPath( _ringPath( initAngle, xRadius, yRadius, width, angle ));
+
+    setBrush( QBrush( color ));
+  }
+
+  void RingItem::clearPathCache( void )
+  {
+    QMutexLocker locker( &_pathCacheMutex );
+    _pathCache.clear( );
+  }
+
+  QPainterPath RingItem::_ringPath( unsigned int initAngle,
+                                     unsigned int xRadius,
+                                     unsigned int yRadius,
+                                     unsigned int width,
+                                     int angle )
+  {
+    QMutexLocker locker( &_pathCacheMutex );
+    const auto key = std::make_tuple( initAngle, xRadius, yRadius,
+      width, angle );
+    const auto cached = _pathCache.find( key );
+    if ( cached != _pathCache.end( ))
+      return cached->second;
+
     // Define outer circle
     int x_ = static_cast<int>( xRadius );
     int y_ = static_cast<int>( yRadius );
-    QPainterPath outerArc( QPoint( 0, 0 ));
-    outerArc.arcTo( -x_, -y_, x_ * 2, y_ * 2, initAngle, angle );
     QPainterPath outerFill( QPoint( 0, 0 ));
     outerFill.arcTo( - x_, - y_, x_ * 2, y_ * 2, initAngle, angle );
     outerFill.closeSubpath( );
-    ( void ) outerFill.united( outerArc );
 
     // Define inner circle
     x_ = static_cast<int>( xRadius ) - static_cast<int>( width );
     y_ = static_cast<int>( yRadius ) - static_cast<int>( width );
-    QPainterPath innerArc( QPoint( 0, 0 ));
-    innerArc.arcTo( -x_, -y_, x_ * 2, y_ * 2, initAngle, angle );
     QPainterPath innerFill( QPoint( 0, 0 ));
     innerFill.arcTo( - x_, - y_, x_ * 2, y_ * 2, initAngle, angle );
     innerFill.closeSubpath( );
-    ( void ) innerFill.united( innerArc );
 
     // Subtract inner from outer
-    QPainterPath ringFill = outerFill.subtracted( innerFill );
-    this->setPath( ringFill );
-
-    setBrush( QBrush( color ));
+    return _pathCache.insert(
+      std::make_pair( key, outerFill.subtracted( innerFill ))).first->second;
   }
 } // namespace nslib
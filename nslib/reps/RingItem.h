@@ -25,6 +25,8 @@
 #include <nslib/api.h>
 #include "../Color.h"
 #include <QGraphicsPathItem>
+#include <map>
+#include <tuple>
 
 namespace nslib
 {
@@ -34,6 +36,21 @@ namespace nslib
         RingItem( unsigned int initAngle, unsigned int xRadius,
                   unsigned int yRadius, unsigned int width,
                   int angle, Color color );
+
+        //! Drops the ring paths shared among ring items
+        static void clearPathCache( void );
+
+      protected:
+        //! Returns the ring path for the given geometry, building it only the
+        //! first time. QPainterPath is implicitly shared, so all the rings with
+        //! the same geometry use the same path data.
+        static QPainterPath _ringPath( unsigned int initAngle,
+          unsigned int xRadius, unsigned int yRadius, unsigned int width,
+          int angle );
+
+        typedef std::tuple< unsigned int, unsigned int, unsigned int,
+          unsigned int, int > TRingKey;
+        static std::map< TRingKey, QPainterPath > _pathCache;
     };
 } // namespace nslib
 
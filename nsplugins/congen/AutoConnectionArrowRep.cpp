@@ -75,8 +75,8 @@ namespace nslib
 
         //Change of the NeuronPop glyph's Scale during the animation
         const float glyphScaleStart =
-          originItem->scaleAnim( ).startValue( ).toFloat( );
-        const float glyphScaleEnd = originItem->scaleAnim( ).endValue( ).toFloat( );
+          originItem->animation( ).startScale;
+        const float glyphScaleEnd = originItem->animation( ).endScale;
 
         //Radius of the glyph to animate
         const float glyphBoundingRect =
@@ -84,8 +84,8 @@ namespace nslib
 
         //Change of glyph center position during the animation
         const auto originPosAnimStart =
-          originItem->posAnim( ).startValue( ).toPointF( );
-        const auto originPosAnimEnd = originItem->posAnim( ).endValue( ).toPointF( );
+          originItem->animation( ).startPos;
+        const auto originPosAnimEnd = originItem->animation( ).endPos;
 
         float glyphRadius = glyphScaleStart * glyphBoundingRect;
         const float isGrid = ( opConfig->isGrid( )) ? 1.0f : 0.0f;
@@ -115,17 +115,17 @@ namespace nslib
         lineAnim.setDuration( ANIM_DURATION );
 
         auto originPosAnimStart =
-          originItem->posAnim( ).startValue( ).toPointF( );
-        auto originPosAnimEnd = originItem->posAnim( ).endValue( ).toPointF( );
-        auto destPosAnimStart = destItem->posAnim( ).startValue( ).toPointF( );
-        auto destPosAnimEnd = destItem->posAnim( ).endValue( ).toPointF( );
+          originItem->animation( ).startPos;
+        auto originPosAnimEnd = originItem->animation( ).endPos;
+        auto destPosAnimStart = destItem->animation( ).startPos;
+        auto destPosAnimEnd = destItem->animation( ).endPos;
         auto originWidth_2 =
           originRep->item( scene )->boundingRect( ).width( ) * 0.5f;
         auto destWidth_2 =
           destRep->item( scene )->boundingRect( ).width( ) * 0.5f;
 
-        const auto& originScaleAnim = originItem->scaleAnim( );
-        const auto& destScaleAnim = destItem->scaleAnim( );
+        const auto& originScaleAnim = originItem->animation( );
+        const auto& destScaleAnim = destItem->animation( );
 
         const auto normAnimStart =
           QVector2D( destPosAnimStart - originPosAnimStart ).normalized( );
@@ -134,19 +134,19 @@ namespace nslib
 
         const auto destIniOri =
           QVector2D( originPosAnimStart ) + originWidth_2 *
-            originScaleAnim.startValue( ).toDouble( ) * normAnimStart;
+            originScaleAnim.startScale * normAnimStart;
 
         const auto destIniDest =
           QVector2D( destPosAnimStart ) - destWidth_2 *
-            originScaleAnim.startValue( ).toDouble( ) * normAnimStart;
+            originScaleAnim.startScale * normAnimStart;
 
         const auto destEndOri =
           QVector2D( originPosAnimEnd ) + originWidth_2 *
-            originScaleAnim.endValue( ).toDouble( ) * normAnimEnd;
+            originScaleAnim.endScale * normAnimEnd;
 
         const auto destEndDest =
           QVector2D( destPosAnimEnd ) - destWidth_2 *
-            destScaleAnim.endValue( ).toDouble( ) * normAnimEnd;
+            destScaleAnim.endScale * normAnimEnd;
 
         lineAnim.setStartValue(
           QLineF( QPointF( destIniOri.x( ), destIniOri.y( )),
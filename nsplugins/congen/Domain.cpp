@@ -174,23 +174,18 @@ namespace nslib
     {
     }
 
-    void Domain::importRelationshipsJSON(
-      const boost::property_tree::ptree& relationships,
-      std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity )
+    void Domain::importRelationsJSON( const std::string& relationType,
+      const boost::property_tree::ptree& relations,
+      GIDToEntity* oldGIDToEntity )
     {
-      addIsParentOfRelationshipsFromJSON( getRelationsOfType(
-        "isParentOf", relationships ), oldGIDToEntity );
-
-      addConnectsToRelationsFromJSON( getRelationsOfType(
-        "connectsTo", relationships ), oldGIDToEntity );
-
-      addAggregatedConnectionFromJSON( getRelationsOfType(
-        "aggregatedConnectedBy", relationships ), "aggregatedConnectedBy",
-        oldGIDToEntity );
-
-      addAggregatedConnectionFromJSON( getRelationsOfType(
-        "aggregatedConnectsTo", relationships ),"aggregatedConnectsTo",
-        oldGIDToEntity );
+      if ( relationType == "isParentOf" )
+        addIsParentOfRelationshipsFromJSON( relations, oldGIDToEntity );
+      else if ( relationType == "connectsTo" )
+        addConnectsToRelationsFromJSON( relations, oldGIDToEntity );
+      else if ( relationType == "aggregatedConnectedBy" ||
+                relationType == "aggregatedConnectsTo" )
+        addAggregatedConnectionFromJSON( relations, relationType,
+                                         oldGIDToEntity );
     }
 
     void Domain::exportRepresentationMaxMin( std::ostream& outputStream,
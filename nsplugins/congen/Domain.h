@@ -70,10 +70,9 @@ namespace nslib
     protected:
       std::unique_ptr< DomainGUI > _domainGUI;
 
-      void importRelationshipsJSON(
-        const boost::property_tree::ptree& relationships,
-        std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity
-        ) override;
+      void importRelationsJSON( const std::string& relationType,
+        const boost::property_tree::ptree& relations,
+        GIDToEntity* oldGIDToEntity ) override;
 
       void exportRepresentationMaxMin(
         std::ostream& outputStream, bool minimizeStream ) const override;
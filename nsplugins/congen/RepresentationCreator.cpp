@@ -221,6 +221,14 @@ namespace nslib
       shift::Representations& relatedEntities,
       shift::RelationshipOneToN* relatedElements )
     {
+      // Only relations between displayed entities are represented, so the
+      // adjacency of each entity is walked and checked against them
+      std::unordered_map< shift::EntityGid, shift::Entity* > displayedEntities;
+      displayedEntities.reserve( entities.size( ));
+      for( auto& entity : entities.vector( ))
+        displayedEntities.insert(
+          std::make_pair( entity->entityGid( ), entity ));
+
       for( auto& entity : entities.vector( ))
       {
         auto srcEntityRep = gidsToEntitiesReps.find( entity->entityGid( ));
@@ -232,23 +240,31 @@ namespace nslib
         if( entityRelations == relatedElements->end( ))
           continue;
 
-        for( auto& other : entities.vector( ))
+        auto relation = entityRelations->second.begin( );
+        while( relation != entityRelations->second.end( ))
         {
-          auto otherRep = gidsToEntitiesReps.find( other->entityGid( ));
-          if( otherRep == gidsToEntitiesReps.end( ))
+          const auto otherGid = relation->first;
+          const auto relProps = relation->second;
+
+          // Relations with the same entity are contiguous, just the first
+          // one is represented
+          do
+            ++relation;
+          while( relation != entityRelations->second.end( ) &&
+                 relation->first == otherGid );
+
+          auto other = displayedEntities.find( otherGid );
+          if( other == displayedEntities.end( ))
             continue;
 
-          auto numberOfConnections =
-            entityRelations->second.count( other->entityGid( ));
-
-          if( numberOfConnections == 0 )
+          auto otherRep = gidsToEntitiesReps.find( otherGid );
+          if( otherRep == gidsToEntitiesReps.end( ))
             continue;
 
           // TODO: Change to equal_range whenever multiple relationships between
           // the same elements are imported. Then, create a loop to iterate
           // over the given results and create a new one if not found.
-          auto combinedKey = std::make_pair( entity->entityGid( ),
-            other->entityGid( ));
+          auto combinedKey = std::make_pair( entity->entityGid( ), otherGid );
           auto alreadyConnected =
             relatedEntitiesReps.find( combinedKey );
 
@@ -265,14 +281,8 @@ namespace nslib
               relationRep = new ConnectionArrowRep( srcEntityRep->second.second,
                 otherRep->second.second, false );
             }
-            const std::unordered_multimap< shift::EntityGid,
-              shift::RelationshipProperties* >& relMMap =
-              ( *relatedElements )[ entity->entityGid( ) ];
-
-            auto relMMapIt = relMMap.find( other->entityGid( ));
-            if ( relMMapIt != relMMap.end( ))
+            if ( relProps )
             {
-              auto relProps = relMMapIt->second;
               float weightPropertyValue = 0.0f;
               if ( relProps->hasProperty( "Weight" ))
               {
@@ -305,7 +315,7 @@ namespace nslib
 
             alreadyConnected = relatedEntitiesReps.insert(
               std::make_pair( combinedKey,
-              std::make_tuple( relationRep, entity, other,
+              std::make_tuple( relationRep, entity, other->second,
               srcEntityRep->second.second, otherRep->second.second )));
           }
           relatedEntities.push_back( std::get< 0 >( alreadyConnected->second ));
@@ -320,6 +330,12 @@ namespace nslib
       shift::Representations& relatedEntities,
       shift::RelationshipAggregatedOneToN* relatedElements )
     {
+      std::unordered_map< shift::EntityGid, shift::Entity* > displayedEntities;
+      displayedEntities.reserve( entities.size( ));
+      for( auto& entity : entities.vector( ))
+        displayedEntities.insert(
+          std::make_pair( entity->entityGid( ), entity ));
+
       for( auto& entity : entities.vector( ))
       {
         auto srcEntityRep = gidsToEntitiesReps.find( entity->entityGid( ));
@@ -332,22 +348,21 @@ namespace nslib
         if( entityRelations == relatedElements->mapAggregatedRels( ).end( ))
           continue;
 
-        for( auto& other : entities.vector( ))
+        for( auto& otherEntityConnection : *entityRelations->second )
         {
-          auto otherRep = gidsToEntitiesReps.find( other->entityGid( ));
-          if( otherRep == gidsToEntitiesReps.end( ))
+          const auto otherGid = otherEntityConnection.first;
+          auto other = displayedEntities.find( otherGid );
+          if( other == displayedEntities.end( ))
             continue;
 
-          auto otherEntityConnection = entityRelations->second
-            ->find( other->entityGid( ));
-          if( otherEntityConnection == entityRelations->second->end( ))
+          auto otherRep = gidsToEntitiesReps.find( otherGid );
+          if( otherRep == gidsToEntitiesReps.end( ))
             continue;
 
           // TODO: Change to equal_range whenever multiple relationships between
           // the same elements are imported. Then, create a loop to iterate
           // over the given results and create a new one if not found.
-          auto combinedKey = std::make_pair( entity->entityGid( ),
-                                             other->entityGid( ));
+          auto combinedKey = std::make_pair( entity->entityGid( ), otherGid );
           auto alreadyConnected =
             relatedEntitiesReps.find( combinedKey );
 
@@ -366,7 +381,7 @@ namespace nslib
             }
 
             shift::RelationshipProperties* relationProperties =
-              otherEntityConnection->second
+              otherEntityConnection.second
               .relationshipAggregatedProperties.get( );
             if ( relationProperties )
             {
@@ -389,7 +404,7 @@ namespace nslib
             alreadyConnected = relatedEntitiesReps.insert(
               std::make_pair( combinedKey,
                 std::make_tuple( relationRep,
-                entity, other, srcEntityRep->second.second,
+                entity, other->second, srcEntityRep->second.second,
                 otherRep->second.second )));
           }
           relatedEntities.push_back( std::get< 0 >( alreadyConnected->second ));
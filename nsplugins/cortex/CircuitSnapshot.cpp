@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#include "CircuitSnapshot.h"
+
+#ifdef NEUROSCHEME_USE_NSOL
+
+#include <nslib/Loggers.h>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <cstring>
+
+#define SNAPSHOT_MAGIC "NSCSNAP"
+// All sections start at offsets multiple of this so the mapped arrays are
+// properly aligned
+#define SNAPSHOT_ALIGNMENT 8
+
+namespace nslib
+{
+  namespace cortex
+  {
+    namespace
+    {
+      typedef struct
+      {
+        char magic[ 8 ];
+        uint32_t version;
+        uint32_t keySize;
+        uint64_t numColumns;
+        uint64_t numMiniColumns;
+        uint64_t numNeurons;
+        uint64_t numConnections;
+      } TSnapshotHeader;
+
+      uint64_t aligned( uint64_t offset )
+      {
+        return ( offset + SNAPSHOT_ALIGNMENT - 1 ) &
+          ~uint64_t( SNAPSHOT_ALIGNMENT - 1 );
+      }
+
+      //! Offsets of the sections following the header
+      typedef struct
+      {
+        uint64_t key;
+        uint64_t summary;
+        uint64_t columns;
+        uint64_t miniColumns;
+        uint64_t neurons;
+        uint64_t connections;
+        uint64_t end;
+      } TSnapshotLayout;
+
+      TSnapshotLayout layout( const TSnapshotHeader& header )
+      {
+        TSnapshotLayout layout_;
+        layout_.key = sizeof( TSnapshotHeader );
+        layout_.summary = aligned( layout_.key + header.keySize );
+        layout_.columns = aligned( layout_.summary + sizeof( TSnapshotSummary ));
+        layout_.miniColumns = aligned(
+          layout_.columns + header.numColumns * sizeof( TSnapshotGroup ));
+        layout_.neurons = aligned(
+          layout_.miniColumns + header.numMiniColumns * sizeof( TSnapshotGroup ));
+        layout_.connections = aligned(
+          layout_.neurons + header.numNeurons * sizeof( TSnapshotNeuron ));
+        layout_.end = layout_.connections +
+          header.numConnections * sizeof( TSnapshotConnection );
+        return layout_;
+      }
+
+      bool writeAt( QSaveFile& file, uint64_t offset, const void* data,
+                    uint64_t size )
+      {
+        // Fill alignment gaps with zeros
+        static const char zeros[ SNAPSHOT_ALIGNMENT ] = { 0 };
+        const auto gap = offset - uint64_t( file.pos( ));
+        if ( gap > 0 && file.write( zeros, qint64( gap )) != qint64( gap ))
+          return false;
+        return size == 0 ||
+          file.write( reinterpret_cast< const char* >( data ),
+                      qint64( size )) == qint64( size );
+      }
+    }
+
+    CircuitSnapshot::CircuitSnapshot( void )
+    {
+      _reset( );
+    }
+
+    void CircuitSnapshot::_reset( void )
+    {
+      memset( &_summary, 0, sizeof( TSnapshotSummary ));
+      _columns = Array< TSnapshotGroup >( );
+      _miniColumns = Array< TSnapshotGroup >( );
+      _neurons = Array< TSnapshotNeuron >( );
+      _connections = Array< TSnapshotConnection >( );
+      _columnsStorage.clear( );
+      _miniColumnsStorage.clear( );
+      _neuronsStorage.clear( );
+      _connectionsStorage.clear( );
+      _file.reset( );
+    }
+
+    void CircuitSnapshot::set( const TSnapshotSummary& summary_,
+                               std::vector< TSnapshotGroup >&& columns_,
+                               std::vector< TSnapshotGroup >&& miniColumns_,
+                               std::vector< TSnapshotNeuron >&& neurons_,
+                               std::vector< TSnapshotConnection >&& connections_ )
+    {
+      _reset( );
+      _summary = summary_;
+      _columnsStorage = std::move( columns_ );
+      _miniColumnsStorage = std::move( miniColumns_ );
+      _neuronsStorage = std::move( neurons_ );
+      _connectionsStorage = std::move( connections_ );
+      _columns = Array< TSnapshotGroup >(
+        _columnsStorage.data( ), _columnsStorage.size( ));
+      _miniColumns = Array< TSnapshotGroup >(
+        _miniColumnsStorage.data( ), _miniColumnsStorage.size( ));
+      _neurons = Array< TSnapshotNeuron >(
+        _neuronsStorage.data( ), _neuronsStorage.size( ));
+      _connections = Array< TSnapshotConnection >(
+        _connectionsStorage.data( ), _connectionsStorage.size( ));
+    }
+
+    bool CircuitSnapshot::load( const std::string& fileName_,
+                                const std::string& key_ )
+    {
+      _reset( );
+
+      std::unique_ptr< QFile > file(
+        new QFile( QString::fromStdString( fileName_ )));
+      if ( !file->exists( ) || !file->open( QIODevice::ReadOnly ))
+        return false;
+
+      const uint64_t fileSize = uint64_t( file->size( ));
+      if ( fileSize < sizeof( TSnapshotHeader ))
+      {
+        Loggers::get( )->log( "Invalid snapshot " + fileName_,
+                              LOG_LEVEL_WARNING, NEUROSCHEME_FILE_LINE );
+        return false;
+      }
+
+      const uchar* data = file->map( 0, file->size( ));
+      if ( !data )
+      {
+        Loggers::get( )->log( "Snapshot " + fileName_ + " could not be mapped",
+                              LOG_LEVEL_WARNING, NEUROSCHEME_FILE_LINE );
+        return false;
+      }
+
+      TSnapshotHeader header;
+      memcpy( &header, data, sizeof( TSnapshotHeader ));
+      if ( strncmp( header.magic, SNAPSHOT_MAGIC, sizeof( header.magic )) != 0 ||
+           header.version != VERSION )
+      {
+        Loggers::get( )->log( "Ignoring snapshot " + fileName_ +
+                              " with unknown format or version",
+                              LOG_LEVEL_WARNING, NEUROSCHEME_FILE_LINE );
+        return false;
+      }
+
+      if ( header.keySize != key_.size( ) ||
+           sizeof( TSnapshotHeader ) + header.keySize > fileSize ||
+           memcmp( data + sizeof( TSnapshotHeader ), key_.data( ),
+                   key_.size( )) != 0 )
+      {
+        Loggers::get( )->log( "Ignoring outdated snapshot " + fileName_,
+                              LOG_LEVEL_VERBOSE, NEUROSCHEME_FILE_LINE );
+        return false;
+      }
+
+      const auto layout_ = layout( header );
+      if ( layout_.end != fileSize )
+      {
+        Loggers::get( )->log( "Ignoring truncated snapshot " + fileName_,
+                              LOG_LEVEL_WARNING, NEUROSCHEME_FILE_LINE );
+        return false;
+      }
+
+      memcpy( &_summary, data + layout_.summary, sizeof( TSnapshotSummary ));
+      _columns = Array< TSnapshotGroup >(
+        reinterpret_cast< const TSnapshotGroup* >( data + layout_.columns ),
+        header.numColumns );
+      _miniColumns = Array< TSnapshotGroup >(
+        reinterpret_cast< const TSnapshotGroup* >( data + layout_.miniColumns ),
+        header.numMiniColumns );
+      _neurons = Array< TSnapshotNeuron >(
+        reinterpret_cast< const TSnapshotNeuron* >( data + layout_.neurons ),
+        header.numNeurons );
+      _connections = Array< TSnapshotConnection >(
+        reinterpret_cast< const TSnapshotConnection* >(
+          data + layout_.connections ), header.numConnections );
+
+      // Ranges are trusted from here on, check them once
+      for ( const auto& column : _columns )
+        if ( uint64_t( column.first ) + column.size > _miniColumns.size( ))
+        {
+          _reset( );
+          return false;
+        }
+      for ( const auto& miniColumn : _miniColumns )
+        if ( uint64_t( miniColumn.first ) + miniColumn.size > _neurons.size( ))
+        {
+          _reset( );
+          return false;
+        }
+      for ( const auto& connection : _connections )
+        if ( connection.preNeuron >= _neurons.size( ) ||
+             connection.postNeuron >= _neurons.size( ))
+        {
+          _reset( );
+          return false;
+        }
+
+      // Keeps the mapping alive while the snapshot is used
+      _file = std::move( file );
+      return true;
+    }
+
+    bool CircuitSnapshot::write( const std::string& fileName_,
+                                 const std::string& key_ ) const
+    {
+      QDir( ).mkpath( QFileInfo( QString::fromStdString( fileName_ )).path( ));
+
+      // Written to a temporary file and renamed when done, so a failed or
+      // concurrent write never leaves a partial snapshot behind
+      QSaveFile file( QString::fromStdString( fileName_ ));
+      if ( !file.open( QIODevice::WriteOnly ))
+      {
+        Loggers::get( )->log( "Snapshot " + fileName_ + " could not be created",
+                              LOG_LEVEL_WARNING, NEUROSCHEME_FILE_LINE );
+        return false;
+      }
+
+      TSnapshotHeader header;
+      memset( &header, 0, sizeof( TSnapshotHeader ));
+      strncpy( header.magic, SNAPSHOT_MAGIC, sizeof( header.magic ));
+      header.version = VERSION;
+      header.keySize = uint32_t( key_.size( ));
+      header.numColumns = _columns.size( );
+      header.numMiniColumns = _miniColumns.size( );
+      header.numNeurons = _neurons.size( );
+      header.numConnections = _connections.size( );
+      const auto layout_ = layout( header );
+
+      if ( !writeAt( file, 0, &header, sizeof( TSnapshotHeader )) ||
+           !writeAt( file, layout_.key, key_.data( ), key_.size( )) ||
+           !writeAt( file, layout_.summary, &_summary,
+                     sizeof( TSnapshotSummary )) ||
+           !writeAt( file, layout_.columns, _columns.begin( ),
+                     _columns.size( ) * sizeof( TSnapshotGroup )) ||
+           !writeAt( file, layout_.miniColumns, _miniColumns.begin( ),
+                     _miniColumns.size( ) * sizeof( TSnapshotGroup )) ||
+           !writeAt( file, layout_.neurons, _neurons.begin( ),
+                     _neurons.size( ) * sizeof( TSnapshotNeuron )) ||
+           !writeAt( file, layout_.connections, _connections.begin( ),
+                     _connections.size( ) * sizeof( TSnapshotConnection )) ||
+           !file.commit( ))
+      {
+        Loggers::get( )->log( "Error writing snapshot " + fileName_,
+                              LOG_LEVEL_WARNING, NEUROSCHEME_FILE_LINE );
+        return false;
+      }
+      return true;
+    }
+
+    std::string CircuitSnapshot::key( const std::string& blueConfig,
+                                      const std::string& target,
+                                      bool withMorphologies,
+                                      const std::string& csvNeuronStatsFileName,
+                                      bool loadConnectivity )
+    {
+      const auto fileKey = [] ( const std::string& fileName_ )
+      {
+        if ( fileName_.empty( ))
+          return std::string( );
+        const QFileInfo info( QString::fromStdString( fileName_ ));
+        return info.absoluteFilePath( ).toStdString( ) + ":" +
+          std::to_string( info.lastModified( ).toMSecsSinceEpoch( ));
+      };
+
+      return "bc=" + fileKey( blueConfig ) +
+        "\ntarget=" + target +
+        "\nmorphologies=" + std::to_string( int( withMorphologies )) +
+        "\ncsv=" + fileKey( csvNeuronStatsFileName ) +
+        "\nconnectivity=" + std::to_string( int( loadConnectivity )) +
+        "\nstats=" + std::to_string( NSOL_NEURON_MORPHOLOGY_NUM_STATS );
+    }
+
+    std::string CircuitSnapshot::fileName( const std::string& cacheDirectory,
+                                           const std::string& key_ )
+    {
+      const auto hash = QCryptographicHash::hash(
+        QByteArray::fromStdString( key_ ), QCryptographicHash::Md5 ).toHex( );
+      return QDir( QString::fromStdString( cacheDirectory )).filePath(
+        QString::fromLatin1( hash ) + ".nscs" ).toStdString( );
+    }
+  } // namespace cortex
+} // namespace nslib
+
+#endif // NEUROSCHEME_USE_NSOL
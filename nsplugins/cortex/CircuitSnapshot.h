@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __NSLIB__CORTEX_CIRCUIT_SNAPSHOT__
+#define __NSLIB__CORTEX_CIRCUIT_SNAPSHOT__
+
+#include "NeuronsStatsLoader.h"
+#include <QFile>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef NEUROSCHEME_USE_NSOL
+
+namespace nslib
+{
+  namespace cortex
+  {
+    //! Neuron counts and mean stats shared by columns and minicolumns.
+    //! Per layer counts are indexed by layer - 1
+    typedef struct
+    {
+      uint32_t id;
+      uint32_t numNeurons;
+      uint32_t numPyramidals;
+      uint32_t numInterneurons;
+      uint32_t numPyramidalsPerLayer[ 6 ];
+      uint32_t numInterneuronsPerLayer[ 6 ];
+      float meanSomaVolume;
+      float meanSomaArea;
+      float meanDendsVolume;
+      float meanDendsArea;
+      float meanCenter[ 4 ];
+      //! Range of minicolumns for columns, of neurons for minicolumns
+      uint32_t first;
+      uint32_t size;
+    } TSnapshotGroup;
+
+    typedef struct
+    {
+      uint32_t gid;
+      uint32_t layer;
+      uint32_t morphologicalType;
+      uint32_t functionalType;
+      float position[ 4 ];
+      float stats[ NSOL_NEURON_MORPHOLOGY_NUM_STATS ];
+    } TSnapshotNeuron;
+
+    //! Synapses aggregated per pair of neurons, referenced by their index in
+    //! the snapshot neurons
+    typedef struct
+    {
+      uint32_t preNeuron;
+      uint32_t postNeuron;
+      uint32_t count;
+    } TSnapshotConnection;
+
+    //! Representation creator maximums and scene wide values
+    typedef struct
+    {
+      float maxSomaVolume;
+      float maxSomaArea;
+      float maxDendVolume;
+      float maxDendArea;
+      uint32_t numNeurons;
+      uint32_t maxNeuronsPerColumnLayer;
+      uint32_t maxNeuronsPerMiniColumnLayer;
+      uint32_t maxConnectionsPerNeuron;
+      //! Whether neurons have all their morphology stats
+      uint32_t hasStats;
+      uint32_t hasViewMatrix;
+      double viewMatrix[ 16 ];
+    } TSnapshotSummary;
+
+    //! Flat description of the columns, minicolumns, neurons and connectivity
+    //! of a BlueConfig target, from which the cortex entities are created.
+    //! It can be written to and loaded from a versioned binary file whose
+    //! arrays are used directly from the memory mapped file.
+    class CircuitSnapshot
+    {
+    public:
+
+      template < typename T >
+      class Array
+      {
+      public:
+        Array( void ) : _data( nullptr ), _size( 0 ) {}
+        Array( const T* data_, size_t size_ ) : _data( data_ ), _size( size_ ) {}
+        const T* begin( void ) const { return _data; }
+        const T* end( void ) const { return _data + _size; }
+        const T& operator[] ( size_t i ) const { return _data[ i ]; }
+        size_t size( void ) const { return _size; }
+        bool empty( void ) const { return _size == 0; }
+      protected:
+        const T* _data;
+        size_t _size;
+      };
+
+      static const uint32_t VERSION = 1;
+
+      CircuitSnapshot( void );
+
+      //! Takes ownership of the arrays filled while describing a circuit
+      void set( const TSnapshotSummary& summary,
+                std::vector< TSnapshotGroup >&& columns,
+                std::vector< TSnapshotGroup >&& miniColumns,
+                std::vector< TSnapshotNeuron >&& neurons,
+                std::vector< TSnapshotConnection >&& connections );
+
+      //! Maps fileName and uses it if its version and key match. Returns false
+      //! if the file does not exist or is not a valid snapshot for key
+      bool load( const std::string& fileName, const std::string& key );
+      bool write( const std::string& fileName, const std::string& key ) const;
+
+      //! Key identifying the data a snapshot was created from. It includes
+      //! the modification time of the BlueConfig and csv files
+      static std::string key( const std::string& blueConfig,
+                              const std::string& target,
+                              bool withMorphologies,
+                              const std::string& csvNeuronStatsFileName,
+                              bool loadConnectivity );
+      //! Snapshot file for key inside cacheDirectory
+      static std::string fileName( const std::string& cacheDirectory,
+                                   const std::string& key );
+
+      const TSnapshotSummary& summary( void ) const { return _summary; }
+      const Array< TSnapshotGroup >& columns( void ) const { return _columns; }
+      const Array< TSnapshotGroup >& miniColumns( void ) const
+      {
+        return _miniColumns;
+      }
+      const Array< TSnapshotNeuron >& neurons( void ) const { return _neurons; }
+      const Array< TSnapshotConnection >& connections( void ) const
+      {
+        return _connections;
+      }
+
+    protected:
+      void _reset( void );
+
+      TSnapshotSummary _summary;
+      Array< TSnapshotGroup > _columns;
+      Array< TSnapshotGroup > _miniColumns;
+      Array< TSnapshotNeuron > _neurons;
+      Array< TSnapshotConnection > _connections;
+
+      std::vector< TSnapshotGroup > _columnsStorage;
+      std::vector< TSnapshotGroup > _miniColumnsStorage;
+      std::vector< TSnapshotNeuron > _neuronsStorage;
+      std::vector< TSnapshotConnection > _connectionsStorage;
+      std::unique_ptr< QFile > _file;
+    };
+  }
+}
+
+#endif // NEUROSCHEME_USE_NSOL
+
+#endif
@@ -97,17 +97,17 @@ namespace nslib
         lineAnim.setDuration( ANIM_DURATION );
 
 
-        const auto originPosAnimStart = originItem->posAnim( ).startValue( ).toPointF( );
-        const auto originPosAnimEnd = originItem->posAnim( ).endValue( ).toPointF( );
-        const auto destPosAnimStart = destItem->posAnim( ).startValue( ).toPointF( );
-        const auto destPosAnimEnd = destItem->posAnim( ).endValue( ).toPointF( );
+        const auto originPosAnimStart = originItem->animation( ).startPos;
+        const auto originPosAnimEnd = originItem->animation( ).endPos;
+        const auto destPosAnimStart = destItem->animation( ).startPos;
+        const auto destPosAnimEnd = destItem->animation( ).endPos;
         const auto originWidth_2 =
           originRep->item( scene )->boundingRect( ).width( ) * 0.5f;
         const auto destWidth_2 =
           destRep->item( scene )->boundingRect( ).width( ) * 0.5f;
 
-        const auto& originScaleAnim = originItem->scaleAnim( );
-        const auto& destScaleAnim = destItem->scaleAnim( );
+        const auto& originScaleAnim = originItem->animation( );
+        const auto& destScaleAnim = destItem->animation( );
 
         const auto normAnimStart =
           QVector2D( destPosAnimStart - originPosAnimStart ).normalized( );
@@ -117,19 +117,19 @@ namespace nslib
 
         const auto destIniOri =
           QVector2D( originPosAnimStart ) + originWidth_2 *
-          originScaleAnim.startValue( ).toDouble( ) * normAnimStart;
+          originScaleAnim.startScale * normAnimStart;
 
         const auto destIniDest =
           QVector2D( destPosAnimStart ) - destWidth_2 *
-          originScaleAnim.startValue( ).toDouble( ) * normAnimStart;
+          originScaleAnim.startScale * normAnimStart;
 
         const auto destEndOri =
           QVector2D( originPosAnimEnd ) + originWidth_2 *
-          originScaleAnim.endValue( ).toDouble( ) * normAnimEnd;
+          originScaleAnim.endScale * normAnimEnd;
 
         const auto destEndDest =
           QVector2D( destPosAnimEnd ) - destWidth_2 *
-          destScaleAnim.endValue( ).toDouble( ) * normAnimEnd;
+          destScaleAnim.endScale * normAnimEnd;
 
 
         lineAnim.setStartValue(
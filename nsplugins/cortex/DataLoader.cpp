@@ -23,10 +23,15 @@
 #include <nslib/DataManager.h>
 #include <nslib/Loggers.h>
 #include <nslib/PaneManager.h>
+#include <nslib/ParallelFor.h>
 #include <nslib/RepresentationCreatorManager.h>
+#include "CircuitSnapshot.h"
 #include "Neuron.h"
+#include "NeuronsStatsLoader.h"
 #include "RepresentationCreator.h"
 #include <shift_ConnectsWith.h>
+#include <algorithm>
+#include <cstring>
 
 namespace nslib
 {
@@ -90,21 +95,84 @@ namespace nslib
           }
         }
 
-        Loggers::get( )->log( "Loading blue config",
-                              nslib::LOG_LEVEL_VERBOSE, NEUROSCHEME_FILE_LINE );
+        std::string snapshotCache;
+        for ( const auto& arg : { "-snc", "--snapshot-cache" })
+          if ( args.count( arg ) == 1 )
+          {
+            if ( args.at( arg ).size( ) != 1 )
+            {
+              Loggers::get( )->log( std::string( arg ) +
+                                    " expect one directory, but " +
+                                    std::to_string( args.at( arg ).size( )) +
+                                    " were found.",
+                                    LOG_LEVEL_CRITICAL, NEUROSCHEME_FILE_LINE );
+              return false;
+            }
+            snapshotCache = args.at( arg )[0];
+          }
 
-        nslib::DataManager::loadBlueConfig(
-          args.at( "-bc" )[0],
-          args.at( "-target" )[0],
-          args.count( "-nm" ) == 0 && args.count( "--no-morphologies" ) == 0,
-          ( args.count( "-cns" ) == 1 ? args.at( "-cns" )[0] : std::string( )),
-          args.count( "-lc" ) == 1 || args.count( "--load-connectivity" ) == 1 );
+        const auto& blueConfig = args.at( "-bc" )[0];
+        const auto& target = args.at( "-target" )[0];
+        const bool withMorphologies =
+          args.count( "-nm" ) == 0 && args.count( "--no-morphologies" ) == 0;
+        const std::string csvNeuronStatsFileName =
+          ( args.count( "-cns" ) == 1 ? args.at( "-cns" )[0] : std::string( ));
+        const bool loadConnectivity =
+          args.count( "-lc" ) == 1 || args.count( "--load-connectivity" ) == 1;
+
+        CircuitSnapshot snapshot;
+        std::string snapshotKey;
+        std::string snapshotFileName;
+        bool snapshotLoaded = false;
+        if ( !snapshotCache.empty( ))
+        {
+          snapshotKey = CircuitSnapshot::key(
+            blueConfig, target, withMorphologies, csvNeuronStatsFileName,
+            loadConnectivity );
+          snapshotFileName =
+            CircuitSnapshot::fileName( snapshotCache, snapshotKey );
+          snapshotLoaded = snapshot.load( snapshotFileName, snapshotKey );
+        }
 
-        createEntitiesFromNsolColumns(
-          nslib::DataManager::nsolDataSet( ).columns( ),
-          nslib::DataManager::nsolDataSet( ).circuit( ),
-          args.count( "-nm" ) == 0,
-          ( args.count( "-cns" ) == 1 ? args.at( "-cns" )[0] : std::string( )));
+        if ( snapshotLoaded )
+        {
+          Loggers::get( )->log( "Loading snapshot " + snapshotFileName,
+                                nslib::LOG_LEVEL_VERBOSE,
+                                NEUROSCHEME_FILE_LINE );
+        }
+        else
+        {
+          Loggers::get( )->log( "Loading blue config",
+                                nslib::LOG_LEVEL_VERBOSE,
+                                NEUROSCHEME_FILE_LINE );
+
+          if ( !nslib::DataManager::loadBlueConfig(
+                 blueConfig, target, withMorphologies, csvNeuronStatsFileName,
+                 loadConnectivity ))
+            return false;
+
+          describeNsolColumns(
+            nslib::DataManager::nsolDataSet( ).columns( ),
+            nslib::DataManager::nsolDataSet( ).circuit( ),
+            withMorphologies, csvNeuronStatsFileName, snapshot );
+
+          // Empty descriptions are not cached, as their key would keep
+          // pointing at them until the BlueConfig changes
+          if ( snapshot.neurons( ).empty( ))
+          {
+            Loggers::get( )->log( "No neurons found in target " + target,
+                                  LOG_LEVEL_ERROR, NEUROSCHEME_FILE_LINE );
+            return false;
+          }
+
+          if ( !snapshotFileName.empty( ) &&
+               snapshot.write( snapshotFileName, snapshotKey ))
+            Loggers::get( )->log( "Snapshot written to " + snapshotFileName,
+                                  nslib::LOG_LEVEL_VERBOSE,
+                                  NEUROSCHEME_FILE_LINE );
+        }
+
+        createEntitiesFromSnapshot( snapshot );
       }
 
       if ( args.count( "-xml" ) == 1 )
@@ -254,78 +322,63 @@ namespace nslib
       return shiftgen::Neuron::UNDEFINED_FUNCTIONAL_TYPE;
     }
 
+    template < typename TGroup >
+    void describeGroupCounts( const TGroup& group, TSnapshotGroup& snapshotGroup )
+    {
+      snapshotGroup.numNeurons = group->numberOfNeurons( false );
+      snapshotGroup.numPyramidals =
+        group->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL );
+      snapshotGroup.numInterneurons =
+        group->numberOfNeurons( false, nsol::Neuron::INTERNEURON );
+      for ( unsigned int layer = 1; layer < 7; ++layer )
+      {
+        snapshotGroup.numPyramidalsPerLayer[ layer - 1 ] =
+          group->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, layer );
+        snapshotGroup.numInterneuronsPerLayer[ layer - 1 ] =
+          group->numberOfNeurons( false, nsol::Neuron::INTERNEURON, layer );
+      }
+    }
+
     void DataLoader::createEntitiesFromNsolColumns(
       const nsol::Columns& columns,
       const nsol::Circuit& circuit,
       bool withMorphologies,
       const std::string& csvNeuronStatsFileName )
     {
-      Loggers::get( )->log( "Creating entities",
-                            nslib::LOG_LEVEL_VERBOSE, NEUROSCHEME_FILE_LINE );
-
-      auto& _entities = nslib::DataManager::entities( );
-      auto& _rootEntities = nslib::DataManager::rootEntities( );
-
-      _entities.clear( );
-
-      auto& relParentOf=
-        *( _entities.relationships( )[ "isParentOf" ]->asOneToN( ));
-      auto& relChildOf =
-        *( _entities.relationships( )[ "isChildOf" ]->asOneToOne( ));
-
-      auto& relGroupOf =
-        *( _entities.relationships( )[ "isAGroupOf" ]->asOneToN( ));
-      auto& relPartOf =
-        *( _entities.relationships( )[ "isPartOf" ]->asOneToN( ));
-
-      auto& relSuperEntityOf =
-        *( _entities.relationships( )[ "isSuperEntityOf" ]->asOneToN( ));
-      auto& relSubEntityOf =
-        *( _entities.relationships( )[ "isSubEntityOf" ]->asOneToOne( ));
+      CircuitSnapshot snapshot;
+      describeNsolColumns( columns, circuit, withMorphologies,
+                           csvNeuronStatsFileName, snapshot );
+      createEntitiesFromSnapshot( snapshot );
+    }
 
-      auto& relConnectsTo =
-        *( _entities.relationships( )[ "connectsTo" ]->asOneToN( ));
-      auto& relConnectedBy =
-        *( _entities.relationships( )[ "connectedBy" ]->asOneToN( ));
+    void DataLoader::describeNsolColumns(
+      const nsol::Columns& columns,
+      const nsol::Circuit& circuit,
+      bool withMorphologies,
+      const std::string& csvNeuronStatsFileName,
+      CircuitSnapshot& snapshot )
+    {
+      Loggers::get( )->log( "Describing circuit",
+                            nslib::LOG_LEVEL_VERBOSE, NEUROSCHEME_FILE_LINE );
 
-      assert( DataManager::entities( ).
-              relationships( ).count( "isSubEntityOf" ) == 1 );
-      std::set< unsigned int > gids;
-      std::unordered_map< unsigned int, shift::Entity* > neuronEntitiesByGid;
+      Bitmap gids;
       for ( const auto& col : columns )
         for ( const auto& mc : col->miniColumns( ))
           for ( const auto& neuron : mc->neurons( ))
-            gids.insert( neuron->gid( ));
+            gids.set( neuron->gid( ));
 
-      float maxNeuronSomaVolume = 0.0f;
-      float maxNeuronSomaArea = 0.0f;
-      float maxNeuronDendVolume = 0.0f;
-      float maxNeuronDendArea = 0.0f;
-      float maxNeuronAxonVolume = 0.0f;
-      float maxNeuronAxonArea = 0.0f;
+      TSnapshotSummary summary;
+      memset( &summary, 0, sizeof( TSnapshotSummary ));
+      summary.numNeurons = gids.count( );
+      summary.hasStats = ( withMorphologies || !csvNeuronStatsFileName.empty( ));
 
-      unsigned int  meanBifurcations = 0;
-      ( void ) meanBifurcations; // remove
       float meanSomaArea = .0f;
       float meanSomaVolume = .0f;
       float meanDendsArea = .0f;
       float meanDendsVolume = .0f;
 
-#define NSOL_NEURON_MORPHOLOGY_NUM_STATS                        \
-      nsol::NeuronMorphologyStats::NEURON_MORPHOLOGY_NUM_STATS
 #define NNMS nsol::NeuronMorphologyStats
 
-      typedef struct
-      {
-        float x, y, z;
-        uint8_t layer, column;
-        unsigned short miniColumn;
-        uint8_t mophoType, functType;
-        float somaMaxRadius;
-        float morphologyStats[NSOL_NEURON_MORPHOLOGY_NUM_STATS];
-      } TNeuronStats;
-
-      typedef std::unordered_map< unsigned int, TNeuronStats > TNeuronsStats;
       TNeuronsStats neuronsStats;
 
       if ( !csvNeuronStatsFileName.empty( ))
@@ -334,384 +387,435 @@ namespace nslib
                               csvNeuronStatsFileName, LOG_LEVEL_VERBOSE,
                               NEUROSCHEME_FILE_LINE );
 
-        std::ifstream csvNeuronStatsFile( csvNeuronStatsFileName );
-        if ( !csvNeuronStatsFile.is_open( ))
-        {
-          throw std::runtime_error( std::string( "File" ) +
-                                    csvNeuronStatsFileName +
-                                    std::string( " could not be opened"));
-        }
-
-        std::string line;
-        int lineCount = 0;
-        // skip first line
-        std::getline( csvNeuronStatsFile, line );
-        while ( std::getline( csvNeuronStatsFile, line ))
-        {
-          lineCount++;
-
-          if ( line[0] != '#' )
-          {
-            // Trim spaces
-            line.erase( line.find_last_not_of( " \r\t") +1 );
-            unsigned int fields =
-              1 + std::count_if( line.begin( ), line.end( ),
-                                 []( unsigned char c )
-                                 {
-                                   return ( c == ',' );
-                                 });
-
-            if ( fields != 26 )
-            {
-              Loggers::get( )->log(
-                std::string( "Skipping lineString " ) +
-                std::to_string( lineCount ) +
-                std::string( ". Expected 26 fields, but found " ) +
-                std::to_string( fields ) + ".",
-                nslib::LOG_LEVEL_WARNING, NEUROSCHEME_FILE_LINE);
-              continue;
-            }
-
-            std::istringstream iss( line );
-            unsigned int gid;
-            TNeuronStats stats;
-            char c;
-            iss >> gid >> c; assert( c == ',' );
-            iss >> stats.x >> c; assert( c == ',' );
-            iss >> stats.y >> c; assert( c == ',' );
-            iss >> stats.z >> c; assert( c == ',' );
-            iss >> stats.layer >> c; assert( c == ',' );;
-            iss >> stats.column >> c; assert( c == ',' );;
-            iss >> stats.miniColumn >> c; assert( c == ',' );
-            iss >> stats.mophoType >> c; assert( c == ',' );
-            iss >> stats.functType >> c; assert( c == ',' );
-            iss >> stats.somaMaxRadius;
-            for ( unsigned int statIdx = 0;
-                  statIdx < NSOL_NEURON_MORPHOLOGY_NUM_STATS;
-                  ++statIdx )
-            {
-              iss >> c; assert( c == ',' );
-              iss >> stats.morphologyStats[statIdx];
-            }
-
-            if ( gids.find( gid ) != gids.end( ))
-              neuronsStats[gid] = stats;
-
-          } // if not comment
-        } // while getline
-
-        unsigned long totalBifurcations = 0;
-        double totalSomaArea = .0f;
-        double totalSomaVolume = .0f;
-        double totalDendsArea = .0f;
-        double totalDendsVolume = .0f;
-
-        for ( const auto& neuronStats : neuronsStats )
-        {
-          totalBifurcations += ( unsigned long )
-            neuronStats.second.morphologyStats[NNMS::DENDRITIC_BIFURCATIONS];
-
-          const auto neuronSomaVolume =
-            neuronStats.second.morphologyStats[NNMS::SOMA_VOLUME];
-          if ( neuronSomaVolume > maxNeuronSomaVolume )
-            maxNeuronSomaVolume = neuronSomaVolume;
-          totalSomaVolume += neuronSomaVolume;
-
-          const auto neuronSomaArea =
-            neuronStats.second.morphologyStats[NNMS::SOMA_SURFACE];
-          if ( neuronSomaArea > maxNeuronSomaArea )
-            maxNeuronSomaArea = neuronSomaArea;
-          totalSomaArea += neuronSomaArea;
-
-          const auto neuronDendVolume =
-            neuronStats.second.morphologyStats[NNMS::DENDRITIC_VOLUME];
-          if ( neuronDendVolume > maxNeuronDendVolume )
-            maxNeuronDendVolume = neuronDendVolume;
-          totalDendsVolume += neuronDendVolume;
-
-          const auto neuronDendArea =
-            neuronStats.second.morphologyStats[NNMS::DENDRITIC_SURFACE];
-          if ( neuronDendArea > maxNeuronDendArea )
-            maxNeuronDendArea = neuronDendArea;
-          totalDendsArea += neuronDendArea;
-
-          const auto neuronAxonVolume =
-            neuronStats.second.morphologyStats[NNMS::AXON_VOLUME];
-          if ( neuronAxonVolume > maxNeuronAxonVolume )
-            maxNeuronAxonVolume = neuronAxonVolume;
-
-          const auto neuronAxonArea =
-            neuronStats.second.morphologyStats[NNMS::AXON_SURFACE];
-          if ( neuronAxonArea > maxNeuronAxonArea )
-            maxNeuronAxonArea = neuronAxonArea;
-        } // for all neurons
-
-        if ( neuronsStats.size( ) > 0 )
-        {
-          const float size_1 =  1.0f / float( neuronsStats.size( ));
-
-          meanSomaArea = totalSomaArea * size_1;
-          meanSomaVolume = totalSomaVolume * size_1;
-          meanDendsArea = totalDendsArea * size_1;
-          meanDendsVolume = totalDendsVolume * size_1;
-          meanBifurcations = totalBifurcations * size_1;
-        }
-
+        TNeuronsStatsSummary statsSummary;
+        NeuronsStatsLoader::load( csvNeuronStatsFileName, gids,
+                                  neuronsStats, statsSummary );
+
+        summary.maxSomaVolume = statsSummary.maxSomaVolume;
+        summary.maxSomaArea = statsSummary.maxSomaArea;
+        summary.maxDendVolume = statsSummary.maxDendVolume;
+        summary.maxDendArea = statsSummary.maxDendArea;
+        meanSomaArea = statsSummary.meanSomaArea;
+        meanSomaVolume = statsSummary.meanSomaVolume;
+        meanDendsArea = statsSummary.meanDendsArea;
+        meanDendsVolume = statsSummary.meanDendsVolume;
       } // if ( csvNeuronStatsFileName != "" )
 
       if ( withMorphologies && csvNeuronStatsFileName.empty( ))
       {
-
         for ( const auto& col : columns )
         {
           NSOL_DEBUG_CHECK( col->stats( ), "no stats in column" );
 
-          const float colMaxNeuronSomaVolume =
+          summary.maxSomaVolume = std::max< float >( summary.maxSomaVolume,
             col->stats( )->getStat( nsol::ColumnStats::SOMA_VOLUME,
                                     nsol::TAggregation::MAX,
-                                    nsol::TAggregation::MAX );
-
-          const float colMaxNeuronSomaArea =
+                                    nsol::TAggregation::MAX ));
+          summary.maxSomaArea = std::max< float >( summary.maxSomaArea,
             col->stats( )->getStat( nsol::ColumnStats::SOMA_SURFACE,
                                     nsol::TAggregation::MAX,
-                                    nsol::TAggregation::MAX );
-
-          const float colMaxNeuronDendVolume =
+                                    nsol::TAggregation::MAX ));
+          summary.maxDendVolume = std::max< float >( summary.maxDendVolume,
             col->stats( )->getStat( nsol::ColumnStats::DENDRITIC_VOLUME,
                                     nsol::TAggregation::MAX,
-                                    nsol::TAggregation::MAX );
-
-          const float colMaxNeuronDendArea =
+                                    nsol::TAggregation::MAX ));
+          summary.maxDendArea = std::max< float >( summary.maxDendArea,
             col->stats( )->getStat( nsol::ColumnStats::DENDRITIC_SURFACE,
                                     nsol::TAggregation::MAX,
-                                    nsol::TAggregation::MAX );
-
-          const float colMaxNeuronAxonVolume =
-            col->stats( )->getStat( nsol::ColumnStats::AXON_VOLUME,
-                                    nsol::TAggregation::MAX,
-                                    nsol::TAggregation::MAX );
-
-          const float colMaxNeuronAxonArea =
-            col->stats( )->getStat( nsol::ColumnStats::AXON_SURFACE,
-                                    nsol::TAggregation::MAX,
-                                    nsol::TAggregation::MAX );
-
-          if ( colMaxNeuronSomaVolume > maxNeuronSomaVolume )
-            maxNeuronSomaVolume = colMaxNeuronSomaVolume;
-          if ( colMaxNeuronSomaArea > maxNeuronSomaArea )
-            maxNeuronSomaArea = colMaxNeuronSomaArea;
-          if ( colMaxNeuronDendVolume > maxNeuronDendVolume )
-            maxNeuronDendVolume = colMaxNeuronDendVolume;
-          if ( colMaxNeuronDendArea > maxNeuronDendArea )
-            maxNeuronDendArea = colMaxNeuronDendArea;
-          if ( colMaxNeuronAxonVolume > maxNeuronAxonVolume )
-            maxNeuronAxonVolume = colMaxNeuronAxonVolume;
-          if ( colMaxNeuronAxonArea > maxNeuronAxonArea )
-            maxNeuronAxonArea = colMaxNeuronAxonArea;
-
+                                    nsol::TAggregation::MAX ));
         } // for all columns
-        // col->maxDendriteSurface( );
       } // if withMorphologies && csvNeuronStatsFileName.empty( )
 
-      //
-      // Create mappers
-      //
-      if ( withMorphologies || !csvNeuronStatsFileName.empty( ))
-      {
+      // Columns, minicolumns and neurons are flattened in order, so each one
+      // owns a row that can be filled in parallel below
+      std::vector< TSnapshotGroup > snapshotColumns( columns.size( ));
+      std::vector< TSnapshotGroup > snapshotMiniColumns;
+      std::vector< TSnapshotNeuron > snapshotNeurons;
+      std::vector< nsol::MiniColumnPtr > miniColumnPtrs;
+      std::vector< nsol::NeuronPtr > neuronPtrs;
+      neuronPtrs.reserve( summary.numNeurons );
 
-// #ifdef fdfdf
-// auto greenMapper = new DiscreteColorMapper( );
-//       auto redMapper = new DiscreteColorMapper( );
-
-#define ColorF( r, g, b )                       \
-        Color( uint8_t( roundf( r )),           \
-               uint8_t( roundf( g )),           \
-               uint8_t( roundf( b )))
-//       greenMapper->push_back( ColorF( 0.62f, 1.00f, 0.75f ));
-//       greenMapper->push_back( ColorF( 0.55f, 0.88f, 0.65f ));
-//       greenMapper->push_back( ColorF( 0.46f, 0.75f, 0.56f ));
-//       greenMapper->push_back( ColorF( 0.40f, 0.63f, 0.47f ));
-//       greenMapper->push_back( ColorF( 0.31f, 0.51f, 0.37f ));
-//       greenMapper->push_back( ColorF( 0.22f, 0.38f, 0.27f ));
-
-//       redMapper->push_back( ColorF( 1.00f, 0.62f, 0.75f ));
-//       redMapper->push_back( ColorF( 0.88f, 0.55f, 0.65f ));
-//       redMapper->push_back( ColorF( 0.75f, 0.46f, 0.56f ));
-//       redMapper->push_back( ColorF( 0.63f, 0.40f, 0.47f ));
-//       redMapper->push_back( ColorF( 0.51f, 0.31f, 0.37f ));
-//       redMapper->push_back( ColorF( 0.38f, 0.22f, 0.27f ));
-
-//       greenMapper->max( ) = maxNeuronSomaVolume;
-//       redMapper->max( ) = maxNeuronDendVolume;
-
-//       auto somaAreaToAngle =
-//         new MapperFloatToFloat( 0, maxNeuronSomaArea, 0, -360 );
-//       auto dendAreaToAngle =
-//         new MapperFloatToFloat( 0, maxNeuronDendArea, 0, -360 );
-// #endif
-      } // if morphologies || !csvNeuronStatsFileName.empty( )
-
-      // Compute maximums per layer for minicol and col reps
-      unsigned int maxNeuronsPerColumnLayer =
-        std::numeric_limits< unsigned int >::min( );
-      unsigned int maxNeuronsPerMiniColumnLayer =
-        std::numeric_limits< unsigned int >::min( );
-      for ( const auto& col : columns )
+      for ( size_t i = 0; i < columns.size( ); ++i )
       {
-        for ( unsigned int layer = 1; layer < 7; layer++ )
-        {
-          unsigned int numNeuronsPerColumnLayer = col->numberOfNeurons(
-            false, nsol::Neuron::PYRAMIDAL, layer );
-
-          if ( numNeuronsPerColumnLayer > maxNeuronsPerColumnLayer )
-            maxNeuronsPerColumnLayer = numNeuronsPerColumnLayer;
+        auto& column = snapshotColumns[ i ];
+        memset( &column, 0, sizeof( TSnapshotGroup ));
+        column.first = uint32_t( miniColumnPtrs.size( ));
+        column.size = uint32_t( columns[ i ]->miniColumns( ).size( ));
 
-          numNeuronsPerColumnLayer = col->numberOfNeurons(
-            false, nsol::Neuron::INTERNEURON, layer );
-
-          if ( numNeuronsPerColumnLayer > maxNeuronsPerColumnLayer )
-            maxNeuronsPerColumnLayer = numNeuronsPerColumnLayer;
-        }
-
-        for ( const auto miniCol : col->miniColumns( ))
+        for ( const auto& mc : columns[ i ]->miniColumns( ))
         {
-          for ( unsigned int layer = 1; layer < 7; layer++ )
-          {
-            unsigned int numNeuronsPerMiniColumnLayer = miniCol->numberOfNeurons(
-              false, nsol::Neuron::PYRAMIDAL, layer );
-
-            if ( numNeuronsPerMiniColumnLayer > maxNeuronsPerMiniColumnLayer )
-              maxNeuronsPerMiniColumnLayer = numNeuronsPerMiniColumnLayer;
-
-            numNeuronsPerMiniColumnLayer = miniCol->numberOfNeurons(
-              false, nsol::Neuron::INTERNEURON, layer );
-
-            if ( numNeuronsPerMiniColumnLayer > maxNeuronsPerMiniColumnLayer )
-              maxNeuronsPerMiniColumnLayer = numNeuronsPerMiniColumnLayer;
-          }
+          const auto& mcNeurons = mc->neurons( );
+          TSnapshotGroup miniColumn;
+          memset( &miniColumn, 0, sizeof( TSnapshotGroup ));
+          miniColumn.first = uint32_t( neuronPtrs.size( ));
+          miniColumn.size = uint32_t( mcNeurons.size( ));
+          snapshotMiniColumns.push_back( miniColumn );
+          miniColumnPtrs.push_back( mc );
+          neuronPtrs.insert( neuronPtrs.end( ),
+                             mcNeurons.begin( ), mcNeurons.end( ));
         }
       }
+      snapshotNeurons.resize( neuronPtrs.size( ));
 
-      int columnsCounter = 0;
-      for ( const auto& col : columns )
+      // Lookups must not insert, as they are done from several threads
+      const auto neuronStats = [ & ]( unsigned int gid ) -> const float*
+      {
+        static const TNeuronStats noStats = TNeuronStats( );
+        const auto stats = neuronsStats.find( gid );
+        return ( stats == neuronsStats.end( ) ? noStats : stats->second )
+          .morphologyStats;
+      };
+
+      // Group means are taken from the csv stats of its range of neurons. If
+      // there are none, the means of the whole circuit are kept
+      const bool csvStats = !csvNeuronStatsFileName.empty( );
+      const auto describeGroupMeans = [ & ]( size_t firstNeuron,
+                                             size_t numNeurons,
+                                             TSnapshotGroup& group )
       {
+        group.meanSomaVolume = meanSomaVolume;
+        group.meanSomaArea = meanSomaArea;
+        group.meanDendsVolume = meanDendsVolume;
+        group.meanDendsArea = meanDendsArea;
+        if ( !csvStats || neuronsStats.empty( ))
+          return;
 
-        unsigned long totalBifurcations = 0;
         double totalSomaArea = .0f;
         double totalSomaVolume = .0f;
         double totalDendsArea = .0f;
         double totalDendsVolume = .0f;
-        unsigned int numNeurons = 0;
-        Eigen::Vector4f meanCenter( 0.f, 0.f, 0.f, 0.f );
+        for ( size_t i = firstNeuron; i < firstNeuron + numNeurons; ++i )
+        {
+          const auto stats = neuronStats( neuronPtrs[ i ]->gid( ));
+          totalSomaVolume += stats[ NNMS::SOMA_VOLUME ];
+          totalSomaArea += stats[ NNMS::SOMA_SURFACE ];
+          totalDendsVolume += stats[ NNMS::DENDRITIC_VOLUME ];
+          totalDendsArea += stats[ NNMS::DENDRITIC_SURFACE ];
+        }
+        const float size_1 =  1.0f / float( numNeurons );
+        group.meanSomaArea = totalSomaArea * size_1;
+        group.meanSomaVolume = totalSomaVolume * size_1;
+        group.meanDendsArea = totalDendsArea * size_1;
+        group.meanDendsVolume = totalDendsVolume * size_1;
+      };
+
+      // Parallel phase: counts, centers, csv means and neuron rows. Every
+      // task only writes its own rows
+      std::vector< Eigen::Vector4f > columnExtents( columns.size( ));
+      parallelFor( columns.size( ), parallelChunks( columns.size( ), 1 ),
+        [ & ]( size_t begin, size_t end, unsigned int )
+        {
+          for ( size_t i = begin; i < end; ++i )
+          {
+            auto& column = snapshotColumns[ i ];
+            column.id = columns[ i ]->id( );
+            describeGroupCounts( columns[ i ], column );
 
+            size_t firstNeuron = neuronPtrs.size( );
+            size_t numNeurons = 0;
+            if ( column.size > 0 )
+            {
+              firstNeuron = snapshotMiniColumns[ column.first ].first;
+              const auto& lastMiniColumn =
+                snapshotMiniColumns[ column.first + column.size - 1 ];
+              numNeurons = lastMiniColumn.first + lastMiniColumn.size -
+                firstNeuron;
+            }
 
-        Eigen::AlignedBox4f boundingBox;
-        unsigned int counter = 0;
-        for ( const auto& mc : col->miniColumns( ))
-          for ( const auto& neuron : mc->neurons( ))
+            Eigen::Vector4f meanCenter( 0.f, 0.f, 0.f, 0.f );
+            Eigen::AlignedBox4f boundingBox;
+            for ( size_t n = firstNeuron; n < firstNeuron + numNeurons; ++n )
+            {
+              meanCenter += neuronPtrs[ n ]->transform( ).col( 3 ).transpose( );
+              boundingBox.extend( neuronPtrs[ n ]->transform( ).col( 3 ));
+            }
+            if ( numNeurons > 0 )
+              meanCenter /= numNeurons;
+            Eigen::Map< Eigen::Vector4f >( column.meanCenter ) = meanCenter;
+            columnExtents[ i ] = boundingBox.max( ) - boundingBox.min( );
+
+            describeGroupMeans( firstNeuron, numNeurons, column );
+          }
+        });
+
+      parallelFor( miniColumnPtrs.size( ),
+                   parallelChunks( miniColumnPtrs.size( ), 16 ),
+        [ & ]( size_t begin, size_t end, unsigned int )
+        {
+          for ( size_t i = begin; i < end; ++i )
           {
-            meanCenter += neuron->transform( ).col( 3 ).transpose( );
-            ++counter;
-            boundingBox.extend( neuron->transform( ).col( 3 ));
+            auto& miniColumn = snapshotMiniColumns[ i ];
+            miniColumn.id = miniColumnPtrs[ i ]->id( );
+            describeGroupCounts( miniColumnPtrs[ i ], miniColumn );
+
+            Eigen::Vector4f mcMeanCenter( 0.f, 0.f, 0.f, 0.f );
+            for ( const auto& neuron : miniColumnPtrs[ i ]->neurons( ))
+              mcMeanCenter += neuron->transform( ).col( 3 ).transpose( );
+            if ( miniColumn.size > 0 )
+              mcMeanCenter /= miniColumn.size;
+            Eigen::Map< Eigen::Vector4f >( miniColumn.meanCenter ) =
+              mcMeanCenter;
+
+            describeGroupMeans( miniColumn.first, miniColumn.size, miniColumn );
           }
-        if ( counter > 0 )
-          meanCenter /= counter;
+        });
 
-        const auto maxMin = boundingBox.max( ) - boundingBox.min( );
+      parallelFor( neuronPtrs.size( ), parallelChunks( neuronPtrs.size( )),
+        [ & ]( size_t begin, size_t end, unsigned int )
+        {
+          for ( size_t i = begin; i < end; ++i )
+          {
+            const auto& neuron = neuronPtrs[ i ];
+            auto& snapshotNeuron = snapshotNeurons[ i ];
+            memset( &snapshotNeuron, 0, sizeof( TSnapshotNeuron ));
+            snapshotNeuron.gid = neuron->gid( );
+            snapshotNeuron.layer = neuron->layer( );
+            snapshotNeuron.morphologicalType =
+              nsolToShiftMorphologicalType( neuron->morphologicalType( ));
+            snapshotNeuron.functionalType =
+              nsolToShiftFunctionalType( neuron->functionalType( ));
+            Eigen::Map< Eigen::Vector4f >( snapshotNeuron.position ) =
+              neuron->transform( ).col( 3 );
+
+            if ( csvStats )
+              memcpy( snapshotNeuron.stats, neuronStats( snapshotNeuron.gid ),
+                      sizeof( snapshotNeuron.stats ));
+          }
+        });
+
+      // Sequential phase: maximums, view matrix and nsol stats. The latter
+      // are kept out of the thread pool because nsol caches them in objects
+      // that neurons sharing a morphology also share
+      for ( const auto& column : snapshotColumns )
+        for ( unsigned int layer = 0; layer < 6; ++layer )
+          summary.maxNeuronsPerColumnLayer = std::max(
+            { summary.maxNeuronsPerColumnLayer,
+              column.numPyramidalsPerLayer[ layer ],
+              column.numInterneuronsPerLayer[ layer ] });
+
+      for ( const auto& miniColumn : snapshotMiniColumns )
+        for ( unsigned int layer = 0; layer < 6; ++layer )
+          summary.maxNeuronsPerMiniColumnLayer = std::max(
+            { summary.maxNeuronsPerMiniColumnLayer,
+              miniColumn.numPyramidalsPerLayer[ layer ],
+              miniColumn.numInterneuronsPerLayer[ layer ] });
+
+      // The view matrix frames the last column
+      if ( !columnExtents.empty( ))
+      {
+        const auto& maxMin = columnExtents.back( );
         const double matrix[ 16 ]  = { 1, 0, 0, 0,
                                        0, 1, 0, 0,
                                        0, 0, 1, 0,
                                  - maxMin.x( ) / 2,
                                  - maxMin.y( ) / 2,
                                  - maxMin.y( ) * 1.5, 1 };
-        PaneManager::setViewMatrix( matrix );
+        memcpy( summary.viewMatrix, matrix, sizeof( matrix ));
+        summary.hasViewMatrix = 1;
+      }
 
-        if ( !csvNeuronStatsFileName.empty( ))
-        {
-          for ( const auto& mc : col->miniColumns( ))
-          {
-            for ( const auto& neuron : mc->neurons( ))
-            {
-              const auto gid = neuron->gid( );
-              numNeurons++;
-              totalBifurcations += ( unsigned long )
-                neuronsStats[gid].morphologyStats[NNMS::DENDRITIC_BIFURCATIONS];
-              totalSomaVolume +=
-                neuronsStats[gid].morphologyStats[NNMS::SOMA_VOLUME];
-              totalSomaArea +=
-                neuronsStats[gid].morphologyStats[NNMS::SOMA_SURFACE];
-              totalDendsVolume +=
-                neuronsStats[gid].morphologyStats[NNMS::DENDRITIC_VOLUME];
-              totalDendsArea +=
-                neuronsStats[gid].morphologyStats[NNMS::DENDRITIC_SURFACE];
-            }
-          }
-          if ( neuronsStats.size( ) > 0 )
-          {
-            const float size_1 =  1.0f / float( numNeurons );
-            meanSomaArea = totalSomaArea * size_1;
-            meanSomaVolume = totalSomaVolume * size_1;
-            meanDendsArea = totalDendsArea * size_1;
-            meanDendsVolume = totalDendsVolume * size_1;
-            meanBifurcations = totalBifurcations * size_1;
-          }
-        } // if stats loaded from file
-        else if ( withMorphologies )
+      if ( withMorphologies && !csvStats )
+      {
+        for ( size_t i = 0; i < columns.size( ); ++i )
         {
-          meanSomaArea = col->stats( )->getStat(
+          auto& column = snapshotColumns[ i ];
+          column.meanSomaArea = columns[ i ]->stats( )->getStat(
             nsol::ColumnStats::SOMA_SURFACE,
             nsol::TAggregation::MEAN,
             nsol::TAggregation::MEAN );
-          meanSomaVolume = col->stats( )->getStat(
+          column.meanSomaVolume = columns[ i ]->stats( )->getStat(
             nsol::ColumnStats::SOMA_VOLUME,
             nsol::TAggregation::MEAN,
             nsol::TAggregation::MEAN );
-          meanDendsArea = col->stats( )->getStat(
+          column.meanDendsArea = columns[ i ]->stats( )->getStat(
             nsol::ColumnStats::DENDRITIC_SURFACE,
             nsol::TAggregation::MEAN,
             nsol::TAggregation::MEAN );
-          meanDendsVolume = col->stats( )->getStat(
+          column.meanDendsVolume = columns[ i ]->stats( )->getStat(
             nsol::ColumnStats::DENDRITIC_VOLUME,
             nsol::TAggregation::MEAN,
             nsol::TAggregation::MEAN );
         }
 
+        for ( size_t i = 0; i < miniColumnPtrs.size( ); ++i )
+        {
+          auto& miniColumn = snapshotMiniColumns[ i ];
+          miniColumn.meanSomaArea = miniColumnPtrs[ i ]->stats( )->getStat(
+            nsol::MiniColumnStats::SOMA_SURFACE,
+            nsol::TAggregation::MEAN );
+          miniColumn.meanSomaVolume = miniColumnPtrs[ i ]->stats( )->getStat(
+            nsol::MiniColumnStats::SOMA_VOLUME,
+            nsol::TAggregation::MEAN );
+          miniColumn.meanDendsArea = miniColumnPtrs[ i ]->stats( )->getStat(
+            nsol::MiniColumnStats::DENDRITIC_SURFACE,
+            nsol::TAggregation::MEAN );
+          miniColumn.meanDendsVolume = miniColumnPtrs[ i ]->stats( )->getStat(
+            nsol::MiniColumnStats::DENDRITIC_VOLUME,
+            nsol::TAggregation::MEAN );
+        }
+
+        for ( size_t i = 0; i < neuronPtrs.size( ); ++i )
+        {
+          assert( neuronPtrs[ i ]->morphology( ) &&
+                  neuronPtrs[ i ]->morphology( )->stats( ));
+          nsol::NeuronMorphologyStats* nms =
+            neuronPtrs[ i ]->morphology( )->stats( );
+          for ( int stat_ = 0; stat_ < NSOL_NEURON_MORPHOLOGY_NUM_STATS; ++stat_ )
+            snapshotNeurons[ i ].stats[ stat_ ] = nms->getStat(
+              nsol::NeuronMorphologyStats::TNeuronMorphologyStat( stat_ ));
+        }
+      }
+
+      // Circuit GIDs are dense, so neuron indices are looked up in a vector
+      static const uint32_t NO_NEURON = 0xFFFFFFFF;
+      uint32_t maxGid = 0;
+      for ( const auto& neuron : snapshotNeurons )
+        maxGid = std::max( maxGid, neuron.gid );
+      std::vector< uint32_t > neuronIndexByGid(
+        snapshotNeurons.empty( ) ? 0 : size_t( maxGid ) + 1, NO_NEURON );
+      for ( size_t i = 0; i < snapshotNeurons.size( ); ++i )
+        neuronIndexByGid[ snapshotNeurons[ i ].gid ] = uint32_t( i );
+      const auto neuronIndex = [ & ]( unsigned int gid )
+      {
+        return gid < neuronIndexByGid.size( ) ?
+          neuronIndexByGid[ gid ] : NO_NEURON;
+      };
+
+      // Synapses become ( pre, post ) neuron index pairs, gathered in
+      // parallel and sorted so the synapses of each connection are a run
+      const auto& synapses =
+        circuit.synapses( nsol::Circuit::PRESYNAPTICCONNECTIONS );
+      const auto numChunks = parallelChunks( synapses.size( ));
+      std::vector< std::vector< uint64_t >> chunkPairs( numChunks );
+      parallelFor( synapses.size( ), numChunks,
+        [ & ]( size_t begin, size_t end, unsigned int chunk )
+        {
+          auto& pairs = chunkPairs[ chunk ];
+          pairs.reserve( end - begin );
+          for ( size_t i = begin; i < end; ++i )
+          {
+            const auto preIndex =
+              neuronIndex( synapses[ i ]->preSynapticNeuron( ));
+            const auto postIndex =
+              neuronIndex( synapses[ i ]->postSynapticNeuron( ));
+            // Synapses with neurons out of the target
+            if ( preIndex == NO_NEURON || postIndex == NO_NEURON )
+              continue;
+            pairs.push_back( ( uint64_t( preIndex ) << 32 ) | postIndex );
+          }
+        });
+
+      std::vector< uint64_t > pairs;
+      size_t numPairs = 0;
+      for ( const auto& chunkPairs_ : chunkPairs )
+        numPairs += chunkPairs_.size( );
+      pairs.reserve( numPairs );
+      for ( auto& chunkPairs_ : chunkPairs )
+      {
+        pairs.insert( pairs.end( ), chunkPairs_.begin( ), chunkPairs_.end( ));
+        std::vector< uint64_t >( ).swap( chunkPairs_ );
+      }
+      parallelSort( pairs );
+
+      std::vector< TSnapshotConnection > snapshotConnections;
+      for ( size_t first = 0; first < pairs.size( ); )
+      {
+        size_t last = first + 1;
+        while ( last < pairs.size( ) && pairs[ last ] == pairs[ first ] )
+          ++last;
+        const auto count = uint32_t( last - first );
+        // Maximum among the connections with more than one synapse
+        if ( count > 1 && count > summary.maxConnectionsPerNeuron )
+          summary.maxConnectionsPerNeuron = count;
+        snapshotConnections.push_back( { uint32_t( pairs[ first ] >> 32 ),
+          uint32_t( pairs[ first ] & 0xFFFFFFFF ), count });
+        first = last;
+      }
+
+      snapshot.set( summary, std::move( snapshotColumns ),
+                    std::move( snapshotMiniColumns ),
+                    std::move( snapshotNeurons ),
+                    std::move( snapshotConnections ));
+    }
+
+    void DataLoader::createEntitiesFromSnapshot(
+      const CircuitSnapshot& snapshot )
+    {
+      Loggers::get( )->log( "Creating entities",
+                            nslib::LOG_LEVEL_VERBOSE, NEUROSCHEME_FILE_LINE );
+
+      auto& _entities = nslib::DataManager::entities( );
+      auto& _rootEntities = nslib::DataManager::rootEntities( );
+
+      _entities.clear( );
+
+      auto& relParentOf=
+        *( _entities.relationships( )[ "isParentOf" ]->asOneToN( ));
+      auto& relChildOf =
+        *( _entities.relationships( )[ "isChildOf" ]->asOneToOne( ));
+
+      auto& relGroupOf =
+        *( _entities.relationships( )[ "isAGroupOf" ]->asOneToN( ));
+      auto& relPartOf =
+        *( _entities.relationships( )[ "isPartOf" ]->asOneToN( ));
+
+      auto& relSuperEntityOf =
+        *( _entities.relationships( )[ "isSuperEntityOf" ]->asOneToN( ));
+      auto& relSubEntityOf =
+        *( _entities.relationships( )[ "isSubEntityOf" ]->asOneToOne( ));
+
+      auto& relConnectsTo =
+        *( _entities.relationships( )[ "connectsTo" ]->asOneToN( ));
+      auto& relConnectedBy =
+        *( _entities.relationships( )[ "connectedBy" ]->asOneToN( ));
+
+      assert( DataManager::entities( ).
+              relationships( ).count( "isSubEntityOf" ) == 1 );
+
+      const auto& summary = snapshot.summary( );
+      if ( summary.hasViewMatrix )
+        PaneManager::setViewMatrix( summary.viewMatrix );
+
+      const auto& neurons = snapshot.neurons( );
+      std::vector< shift::Entity* > neuronEntities( neurons.size( ), nullptr );
 
+      for ( const auto& col : snapshot.columns( ))
+      {
         shift::Entity* colEntity =
           new Column(
-            "c" + std::to_string( uint( col->id( ))),
-            uint( col->id( )), // Id
+            "c" + std::to_string( uint( col.id )),
+            uint( col.id ), // Id
             0, // Num Minicolumns
-            col->numberOfNeurons( false ),
+            col.numNeurons,
             0, // Num Neurons Mean
             0, // Num Neurons Max
             0, // Num Neurons Min
-            col->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL ),
-            col->numberOfNeurons( false, nsol::Neuron::INTERNEURON ),
-            col->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 1 ),
-            col->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 2 ),
-            col->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 3 ),
-            col->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 4 ),
-            col->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 5 ),
-            col->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 6 ),
-            col->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 1 ),
-            col->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 2 ),
-            col->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 3 ),
-            col->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 4 ),
-            col->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 5 ),
-            col->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 6 ),
-            meanSomaVolume,
-            meanSomaArea,
-            meanDendsVolume,
-            meanDendsArea,
-            meanCenter );
+            col.numPyramidals,
+            col.numInterneurons,
+            col.numPyramidalsPerLayer[ 0 ],
+            col.numPyramidalsPerLayer[ 1 ],
+            col.numPyramidalsPerLayer[ 2 ],
+            col.numPyramidalsPerLayer[ 3 ],
+            col.numPyramidalsPerLayer[ 4 ],
+            col.numPyramidalsPerLayer[ 5 ],
+            col.numInterneuronsPerLayer[ 0 ],
+            col.numInterneuronsPerLayer[ 1 ],
+            col.numInterneuronsPerLayer[ 2 ],
+            col.numInterneuronsPerLayer[ 3 ],
+            col.numInterneuronsPerLayer[ 4 ],
+            col.numInterneuronsPerLayer[ 5 ],
+            col.meanSomaVolume,
+            col.meanSomaArea,
+            col.meanDendsVolume,
+            col.meanDendsArea,
+            Eigen::Vector4f( col.meanCenter ));
 
         shift::Entity* colLayerEntities[ 6 ];
         for ( auto i = 0; i < 6; ++i )
         {
           auto layerEntity = new Layer;
           layerEntity->registerProperty( "Parent gid", uint( colEntity->entityGid( )));
-          layerEntity->registerProperty( "Parent Id", uint( col->id( )));
+          layerEntity->registerProperty( "Parent Id", uint( col.id ));
           layerEntity->registerProperty( "Parent Type",
                                          Layer::TLayerParentType::COLUMN);
           layerEntity->registerProperty( "Layer", uint( i+1 ));
@@ -722,7 +826,7 @@ namespace nslib
             colEntity->entityGid( );
           _entities.add( layerEntity );
 
-          layerEntity->setProperty( "Name", "c" + std::to_string( uint( col->id( ))) +
+          layerEntity->setProperty( "Name", "c" + std::to_string( uint( col.id )) +
             "l" + std::to_string( i ));
 
         }
@@ -733,7 +837,7 @@ namespace nslib
         {
           auto neuronTypeAggregationEntity =
             new NeuronTypeAggregation(
-              colEntity->entityGid( ), uint( col->id( )),
+              colEntity->entityGid( ), uint( col.id ),
               Layer::TLayerParentType::COLUMN, uint( i ),
               Neuron::TMorphologicalType::PYRAMIDAL );
           colNeuronTypeAggregationEntities[ i ] = neuronTypeAggregationEntity;
@@ -743,11 +847,11 @@ namespace nslib
           _entities.add( neuronTypeAggregationEntity );
 
           neuronTypeAggregationEntity->setProperty( "Name", "c" +
-            std::to_string( uint( col->id( ))) + "p" + std::to_string( i ));
+            std::to_string( uint( col.id )) + "p" + std::to_string( i ));
 
           neuronTypeAggregationEntity =
             new NeuronTypeAggregation(
-              colEntity->entityGid( ), uint( col->id( )),
+              colEntity->entityGid( ), uint( col.id ),
               Layer::TLayerParentType::COLUMN, uint( i ),
               Neuron::INTERNEURON );
           colNeuronTypeAggregationEntities[ i + 7 ] = neuronTypeAggregationEntity;
@@ -757,7 +861,7 @@ namespace nslib
           _entities.add( neuronTypeAggregationEntity );
 
           neuronTypeAggregationEntity->setProperty( "Name", "c" +
-            std::to_string( uint( col->id( ))) + "i" + std::to_string( i ));
+            std::to_string( uint( col.id )) + "i" + std::to_string( i ));
         }
 
         _entities.add( colEntity );
@@ -765,100 +869,35 @@ namespace nslib
                                                  nullptr));
         relChildOf[ colEntity->entityGid( ) ].entity = 0 ;
 
-        nsol::MiniColumns& miniCols = col->miniColumns( );
-        int miniColumnsCounter = 0;
-        for ( const auto& mc : miniCols )
+        for ( auto mcIndex = col.first; mcIndex < col.first + col.size;
+              ++mcIndex )
         {
-
-          Eigen::Vector4f mcMeanCenter( 0.f, 0.f, 0.f, 0.f );
-
-          unsigned int mcNeuronCounter = 0;
-          for ( const auto& neuron : mc->neurons( ))
-          {
-            mcMeanCenter += neuron->transform( ).col( 3 ).transpose( );
-            ++mcNeuronCounter;
-          }
-          if ( counter > 0 )
-            mcMeanCenter /= mcNeuronCounter;
-
-          unsigned long totalMiniColBifurcations = 0;
-          double totalMiniColSomaArea = .0f;
-          double totalMiniColSomaVolume = .0f;
-          double totalMiniColDendsArea = .0f;
-          double totalMiniColDendsVolume = .0f;
-          unsigned int numMiniColNeurons = 0;
-          if ( !csvNeuronStatsFileName.empty( ))
-          {
-            for ( auto neu : mc->neurons( ))
-            {
-              auto gid = neu->gid( );
-              numMiniColNeurons++;
-              totalMiniColBifurcations += ( unsigned long )
-                neuronsStats[gid].morphologyStats[NNMS::DENDRITIC_BIFURCATIONS];
-              totalMiniColSomaVolume +=
-                neuronsStats[gid].morphologyStats[NNMS::SOMA_VOLUME];
-              totalMiniColSomaArea +=
-                neuronsStats[gid].morphologyStats[NNMS::SOMA_SURFACE];
-              totalMiniColDendsVolume +=
-                neuronsStats[gid].morphologyStats[NNMS::DENDRITIC_VOLUME];
-              totalMiniColDendsArea +=
-                neuronsStats[gid].morphologyStats[NNMS::DENDRITIC_SURFACE];
-            }
-
-            if ( neuronsStats.size( ) > 0 )
-            {
-              const float size_1 =  1.0f / float( numMiniColNeurons );
-
-              meanSomaArea = totalMiniColSomaArea * size_1;
-              meanSomaVolume = totalMiniColSomaVolume * size_1;
-              meanDendsArea = totalMiniColDendsArea * size_1;
-              meanDendsVolume = totalMiniColDendsVolume * size_1;
-              meanBifurcations = totalMiniColBifurcations * size_1;
-            }
-          }
-          else
-          {
-            if ( withMorphologies )
-            {
-              meanSomaArea = mc->stats( )->getStat(
-                nsol::MiniColumnStats::SOMA_SURFACE,
-                nsol::TAggregation::MEAN );
-              meanSomaVolume = mc->stats( )->getStat(
-                nsol::MiniColumnStats::SOMA_VOLUME,
-                nsol::TAggregation::MEAN );
-              meanDendsArea = mc->stats( )->getStat(
-                nsol::MiniColumnStats::DENDRITIC_SURFACE,
-                nsol::TAggregation::MEAN );
-              meanDendsVolume = mc->stats( )->getStat(
-                nsol::MiniColumnStats::DENDRITIC_VOLUME,
-                nsol::TAggregation::MEAN );
-            }
-          }
+          const auto& mc = snapshot.miniColumns( )[ mcIndex ];
 
           shift::Entity* mcEntity =
             new MiniColumn(
-              "mc" + std::to_string( uint( mc->id( ))),
-              mc->id( ),
-              mc->numberOfNeurons( false ),
-              mc->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL ),
-              mc->numberOfNeurons( false, nsol::Neuron::INTERNEURON ),
-              mc->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 1 ),
-              mc->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 2 ),
-              mc->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 3 ),
-              mc->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 4 ),
-              mc->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 5 ),
-              mc->numberOfNeurons( false, nsol::Neuron::PYRAMIDAL, 6 ),
-              mc->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 1 ),
-              mc->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 2 ),
-              mc->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 3 ),
-              mc->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 4 ),
-              mc->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 5 ),
-              mc->numberOfNeurons( false, nsol::Neuron::INTERNEURON, 6 ),
-              meanSomaVolume,
-              meanSomaArea,
-              meanDendsVolume,
-              meanDendsArea,
-              mcMeanCenter );
+              "mc" + std::to_string( uint( mc.id )),
+              mc.id,
+              mc.numNeurons,
+              mc.numPyramidals,
+              mc.numInterneurons,
+              mc.numPyramidalsPerLayer[ 0 ],
+              mc.numPyramidalsPerLayer[ 1 ],
+              mc.numPyramidalsPerLayer[ 2 ],
+              mc.numPyramidalsPerLayer[ 3 ],
+              mc.numPyramidalsPerLayer[ 4 ],
+              mc.numPyramidalsPerLayer[ 5 ],
+              mc.numInterneuronsPerLayer[ 0 ],
+              mc.numInterneuronsPerLayer[ 1 ],
+              mc.numInterneuronsPerLayer[ 2 ],
+              mc.numInterneuronsPerLayer[ 3 ],
+              mc.numInterneuronsPerLayer[ 4 ],
+              mc.numInterneuronsPerLayer[ 5 ],
+              mc.meanSomaVolume,
+              mc.meanSomaArea,
+              mc.meanDendsVolume,
+              mc.meanDendsArea,
+              Eigen::Vector4f( mc.meanCenter ));
 
           shift::Entity* mcLayerEntities[ 6 ];
           for ( auto i = 0; i < 6; ++i )
@@ -866,7 +905,7 @@ namespace nslib
             auto layerEntity = new Layer;
             layerEntity->registerProperty( "Parent gid",
                                            uint( mcEntity->entityGid( )));
-            layerEntity->registerProperty( "Parent Id", uint( mc->id( )));
+            layerEntity->registerProperty( "Parent Id", uint( mc.id ));
             layerEntity->registerProperty( "Parent Type",
                                            Layer::TLayerParentType::MINICOLUMN );
             layerEntity->registerProperty( "Layer", uint( i+1 ));
@@ -878,7 +917,7 @@ namespace nslib
             _entities.add( layerEntity );
 
             layerEntity->setProperty( "Name", "mc" +
-             std::to_string( uint( mc->id( ))) + "l" + std::to_string( i + 1 ));
+             std::to_string( uint( mc.id )) + "l" + std::to_string( i + 1 ));
           }
 
           // Pos 0 and 7 will be used for whole minicolumn
@@ -887,7 +926,7 @@ namespace nslib
           {
             auto neuronTypeAggregationEntity =
               new NeuronTypeAggregation(
-                mcEntity->entityGid( ), uint( mc->id( )),
+                mcEntity->entityGid( ), uint( mc.id ),
                 Layer::TLayerParentType::MINICOLUMN, uint( i ),
                 Neuron::TMorphologicalType::PYRAMIDAL );
             mcNeuronTypeAggregationEntities[ i ] = neuronTypeAggregationEntity;
@@ -897,11 +936,11 @@ namespace nslib
             _entities.add( neuronTypeAggregationEntity );
 
             neuronTypeAggregationEntity->setProperty( "Name", "mc" +
-              std::to_string( uint( mc->id( ))) + "p" + std::to_string( i ));
+              std::to_string( uint( mc.id )) + "p" + std::to_string( i ));
 
             neuronTypeAggregationEntity =
               new NeuronTypeAggregation(
-                mcEntity->entityGid( ), uint( mc->id( )),
+                mcEntity->entityGid( ), uint( mc.id ),
                 Layer::TLayerParentType::MINICOLUMN, uint( i ),
                 Neuron::INTERNEURON );
             mcNeuronTypeAggregationEntities[ i + 7 ] =
@@ -912,7 +951,7 @@ namespace nslib
             _entities.add( neuronTypeAggregationEntity );
 
             neuronTypeAggregationEntity->setProperty( "Name","mc" +
-              std::to_string( uint( mc->id( ))) + "i" + std::to_string( i ));
+              std::to_string( uint( mc.id )) + "i" + std::to_string( i ));
           }
 
           shift::Relationship::Establish(
@@ -922,84 +961,39 @@ namespace nslib
 
           ///////////////////////////////////////////
           // Neurons ////////////////////////////////
-          nsol::Neurons& neurons = mc->neurons( );
-          for ( const auto& neuron : neurons )
+          for ( auto neuronIndex = mc.first; neuronIndex < mc.first + mc.size;
+                ++neuronIndex )
           {
-            shift::Entity* neuronEntity;
-            if ( !csvNeuronStatsFileName.empty( ))
-            {
-              const auto neuronGid = neuron->gid( );
-#define MORPHO_STATS neuronsStats[neuronGid].morphologyStats
-              neuronEntity =
-                new shiftgen::Neuron(
-                  "n" + std::to_string( neuronGid ), neuronGid,
-                  nsolToShiftMorphologicalType( neuron->morphologicalType( )),
-                  nsolToShiftFunctionalType( neuron->functionalType( )),
-                  MORPHO_STATS[NNMS::SOMA_VOLUME],
-                  MORPHO_STATS[NNMS::SOMA_SURFACE],
-                  MORPHO_STATS[NNMS::DENDRITIC_VOLUME],
-                  MORPHO_STATS[NNMS::DENDRITIC_SURFACE],
-                  neuron->transform( ).col( 3 ).transpose( ));
-            }
-            else if ( withMorphologies )
-            {
-              assert( neuron->morphology( ) && neuron->morphology( )->stats( ) );
-              nsol::NeuronMorphologyStats* nms = neuron->morphology( )->stats( );
-              neuronEntity =
-                new shiftgen::Neuron(
-                "n" + std::to_string( uint( neuron->gid( ))), neuron->gid( ),
-                nsolToShiftMorphologicalType( neuron->morphologicalType( )),
-                nsolToShiftFunctionalType( neuron->functionalType( )),
-                nms->getStat( nsol::NeuronMorphologyStats::SOMA_VOLUME ),
-                nms->getStat( nsol::NeuronMorphologyStats::SOMA_SURFACE ),
-                nms->getStat( nsol::NeuronMorphologyStats::DENDRITIC_VOLUME ),
-                nms->getStat( nsol::NeuronMorphologyStats::DENDRITIC_SURFACE ),
-                neuron->transform( ).col( 3 ).transpose( ));
-            }
-            else
+            const auto& neuron = neurons[ neuronIndex ];
+            const auto morphologicalType =
+              shiftgen::Neuron::TMorphologicalType( neuron.morphologicalType );
+
+            shift::Entity* neuronEntity =
+              new shiftgen::Neuron(
+                "n" + std::to_string( neuron.gid ), neuron.gid,
+                morphologicalType,
+                shiftgen::Neuron::TFunctionalType( neuron.functionalType ),
+                neuron.stats[NNMS::SOMA_VOLUME],
+                neuron.stats[NNMS::SOMA_SURFACE],
+                neuron.stats[NNMS::DENDRITIC_VOLUME],
+                neuron.stats[NNMS::DENDRITIC_SURFACE],
+                Eigen::Vector4f( neuron.position ));
+
+            if ( summary.hasStats )
             {
-              neuronEntity =
-                new shiftgen::Neuron(
-                "n" + std::to_string( uint( neuron->gid( ))),neuron->gid( ),
-                nsolToShiftMorphologicalType( neuron->morphologicalType( )),
-                nsolToShiftFunctionalType( neuron->functionalType( )),
-                .0f, .0f, .0f, .0f,
-                neuron->transform( ).col( 3 ).transpose( ));
-            }
-
-            if ( neuron->morphology( ) && withMorphologies &&
-                csvNeuronStatsFileName.empty( ))
-            {
-              nsol::NeuronMorphologyStats* nms = neuron->morphology( )->stats( );
-
               for ( int stat_ = 0; stat_ < NSOL_NEURON_MORPHOLOGY_NUM_STATS; ++stat_ )
               {
                 nsol::NeuronMorphologyStats::TNeuronMorphologyStat stat =
                   nsol::NeuronMorphologyStats::TNeuronMorphologyStat( stat_ );
 
                 fires::PropertyManager::registerProperty(
-                neuronEntity, NeuronMorphologyToLabel( stat ),
-                  nms->getStat( stat ));
-              }
-            }
-            else
-            {
-              if ( !csvNeuronStatsFileName.empty( ))
-              {
-                for ( int stat_ = 0; stat_ < NSOL_NEURON_MORPHOLOGY_NUM_STATS; ++stat_ )
-                {
-                  nsol::NeuronMorphologyStats::TNeuronMorphologyStat stat =
-                    nsol::NeuronMorphologyStats::TNeuronMorphologyStat( stat_ );
-
-                  fires::PropertyManager::registerProperty(
                   neuronEntity, NeuronMorphologyToLabel( stat ),
-                    neuronsStats[ neuron->gid( ) ].morphologyStats[stat] );
-                }
+                  neuron.stats[ stat ] );
               }
             }
 
             fires::PropertyManager::registerProperty(
-              neuronEntity, "Layer", uint( neuron->layer( )));
+              neuronEntity, "Layer", uint( neuron.layer ));
 
             _entities.add( neuronEntity );
 
@@ -1016,71 +1010,51 @@ namespace nslib
             relPartOf[ neuronEntity->entityGid( ) ].insert(
               std::make_pair( colEntity->entityGid( ), nullptr ));
 
-            for ( auto layer = 0; layer < 6; ++layer )
+            if ( neuron.layer >= 1 && neuron.layer <= 6 )
             {
-              if ( neuron->layer( ) == layer+1 )
-              {
+              const auto layer = neuron.layer - 1;
               shift::Relationship::Establish(
-              relGroupOf, relPartOf,
+                relGroupOf, relPartOf,
                 mcLayerEntities[ layer ], neuronEntity );
               shift::Relationship::Establish(
-              relGroupOf, relPartOf,
+                relGroupOf, relPartOf,
                 colLayerEntities[ layer ], neuronEntity );
-              }
             }
 
-            if ( neuron->morphologicalType( ) == nsol::Neuron::PYRAMIDAL )
-            {
-              shift::Relationship::Establish(
-              relGroupOf, relPartOf,
-              mcNeuronTypeAggregationEntities[ 0 ], neuronEntity );
-              shift::Relationship::Establish(
-                relGroupOf, relPartOf,
-                colNeuronTypeAggregationEntities[ 0 ], neuronEntity );
-            }
-            else if ( neuron->morphologicalType( ) == nsol::Neuron::INTERNEURON )
+            // Position 0 aggregates the whole type and 1 to 6 each layer
+            int aggregationOffset = -1;
+            if ( morphologicalType == shiftgen::Neuron::PYRAMIDAL )
+              aggregationOffset = 0;
+            else if ( morphologicalType == shiftgen::Neuron::INTERNEURON )
+              aggregationOffset = 7;
+
+            if ( aggregationOffset >= 0 )
             {
               shift::Relationship::Establish(
                 relGroupOf, relPartOf,
-                mcNeuronTypeAggregationEntities[ 7 ], neuronEntity );
+                mcNeuronTypeAggregationEntities[ aggregationOffset ],
+                neuronEntity );
               shift::Relationship::Establish(
                 relGroupOf, relPartOf,
-                colNeuronTypeAggregationEntities[ 7 ], neuronEntity );
-            }
+                colNeuronTypeAggregationEntities[ aggregationOffset ],
+                neuronEntity );
 
-            for ( auto layer = 1; layer < 7; ++layer )
-            {
-              if ( neuron->layer( ) == layer &&
-                   neuron->morphologicalType( ) == nsol::Neuron::PYRAMIDAL )
-              {
-                shift::Relationship::Establish(
-                  relGroupOf, relPartOf,
-                  mcNeuronTypeAggregationEntities[ layer ], neuronEntity );
-                shift::Relationship::Establish(
-                  relGroupOf, relPartOf,
-                  colNeuronTypeAggregationEntities[ layer ], neuronEntity );
-              }
-              else if ( neuron->layer( ) == layer &&
-                        neuron->morphologicalType( ) ==
-                        nsol::Neuron::INTERNEURON )
+              if ( neuron.layer >= 1 && neuron.layer <= 6 )
               {
                 shift::Relationship::Establish(
                   relGroupOf, relPartOf,
-                  mcNeuronTypeAggregationEntities[ layer+7 ], neuronEntity );
+                  mcNeuronTypeAggregationEntities[
+                    aggregationOffset + neuron.layer ], neuronEntity );
                 shift::Relationship::Establish(
                   relGroupOf, relPartOf,
-                  colNeuronTypeAggregationEntities[ layer+7 ], neuronEntity );
+                  colNeuronTypeAggregationEntities[
+                    aggregationOffset + neuron.layer ], neuronEntity );
               }
             }
 
-            neuronEntitiesByGid[ neuron->gid( )] = neuronEntity;
+            neuronEntities[ neuronIndex ] = neuronEntity;
           } // for all neurons
-
-          ++miniColumnsCounter;
-
         } // for all minicols
-
-        ++columnsCounter;
       } // for all colums
 
       const auto& childrenIds = relParentOf[ 0 ];
@@ -1088,71 +1062,54 @@ namespace nslib
       for ( const auto& child : childrenIds )
         _rootEntities.add( nslib::DataManager::entities( ).at( child.first ));
 
-      unsigned int maxConnectionsPerNeuron = 0;
-      for ( const auto& preSynapse:
-              circuit.synapses( nsol::Circuit::PRESYNAPTICCONNECTIONS ))
+      // Connections come sorted by presynaptic neuron, so each neuron's
+      // destinations are looked up once. Names are built from the name of
+      // each neuron, generated the first time it is connected
+      const auto& connections = snapshot.connections( );
+      std::vector< std::string > neuronNames( neurons.size( ));
+      const auto neuronName =
+        [ & ]( uint32_t neuronIndex ) -> const std::string&
       {
-        const auto preNeuronGid =
-          neuronEntitiesByGid[ preSynapse->preSynapticNeuron( )]->entityGid( );
-        const auto postNeuronGid =
-          neuronEntitiesByGid[ preSynapse->postSynapticNeuron( )]->entityGid( );
-
-        auto connectsToIt = relConnectsTo.find( preNeuronGid );
-        if( connectsToIt != relConnectsTo.end( ))
-        {
-          auto connectsToMMIt = connectsToIt->second.find( postNeuronGid );
-          if( connectsToMMIt != connectsToIt->second.end( ))
-          {
-            auto& connectsToProperty =
-              connectsToMMIt->second->getProperty( "count" );
-
-            const unsigned int value = connectsToProperty.value< unsigned int >( ) + 1;
-            if ( value > maxConnectionsPerNeuron )
-              maxConnectionsPerNeuron = value;
-            connectsToProperty.set< unsigned int >( value );
-          }
-          else
-          {
-            const std::string connectionName = neuronEntitiesByGid[ preSynapse->
-              preSynapticNeuron( )]->getProperty( "Entity name" ).
-              value<std::string>( ) + std::string("-") +
-              neuronEntitiesByGid[ preSynapse->
-              postSynapticNeuron( )]->getProperty( "Entity name" ).
-              value<std::string>( );
-            relConnectsTo[ preNeuronGid ].insert(
-              std::make_pair( postNeuronGid, new ConnectsWith(
-              connectionName, 1 )));
-            relConnectedBy[ postNeuronGid ].insert(
-              std::make_pair( preNeuronGid, nullptr ));
-          }
-        }
-        else
+        auto& name = neuronNames[ neuronIndex ];
+        if ( name.empty( ))
+          name = "n" + std::to_string( neurons[ neuronIndex ].gid );
+        return name;
+      };
+      std::string connectionName;
+      for ( size_t first = 0; first < connections.size( ); )
+      {
+        const auto preNeuron = connections[ first ].preNeuron;
+        const auto preNeuronGid = neuronEntities[ preNeuron ]->entityGid( );
+        auto& preNeuronDests = relConnectsTo[ preNeuronGid ];
+        const auto& preNeuronName = neuronName( preNeuron );
+        for ( ; first < connections.size( ) &&
+                connections[ first ].preNeuron == preNeuron; ++first )
         {
-          const std::string connectionName = neuronEntitiesByGid[ preSynapse->
-            preSynapticNeuron( )]->getProperty( "Entity name" ).
-            value<std::string>( ) + std::string("-") +
-            neuronEntitiesByGid[ preSynapse->
-            postSynapticNeuron( )]->getProperty( "Entity name" ).
-            value<std::string>( );
-          relConnectsTo[ preNeuronGid ].insert(
+          const auto& connection = connections[ first ];
+          const auto postNeuronGid =
+            neuronEntities[ connection.postNeuron ]->entityGid( );
+          connectionName = preNeuronName;
+          connectionName += '-';
+          connectionName += neuronName( connection.postNeuron );
+
+          preNeuronDests.insert(
             std::make_pair( postNeuronGid, new ConnectsWith(
-              connectionName, 1 )));
+              connectionName, connection.count )));
           relConnectedBy[ postNeuronGid ].insert(
             std::make_pair( preNeuronGid, nullptr ));
         }
       }
-      neuronEntitiesByGid.clear( );
 
       auto repCreator = RepresentationCreatorManager::getCreator( );
       assert( repCreator );
       auto cortexRepCreator = dynamic_cast< RepresentationCreator* >( repCreator );
       assert( cortexRepCreator );
-      cortexRepCreator->setMaximums( maxNeuronSomaVolume, maxNeuronSomaArea,
-                                     maxNeuronDendVolume, maxNeuronDendArea,
-                                     gids.size( ),
-                                     maxNeuronsPerColumnLayer,
-                                     maxNeuronsPerMiniColumnLayer,
-                                     maxConnectionsPerNeuron );
+      cortexRepCreator->setMaximums( summary.maxSomaVolume, summary.maxSomaArea,
+                                     summary.maxDendVolume, summary.maxDendArea,
+                                     summary.numNeurons,
+                                     summary.maxNeuronsPerColumnLayer,
+                                     summary.maxNeuronsPerMiniColumnLayer,
+                                     summary.maxConnectionsPerNeuron );
     }
 #endif
   } // namespace cortex
@@ -37,6 +37,10 @@ namespace nslib
 {
   namespace cortex
   {
+#ifdef NEUROSCHEME_USE_NSOL
+    class CircuitSnapshot;
+#endif
+
     class DataLoader
       : public ::nslib::DataLoader
     {
@@ -52,6 +56,17 @@ namespace nslib
         const nsol::Circuit& circuit,
         bool withMorphologies = true,
         const std::string& csvNeuronStatsFileName = "" );
+
+      //! Fills snapshot with the columns, neurons and connectivity to be
+      //! created, so they can be cached and loaded without nsol
+      static void describeNsolColumns(
+        const nsol::Columns& columns,
+        const nsol::Circuit& circuit,
+        bool withMorphologies,
+        const std::string& csvNeuronStatsFileName,
+        CircuitSnapshot& snapshot );
+
+      static void createEntitiesFromSnapshot( const CircuitSnapshot& snapshot );
 #endif
     };
   }
@@ -340,38 +340,33 @@ namespace nslib
                 << "\t\t[ -cns | --csv-neuron-stats ] csv_file"
                 << std::endl
                 << "\t\t[ -lc | --load-connectivity ] "
+                << std::endl
+                << "\t\t[ -snc | --snapshot-cache ] cache_dir (*1)"
                 << std::endl << std::endl
                 << "\t\t(*1) only for BlueConfig files" << std::endl;
     }
 
-    void Domain::importRelationshipsJSON(
-      const boost::property_tree::ptree& relationships,
-      std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity )
+    void Domain::importRelationsJSON( const std::string& relationType,
+      const boost::property_tree::ptree& relations,
+      GIDToEntity* oldGIDToEntity )
     {
-      addIsParentOfRelationshipsFromJSON( getRelationsOfType(
-        "isParentOf", relationships ), oldGIDToEntity );
-
-      addConnectsToRelationsFromJSON( getRelationsOfType(
-        "connectsTo", relationships ), oldGIDToEntity );
-
-      addIsAGroupOfRelationshipsToJSON( getRelationsOfType(
-        "isAGroupOf", relationships ), oldGIDToEntity );
-
-      addIsSuperEntityOfRelationshipsToJSON( getRelationsOfType(
-        "isSuperEntityOf", relationships ), oldGIDToEntity );
-
-      addAggregatedConnectionFromJSON( getRelationsOfType(
-        "aggregatedConnectedBy", relationships ), "aggregatedConnectedBy",
-        oldGIDToEntity );
-
-      addAggregatedConnectionFromJSON( getRelationsOfType(
-        "aggregatedConnectsTo", relationships ),"aggregatedConnectsTo",
-        oldGIDToEntity );
+      if ( relationType == "isParentOf" )
+        addIsParentOfRelationshipsFromJSON( relations, oldGIDToEntity );
+      else if ( relationType == "connectsTo" )
+        addConnectsToRelationsFromJSON( relations, oldGIDToEntity );
+      else if ( relationType == "isAGroupOf" )
+        addIsAGroupOfRelationshipsToJSON( relations, oldGIDToEntity );
+      else if ( relationType == "isSuperEntityOf" )
+        addIsSuperEntityOfRelationshipsToJSON( relations, oldGIDToEntity );
+      else if ( relationType == "aggregatedConnectedBy" ||
+                relationType == "aggregatedConnectsTo" )
+        addAggregatedConnectionFromJSON( relations, relationType,
+                                         oldGIDToEntity );
     }
 
     void Domain::addIsAGroupOfRelationshipsToJSON(
       const boost::property_tree::ptree&  relations,
-      std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity )
+      GIDToEntity* oldGIDToEntity )
     {
       auto& relGroupOf = *( DataManager::entities( )
         .relationships( )[ "isAGroupOf" ]->asOneToN( ) );
@@ -397,7 +392,7 @@ namespace nslib
     void
     Domain::addIsSuperEntityOfRelationshipsToJSON(
       const boost::property_tree::ptree&  relations,
-      std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity )
+      GIDToEntity* oldGIDToEntity )
     {
       auto& relSuperEntity = *( DataManager::entities( )
         .relationships( )[ "isSuperEntityOf" ]->asOneToN( ));
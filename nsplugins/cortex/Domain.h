@@ -72,17 +72,17 @@ namespace nslib
       void exportRepresentationMaxMin(
         std::ostream& outputStream, bool minimizeStream ) const override;
 
-      void importRelationshipsJSON(
-        const boost::property_tree::ptree& relationships,
-        std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity ) override;
+      void importRelationsJSON( const std::string& relationType,
+        const boost::property_tree::ptree& relations,
+        GIDToEntity* oldGIDToEntity ) override;
 
       void addIsAGroupOfRelationshipsToJSON(
         const boost::property_tree::ptree&  relations,
-        std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity );
+        GIDToEntity* oldGIDToEntity );
 
       void addIsSuperEntityOfRelationshipsToJSON(
         const boost::property_tree::ptree&  relations,
-        std::unordered_map < unsigned int, shift::Entity* >* oldGIDToEntity );
+        GIDToEntity* oldGIDToEntity );
 
       void importMaximumsJSON( const boost::property_tree::ptree& maximums ) override;
     };
@@ -21,6 +21,7 @@
  */
 
 #include "LayerItem.h"
+#include <nslib/reps/DetailedItem.h>
 
 namespace nslib
 {
@@ -70,7 +71,7 @@ namespace nslib
     void LayerItem::disable( void )
     {
       this->setEnabled( false );
-      this->setVisible( false );
+      DetailedItem::setChildVisible( this, false );
     }
   }
 }
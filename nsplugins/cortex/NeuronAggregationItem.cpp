@@ -346,7 +346,7 @@ namespace nslib
       else
       {
         _layerItems[ i ]->setEnabled( false );
-        _layerItems[ i ]->setVisible( false );
+        setChildVisible( _layerItems[ i ], false );
       }
     }
 
@@ -362,7 +362,7 @@ namespace nslib
     {
       _layerAnimations[ i ]->disconnect( SIGNAL( finished( )));
       _layerItems[ i ]->setEnabled( true );
-      _layerItems[ i ]->setVisible( true );
+      setChildVisible( _layerItems[ i ], true );
 
       if ( anim )
       {
@@ -379,6 +379,16 @@ namespace nslib
     _collapsed = false;
   }
 
+  void NeuronAggregationItem::paint( QPainter* painter,
+                                     const QStyleOptionGraphicsItem* option,
+                                     QWidget* widget )
+  {
+    if ( _updateLevelOfDetail( this, painter ) == DOT )
+      painter->fillRect( path( ).boundingRect( ), brush( ));
+    else
+      QGraphicsPathItem::paint( painter, option, widget );
+  }
+
   void NeuronAggregationItem::hoverEnterEvent(
     QGraphicsSceneHoverEvent* event_ )
     {
@@ -25,6 +25,7 @@
 #include <nslib/Color.h>
 #include <nslib/InteractionManager.h>
 #include <nslib/reps/CollapsableItem.h>
+#include <nslib/reps/DetailedItem.h>
 #include <nslib/reps/Item.h>
 #include <nslib/reps/InteractiveItem.h>
 #include "ColumnRep.h"
@@ -53,6 +54,7 @@ namespace nslib
       , public CollapsableItem
       , public SelectableItem
       , public InteractiveItem
+      , public DetailedItem
     {
       Q_OBJECT
       Q_PROPERTY( QPointF pos READ pos WRITE setPos )
@@ -77,6 +79,11 @@ namespace nslib
 
       virtual void contextMenuEvent( QGraphicsSceneContextMenuEvent* event_ );
 
+      //! Paints only the aggregation outline, or a dot, when the item is too
+      //! small on screen for its layers and mean neuron to be readable
+      virtual void paint( QPainter* painter,
+        const QStyleOptionGraphicsItem* option,
+        QWidget* widget = nullptr ) override;
 
     protected:
 
@@ -60,6 +60,8 @@ namespace nslib
                          size );
       somaItem->setPen( Qt::NoPen );
       somaItem->setBrush( QBrush( bgColor ));
+      _somaRect = somaItem->rect( );
+      _somaBrush = somaItem->brush( );
 
       QGraphicsItem* symbolItem = _createSymbolItem( symbol, size );
 
@@ -156,6 +158,26 @@ namespace nslib
       }
     }
 
+    void NeuronItem::paint( QPainter* painter,
+                            const QStyleOptionGraphicsItem* option,
+                            QWidget* widget )
+    {
+      switch ( _updateLevelOfDetail( this, painter ))
+      {
+        case DOT:
+          painter->fillRect( _somaRect, _somaBrush );
+          break;
+        case GLYPH:
+          painter->setPen( pen( ));
+          painter->setBrush( _somaBrush );
+          painter->drawEllipse( _somaRect );
+          break;
+        default:
+          QGraphicsEllipseItem::paint( painter, option, widget );
+          break;
+      }
+    }
+
     QGraphicsItem* NeuronItem::_createSymbolItem( NeuronRep::TSymbol symbol,
                                                   unsigned int size )
     {
@@ -24,6 +24,7 @@
 
 #include <nslib/Color.h>
 #include <nslib/InteractionManager.h>
+#include <nslib/reps/DetailedItem.h>
 #include <nslib/reps/InteractiveItem.h>
 #include <nslib/reps/Item.h>
 #include <nslib/reps/SelectableItem.h>
@@ -42,6 +43,7 @@ namespace nslib
       , public nslib::Item
       , public nslib::SelectableItem
       , public nslib::InteractiveItem
+      , public nslib::DetailedItem
     {
       Q_OBJECT
       Q_PROPERTY( QPointF pos READ pos WRITE setPos )
@@ -61,12 +63,19 @@ namespace nslib
 
       virtual void contextMenuEvent( QGraphicsSceneContextMenuEvent* event_ );
 
+      //! Paints the soma as a flat glyph or a dot when the neuron is too
+      //! small on screen for its children to be distinguishable
+      virtual void paint( QPainter* painter,
+        const QStyleOptionGraphicsItem* option,
+        QWidget* widget = nullptr ) override;
 
     protected:
 
       QGraphicsItem* _createSymbolItem( NeuronRep::TSymbol symbol,
         unsigned int size = 100 );
       ItemText* _itemText;
+      QRectF _somaRect;
+      QBrush _somaBrush;
     };
 
 
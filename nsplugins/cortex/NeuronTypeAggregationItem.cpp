@@ -93,7 +93,7 @@ namespace nslib
     void NeuronTypeAggregationItem::disable( void )
     {
       this->setEnabled( false );
-      this->setVisible( false );
+      DetailedItem::setChildVisible( this, false );
     }
 
   } // namespace cortex
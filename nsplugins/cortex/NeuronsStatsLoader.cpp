@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#include "NeuronsStatsLoader.h"
+
+#ifdef NEUROSCHEME_USE_NSOL
+
+#include <nslib/Loggers.h>
+#include <nslib/ParallelFor.h>
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#define NNMS nsol::NeuronMorphologyStats
+#define CSV_NEURON_STATS_FIELDS ( 10 + NSOL_NEURON_MORPHOLOGY_NUM_STATS )
+// Bytes of file each parsing chunk gets at least
+#define CSV_CHUNK_SIZE ( 1 << 20 )
+
+namespace nslib
+{
+  namespace cortex
+  {
+    namespace
+    {
+      typedef struct
+      {
+        std::vector< std::pair< unsigned int, TNeuronStats >> rows;
+        //! Line in the chunk and number of fields found, 0 if a value could
+        //! not be parsed
+        std::vector< std::pair< unsigned int, unsigned int >> skippedLines;
+        unsigned int numLines;
+
+        unsigned long totalBifurcations;
+        double totalSomaArea;
+        double totalSomaVolume;
+        double totalDendsArea;
+        double totalDendsVolume;
+        float maxSomaVolume;
+        float maxSomaArea;
+        float maxDendVolume;
+        float maxDendArea;
+        float maxAxonVolume;
+        float maxAxonArea;
+      } TChunkStats;
+
+      void accumulate( TChunkStats& chunk, const TNeuronStats& stats )
+      {
+        chunk.totalBifurcations += ( unsigned long )
+          stats.morphologyStats[NNMS::DENDRITIC_BIFURCATIONS];
+        chunk.totalSomaVolume += stats.morphologyStats[NNMS::SOMA_VOLUME];
+        chunk.totalSomaArea += stats.morphologyStats[NNMS::SOMA_SURFACE];
+        chunk.totalDendsVolume +=
+          stats.morphologyStats[NNMS::DENDRITIC_VOLUME];
+        chunk.totalDendsArea += stats.morphologyStats[NNMS::DENDRITIC_SURFACE];
+
+        chunk.maxSomaVolume = std::max( chunk.maxSomaVolume,
+          stats.morphologyStats[NNMS::SOMA_VOLUME] );
+        chunk.maxSomaArea = std::max( chunk.maxSomaArea,
+          stats.morphologyStats[NNMS::SOMA_SURFACE] );
+        chunk.maxDendVolume = std::max( chunk.maxDendVolume,
+          stats.morphologyStats[NNMS::DENDRITIC_VOLUME] );
+        chunk.maxDendArea = std::max( chunk.maxDendArea,
+          stats.morphologyStats[NNMS::DENDRITIC_SURFACE] );
+        chunk.maxAxonVolume = std::max( chunk.maxAxonVolume,
+          stats.morphologyStats[NNMS::AXON_VOLUME] );
+        chunk.maxAxonArea = std::max( chunk.maxAxonArea,
+          stats.morphologyStats[NNMS::AXON_SURFACE] );
+      }
+
+      void reduce( TChunkStats& result, const TChunkStats& chunk )
+      {
+        result.totalBifurcations += chunk.totalBifurcations;
+        result.totalSomaVolume += chunk.totalSomaVolume;
+        result.totalSomaArea += chunk.totalSomaArea;
+        result.totalDendsVolume += chunk.totalDendsVolume;
+        result.totalDendsArea += chunk.totalDendsArea;
+        result.maxSomaVolume =
+          std::max( result.maxSomaVolume, chunk.maxSomaVolume );
+        result.maxSomaArea = std::max( result.maxSomaArea, chunk.maxSomaArea );
+        result.maxDendVolume =
+          std::max( result.maxDendVolume, chunk.maxDendVolume );
+        result.maxDendArea = std::max( result.maxDendArea, chunk.maxDendArea );
+        result.maxAxonVolume =
+          std::max( result.maxAxonVolume, chunk.maxAxonVolume );
+        result.maxAxonArea = std::max( result.maxAxonArea, chunk.maxAxonArea );
+      }
+
+      void skipSpaces( const char*& ptr, const char* end )
+      {
+        while ( ptr < end && ( *ptr == ' ' || *ptr == '\t' ))
+          ++ptr;
+      }
+
+      bool parseSeparator( const char*& ptr, const char* end )
+      {
+        skipSpaces( ptr, end );
+        if ( ptr == end || *ptr != ',' )
+          return false;
+        ++ptr;
+        return true;
+      }
+
+      bool parseUnsigned( const char*& ptr, const char* end,
+                          unsigned int& value )
+      {
+        skipSpaces( ptr, end );
+        const char* begin = ptr;
+        unsigned long result = 0;
+        while ( ptr < end && *ptr >= '0' && *ptr <= '9' )
+          result = result * 10 + ( *ptr++ - '0' );
+        value = ( unsigned int ) result;
+        return ptr != begin;
+      }
+
+      // Parses in place and regardless of the locale, which Qt sets from the
+      // environment and would change the decimal separator of strtof
+      bool parseFloat( const char*& ptr, const char* end, float& value )
+      {
+        skipSpaces( ptr, end );
+        bool negative = false;
+        if ( ptr < end && ( *ptr == '-' || *ptr == '+' ))
+          negative = ( *ptr++ == '-' );
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        unsigned int digits = 0;
+        bool anyDigit = false;
+        for ( ; ptr < end && *ptr >= '0' && *ptr <= '9'; ++ptr, anyDigit = true )
+        {
+          if ( digits < 19 )
+          {
+            mantissa = mantissa * 10 + ( *ptr - '0' );
+            if ( mantissa > 0 )
+              ++digits;
+          }
+          else
+            ++exponent;
+        }
+        if ( ptr < end && *ptr == '.' )
+        {
+          for ( ++ptr; ptr < end && *ptr >= '0' && *ptr <= '9';
+                ++ptr, anyDigit = true )
+          {
+            if ( digits < 19 )
+            {
+              mantissa = mantissa * 10 + ( *ptr - '0' );
+              if ( mantissa > 0 )
+                ++digits;
+              --exponent;
+            }
+          }
+        }
+        if ( !anyDigit )
+          return false;
+
+        if ( ptr < end && ( *ptr == 'e' || *ptr == 'E' ))
+        {
+          const char* exponentPtr = ptr + 1;
+          bool negativeExponent = false;
+          if ( exponentPtr < end &&
+               ( *exponentPtr == '-' || *exponentPtr == '+' ))
+            negativeExponent = ( *exponentPtr++ == '-' );
+          unsigned int exponentValue;
+          if ( parseUnsigned( exponentPtr, end, exponentValue ))
+          {
+            exponent += negativeExponent ? -int( exponentValue ) :
+              int( exponentValue );
+            ptr = exponentPtr;
+          }
+        }
+
+        double result = double( mantissa );
+        if ( exponent != 0 && mantissa != 0 )
+          result *= std::pow( 10.0, exponent );
+        value = float( negative ? -result : result );
+        return true;
+      }
+
+      bool parseLine( const char* ptr, const char* end, unsigned int& gid,
+                      TNeuronStats& stats )
+      {
+        float layer, column, miniColumn, mophoType, functType;
+        if ( !parseUnsigned( ptr, end, gid ) ||
+             !parseSeparator( ptr, end ) ||
+             !parseFloat( ptr, end, stats.x ) ||
+             !parseSeparator( ptr, end ) ||
+             !parseFloat( ptr, end, stats.y ) ||
+             !parseSeparator( ptr, end ) ||
+             !parseFloat( ptr, end, stats.z ) ||
+             !parseSeparator( ptr, end ) ||
+             !parseFloat( ptr, end, layer ) ||
+             !parseSeparator( ptr, end ) ||
+             !parseFloat( ptr, end, column ) ||
+             !parseSeparator( ptr, end ) ||
+             !parseFloat( ptr, end, miniColumn ) ||
+             !parseSeparator( ptr, end ) ||
+             !parseFloat( ptr, end, mophoType ) ||
+             !parseSeparator( ptr, end ) ||
+             !parseFloat( ptr, end, functType ) ||
+             !parseSeparator( ptr, end ) ||
+             !parseFloat( ptr, end, stats.somaMaxRadius ))
+          return false;
+
+        for ( unsigned int statIdx = 0;
+              statIdx < NSOL_NEURON_MORPHOLOGY_NUM_STATS; ++statIdx )
+        {
+          if ( !parseSeparator( ptr, end ) ||
+               !parseFloat( ptr, end, stats.morphologyStats[statIdx] ))
+            return false;
+        }
+
+        stats.layer = uint8_t( layer );
+        stats.column = uint8_t( column );
+        stats.miniColumn = ( unsigned short ) miniColumn;
+        stats.mophoType = uint8_t( mophoType );
+        stats.functType = uint8_t( functType );
+        return true;
+      }
+
+      // Parses the lines starting in [ begin, end ). The header line is
+      // skipped by the first chunk.
+      void parseChunk( const char* data, size_t size, size_t begin,
+                       size_t end, const Bitmap& gids, TChunkStats& chunk )
+      {
+        const char* ptr = data + begin;
+        const char* dataEnd = data + size;
+        if ( begin == 0 || data[ begin - 1 ] != '\n' )
+        {
+          ptr = static_cast< const char* >(
+            std::memchr( ptr, '\n', dataEnd - ptr ));
+          ptr = ptr ? ptr + 1 : dataEnd;
+        }
+
+        while ( ptr < data + end )
+        {
+          const char* lineEnd = static_cast< const char* >(
+            std::memchr( ptr, '\n', dataEnd - ptr ));
+          if ( !lineEnd )
+            lineEnd = dataEnd;
+          const char* nextLine = lineEnd < dataEnd ? lineEnd + 1 : dataEnd;
+          ++chunk.numLines;
+
+          if ( ptr < lineEnd && *ptr == '#' )
+          {
+            ptr = nextLine;
+            continue;
+          }
+
+          // Trim spaces
+          while ( lineEnd > ptr && ( lineEnd[ -1 ] == ' ' ||
+                  lineEnd[ -1 ] == '\r' || lineEnd[ -1 ] == '\t' ))
+            --lineEnd;
+          const unsigned int fields = 1 + std::count( ptr, lineEnd, ',' );
+          if ( fields != CSV_NEURON_STATS_FIELDS )
+          {
+            chunk.skippedLines.push_back(
+              std::make_pair( chunk.numLines, fields ));
+            ptr = nextLine;
+            continue;
+          }
+
+          unsigned int gid;
+          TNeuronStats stats;
+          if ( !parseLine( ptr, lineEnd, gid, stats ))
+            chunk.skippedLines.push_back( std::make_pair( chunk.numLines, 0 ));
+          else if ( gids.test( gid ))
+          {
+            chunk.rows.push_back( std::make_pair( gid, stats ));
+            accumulate( chunk, stats );
+          }
+          ptr = nextLine;
+        }
+      }
+    }
+
+    void NeuronsStatsLoader::load( const std::string& fileName,
+                                   const Bitmap& gids,
+                                   TNeuronsStats& neuronsStats,
+                                   TNeuronsStatsSummary& summary )
+    {
+      summary = TNeuronsStatsSummary{ 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+                                      0, 0.0f, 0.0f, 0.0f, 0.0f };
+      neuronsStats.clear( );
+
+      QFile file( QString::fromStdString( fileName ));
+      if ( !file.open( QIODevice::ReadOnly ))
+      {
+        throw std::runtime_error( std::string( "File" ) +
+                                  fileName +
+                                  std::string( " could not be opened"));
+      }
+
+      const size_t size = file.size( );
+      if ( size == 0 )
+        return;
+      const char* data =
+        reinterpret_cast< const char* >( file.map( 0, file.size( )));
+      QByteArray contents;
+      if ( !data )
+      {
+        // Files that can not be mapped are read at once
+        contents = file.readAll( );
+        data = contents.constData( );
+      }
+
+      // The header line is in the first chunk, so it can not be empty
+      const unsigned int numChunks = parallelChunks( size, CSV_CHUNK_SIZE );
+      std::vector< TChunkStats > chunks( numChunks, TChunkStats{
+        {}, {}, 0, 0, 0.0, 0.0, 0.0, 0.0,
+        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f });
+      parallelFor( size, numChunks,
+        [ & ]( size_t begin, size_t end, unsigned int chunk )
+        {
+          parseChunk( data, size, begin, end, gids, chunks[ chunk ]);
+        });
+
+      // Merged in file order, so later rows of a gid override former ones
+      TChunkStats total = chunks.front( );
+      total.rows.clear( );
+      size_t numRows = 0;
+      unsigned int firstLine = 0;
+      for ( unsigned int chunk = 0; chunk < chunks.size( ); ++chunk )
+      {
+        for ( const auto& skipped : chunks[ chunk ].skippedLines )
+        {
+          Loggers::get( )->log(
+            std::string( "Skipping lineString " ) +
+            std::to_string( firstLine + skipped.first ) +
+            ( skipped.second == 0 ? std::string( ". Values could not be read." ) :
+              std::string( ". Expected 26 fields, but found " ) +
+              std::to_string( skipped.second ) + "." ),
+            nslib::LOG_LEVEL_WARNING, NEUROSCHEME_FILE_LINE );
+        }
+        // The header is not numbered, as the first chunk skips it
+        firstLine += chunks[ chunk ].numLines;
+        if ( chunk > 0 )
+          reduce( total, chunks[ chunk ]);
+        numRows += chunks[ chunk ].rows.size( );
+      }
+
+      neuronsStats.reserve( numRows );
+      for ( const auto& chunk : chunks )
+        for ( const auto& row : chunk.rows )
+          neuronsStats[ row.first ] = row.second;
+
+      // Repeated gids were accumulated more than once
+      if ( neuronsStats.size( ) != numRows )
+      {
+        total = TChunkStats{ {}, {}, 0, 0, 0.0, 0.0, 0.0, 0.0,
+                             0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        for ( const auto& neuronStats : neuronsStats )
+          accumulate( total, neuronStats.second );
+      }
+
+      summary.maxSomaVolume = total.maxSomaVolume;
+      summary.maxSomaArea = total.maxSomaArea;
+      summary.maxDendVolume = total.maxDendVolume;
+      summary.maxDendArea = total.maxDendArea;
+      summary.maxAxonVolume = total.maxAxonVolume;
+      summary.maxAxonArea = total.maxAxonArea;
+      if ( neuronsStats.size( ) > 0 )
+      {
+        const float size_1 =  1.0f / float( neuronsStats.size( ));
+        summary.meanSomaArea = total.totalSomaArea * size_1;
+        summary.meanSomaVolume = total.totalSomaVolume * size_1;
+        summary.meanDendsArea = total.totalDendsArea * size_1;
+        summary.meanDendsVolume = total.totalDendsVolume * size_1;
+        summary.meanBifurcations = total.totalBifurcations * size_1;
+      }
+    }
+  }
+}
+
+#endif // NEUROSCHEME_USE_NSOL
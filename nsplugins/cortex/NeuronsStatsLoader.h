@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef __NSLIB__CORTEX_NEURONS_STATS_LOADER__
+#define __NSLIB__CORTEX_NEURONS_STATS_LOADER__
+
+#include <nslib/Bitmap.h>
+#include <unordered_map>
+#include <string>
+
+#ifdef NEUROSCHEME_USE_NSOL
+#include <nsol/nsol.h>
+
+#define NSOL_NEURON_MORPHOLOGY_NUM_STATS                        \
+  nsol::NeuronMorphologyStats::NEURON_MORPHOLOGY_NUM_STATS
+
+namespace nslib
+{
+  namespace cortex
+  {
+    typedef struct
+    {
+      float x, y, z;
+      uint8_t layer, column;
+      unsigned short miniColumn;
+      uint8_t mophoType, functType;
+      float somaMaxRadius;
+      float morphologyStats[NSOL_NEURON_MORPHOLOGY_NUM_STATS];
+    } TNeuronStats;
+
+    typedef std::unordered_map< unsigned int, TNeuronStats > TNeuronsStats;
+
+    //! Maximums and means of the loaded stats used to scale representations
+    typedef struct
+    {
+      float maxSomaVolume;
+      float maxSomaArea;
+      float maxDendVolume;
+      float maxDendArea;
+      float maxAxonVolume;
+      float maxAxonArea;
+      unsigned int meanBifurcations;
+      float meanSomaArea;
+      float meanSomaVolume;
+      float meanDendsArea;
+      float meanDendsVolume;
+    } TNeuronsStatsSummary;
+
+    //! Loads the 26 field neuron stats csv file. The file is memory mapped
+    //! and split in line aligned chunks parsed in parallel. Only rows whose
+    //! gid is set in gids are kept. Throws std::runtime_error if the file can
+    //! not be opened.
+    class NeuronsStatsLoader
+    {
+    public:
+      static void load( const std::string& fileName, const Bitmap& gids,
+                        TNeuronsStats& neuronsStats,
+                        TNeuronsStatsSummary& summary );
+    };
+  }
+}
+
+#endif // NEUROSCHEME_USE_NSOL
+
+#endif
@@ -316,6 +316,14 @@ namespace nslib
       shift::Representations& relatedEntities,
       shift::RelationshipOneToN* relatedElements )
     {
+      // Only relations between displayed entities are represented, so the
+      // adjacency of each entity is walked and checked against them
+      std::unordered_map< shift::EntityGid, shift::Entity* > displayedEntities;
+      displayedEntities.reserve( entities.size( ));
+      for( auto& entity : entities.vector( ))
+        displayedEntities.insert(
+          std::make_pair( entity->entityGid( ), entity ));
+
       for( auto& entity : entities.vector( ))
       {
         auto srcEntityRep = gidsToEntitiesReps.find( entity->entityGid( ));
@@ -327,26 +335,34 @@ namespace nslib
         if( entityRelations == relatedElements->end( ))
           continue;
 
-        for( auto& other : entities.vector( ))
+        auto relation = entityRelations->second.begin( );
+        while( relation != entityRelations->second.end( ))
         {
-          if( other->entityGid( ) == entity->entityGid( ))
-            continue;
+          const auto otherGid = relation->first;
+          const auto relationProperties = relation->second;
 
-          auto otherRep = gidsToEntitiesReps.find( other->entityGid( ));
-          if( otherRep == gidsToEntitiesReps.end( ))
+          // Relations with the same entity are contiguous, just the first
+          // one is represented
+          do
+            ++relation;
+          while( relation != entityRelations->second.end( ) &&
+                 relation->first == otherGid );
+
+          if( otherGid == entity->entityGid( ))
             continue;
 
-          auto numberOfConnections =
-              entityRelations->second.count( other->entityGid( ));
+          auto other = displayedEntities.find( otherGid );
+          if( other == displayedEntities.end( ))
+            continue;
 
-          if( numberOfConnections == 0 )
+          auto otherRep = gidsToEntitiesReps.find( otherGid );
+          if( otherRep == gidsToEntitiesReps.end( ))
             continue;
 
           // TODO: Change to equal_range whenever multiple relationships between
           // the same elements are imported. Then, create a loop to iterate
           // over the given results and create a new one if not found.
-          auto combinedKey = std::make_pair( entity->entityGid( ),
-                                             other->entityGid( ));
+          auto combinedKey = std::make_pair( entity->entityGid( ), otherGid );
           auto alreadyConnected =
               relatedEntitiesReps.find( combinedKey );
 
@@ -356,20 +372,16 @@ namespace nslib
               new ConnectionArrowRep( srcEntityRep->second.second,
                                       otherRep->second.second );
 
-            std::unordered_multimap< shift::EntityGid,
-                                     shift::RelationshipProperties* > relMMap =
-              ( *relatedElements )[ entity->entityGid( ) ];
-            auto relMMapIt = relMMap.find( other->entityGid( ));
-            if ( relMMapIt != ( *relatedElements )[ entity->entityGid( ) ].end( ) )
+            if ( relationProperties )
             {
               relationRep->setProperty( "width", ( unsigned int )
-              roundf( _nbConnectionsToWidth.map(relMMapIt->second->
+              roundf( _nbConnectionsToWidth.map( relationProperties->
               getPropertyValue< unsigned int >( "count", 0u ))));
             }
 
             alreadyConnected = relatedEntitiesReps.insert(
               std::make_pair( combinedKey,
-              std::make_tuple( relationRep, entity, other,
+              std::make_tuple( relationRep, entity, other->second,
               srcEntityRep->second.second, otherRep->second.second )));
           }
 
@@ -385,6 +397,12 @@ namespace nslib
       shift::Representations& relatedEntities,
       shift::RelationshipAggregatedOneToN* relatedElements )
     {
+      std::unordered_map< shift::EntityGid, shift::Entity* > displayedEntities;
+      displayedEntities.reserve( entities.size( ));
+      for( auto& entity : entities.vector( ))
+        displayedEntities.insert(
+          std::make_pair( entity->entityGid( ), entity ));
+
       for( auto& entity : entities.vector( ))
       {
         auto srcEntityRep = gidsToEntitiesReps.find( entity->entityGid( ));
@@ -397,25 +415,24 @@ namespace nslib
         if( entityRelations == relatedElements->mapAggregatedRels( ).end( ))
           continue;
 
-        for( auto& other : entities.vector( ))
+        for( auto& otherEntityConnection : *entityRelations->second )
         {
-          if( other->entityGid( ) == entity->entityGid( ))
+          const auto otherGid = otherEntityConnection.first;
+          if( otherGid == entity->entityGid( ))
             continue;
 
-          auto otherRep = gidsToEntitiesReps.find( other->entityGid( ));
-          if( otherRep == gidsToEntitiesReps.end( ))
+          auto other = displayedEntities.find( otherGid );
+          if( other == displayedEntities.end( ))
             continue;
 
-          auto otherEntityConnection = entityRelations->second->find(
-            other->entityGid( ));
-          if( otherEntityConnection == entityRelations->second->end( ))
+          auto otherRep = gidsToEntitiesReps.find( otherGid );
+          if( otherRep == gidsToEntitiesReps.end( ))
             continue;
 
           // TODO: Change to equal_range whenever multiple relationships between
           // the same elements are imported. Then, create a loop to iterate
           // over the given results and create a new one if not found.
-          auto combinedKey = std::make_pair( entity->entityGid( ),
-                                             other->entityGid( ));
+          auto combinedKey = std::make_pair( entity->entityGid( ), otherGid );
           auto alreadyConnected =
             relatedEntitiesReps.find( combinedKey );
 
@@ -426,7 +443,7 @@ namespace nslib
                                       otherRep->second.second );
 
             shift::RelationshipProperties* relationProperties =
-              otherEntityConnection->second
+              otherEntityConnection.second
               .relationshipAggregatedProperties.get( );
             if ( relationProperties )
             {
@@ -437,7 +454,7 @@ namespace nslib
 
             alreadyConnected = relatedEntitiesReps.insert(
               std::make_pair( combinedKey, std::make_tuple( relationRep,
-              entity, other, srcEntityRep->second.second,
+              entity, other->second, srcEntityRep->second.second,
               otherRep->second.second )));
           }
           relatedEntities.push_back( std::get< 0 >( alreadyConnected->second ));
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2017 GMRV/URJC/UPM.
+ *
+ * Authors: Pablo Toharia <pablo.toharia@upm.es>
+ *
+ * This file is part of NeuroScheme
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+// Checks that DetailedItem level of detail changes never show children
+// hidden for other reasons, such as collapsed layers
+
+#define BOOST_TEST_MODULE detailedItem
+#include <boost/test/unit_test.hpp>
+
+#include <nslib/reps/DetailedItem.h>
+
+#include <QApplication>
+#include <QGraphicsRectItem>
+#include <QImage>
+
+namespace
+{
+  // Item 100 units wide, painted at full detail with a unit scale
+  class TestItem : public QGraphicsRectItem, public nslib::DetailedItem
+  {
+  public:
+    TestItem( void )
+      : QGraphicsRectItem( 0, 0, 100, 100 )
+    {}
+
+    void paint( QPainter* painter, const QStyleOptionGraphicsItem* option,
+                QWidget* widget ) override
+    {
+      _updateLevelOfDetail( this, painter );
+      QGraphicsRectItem::paint( painter, option, widget );
+    }
+  };
+
+  // Paints item with the given scale, as a zoomed view would do
+  void paintAtScale( TestItem& item, qreal scale )
+  {
+    QImage image( 16, 16, QImage::Format_ARGB32 );
+    QPainter painter( &image );
+    painter.scale( scale, scale );
+    QStyleOptionGraphicsItem option;
+    item.paint( &painter, &option, nullptr );
+  }
+
+  const qreal ZOOM_IN = 1.0;
+  const qreal ZOOM_OUT = 0.01;
+
+  struct GlobalFixture
+  {
+    GlobalFixture( void )
+    {
+      qputenv( "QT_QPA_PLATFORM", "offscreen" );
+      _application = new QApplication( _argc, _argv );
+    }
+
+    ~GlobalFixture( void )
+    {
+      delete _application;
+    }
+
+    int _argc = 1;
+    char _argv0[ 16 ] = "detailedItem";
+    char* _argv[ 1 ] = { _argv0 };
+    QApplication* _application;
+  };
+
+  BOOST_GLOBAL_FIXTURE( GlobalFixture );
+}
+
+BOOST_AUTO_TEST_CASE( collapsed_children_stay_hidden )
+{
+  TestItem item;
+  auto collapsed = new QGraphicsRectItem( 0, 0, 10, 10, &item );
+  auto expanded = new QGraphicsRectItem( 10, 0, 10, 10, &item );
+
+  nslib::DetailedItem::setChildVisible( collapsed, false );
+
+  paintAtScale( item, ZOOM_OUT );
+  BOOST_CHECK( item.levelOfDetail( ) != nslib::DetailedItem::FULL );
+  BOOST_CHECK( !collapsed->isVisible( ));
+  BOOST_CHECK( !expanded->isVisible( ));
+
+  paintAtScale( item, ZOOM_IN );
+  BOOST_CHECK_EQUAL( item.levelOfDetail( ), nslib::DetailedItem::FULL );
+  BOOST_CHECK( !collapsed->isVisible( ));
+  BOOST_CHECK( expanded->isVisible( ));
+}
+
+BOOST_AUTO_TEST_CASE( children_changed_without_full_detail )
+{
+  TestItem item;
+  auto uncollapsed = new QGraphicsRectItem( 0, 0, 10, 10, &item );
+  auto collapsed = new QGraphicsRectItem( 10, 0, 10, 10, &item );
+  nslib::DetailedItem::setChildVisible( uncollapsed, false );
+
+  paintAtScale( item, ZOOM_OUT );
+  nslib::DetailedItem::setChildVisible( uncollapsed, true );
+  nslib::DetailedItem::setChildVisible( collapsed, false );
+  BOOST_CHECK( !uncollapsed->isVisible( ));
+  BOOST_CHECK( !collapsed->isVisible( ));
+
+  paintAtScale( item, ZOOM_IN );
+  BOOST_CHECK( uncollapsed->isVisible( ));
+  BOOST_CHECK( !collapsed->isVisible( ));
+}